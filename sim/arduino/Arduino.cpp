@@ -0,0 +1,108 @@
+#include <Arduino.h>
+#include "SimNode.h"
+#include <pico/time.h>
+#include "Config.h"
+
+// ────────────────────────────────
+// Clock: everything reads the host's virtual time
+// ────────────────────────────────
+uint64_t sim::nowUs() {
+  return node.host ? node.host->nowUs() : 0;
+}
+
+uint32_t micros() { return (uint32_t)sim::nowUs(); }
+uint32_t millis() { return (uint32_t)(sim::nowUs() / 1000); }
+
+void delayMicroseconds(uint32_t us) {
+  if (sim::node.host) sim::node.host->advance(us);
+}
+
+void delay(uint32_t ms) { delayMicroseconds(ms * 1000); }
+
+absolute_time_t get_absolute_time() { return sim::nowUs(); }
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout) {
+  if (sim::node.cfg.noSleep) return false;
+  sim::node.asleep = true;
+  sim::node.wakeAt = timeout;
+  return false;
+}
+void yield() {}
+
+// ────────────────────────────────
+// GPIO / interrupts
+// ────────────────────────────────
+void pinMode(int pin, int mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(int pin, int val) {
+  (void)pin;
+  (void)val;
+}
+
+int digitalRead(int pin) {
+  if (pin == PCF_INT_PIN) return sim::node.pcfIntLow ? LOW : HIGH;
+  return HIGH;  // board buttons idle (pull-ups)
+}
+
+int analogRead(int pin) {
+  // Floating-pin noise, different per node but reproducible
+  return (int)((sim::node.cfg.index * 2654435761u + pin) & 0x3FF);
+}
+
+void attachInterrupt(int irq, void (*fn)(), int mode) {
+  if (irq < 0 || irq >= sim::Node::PIN_COUNT) return;
+  sim::node.isr[irq] = fn;
+  sim::node.isrMode[irq] = (uint8_t)mode;
+}
+
+void detachInterrupt(int irq) {
+  if (irq < 0 || irq >= sim::Node::PIN_COUNT) return;
+  sim::node.isr[irq] = nullptr;
+}
+
+void noInterrupts() { sim::node.irqMasked = true; }
+void interrupts() { sim::node.irqMasked = false; }
+
+void sim::raise(int pin, int edge) {
+  if (pin < 0 || pin >= Node::PIN_COUNT || !node.isr[pin] || node.irqMasked) return;
+  uint8_t mode = node.isrMode[pin];
+  if (mode == edge || mode == CHANGE) {
+    // The exception return ends a WFE, once the core has woken up
+    if (node.asleep) node.wakeAt = std::min<uint64_t>(node.wakeAt, nowUs() + node.cfg.wakeUs);
+    node.isr[pin]();
+  }
+}
+
+// ────────────────────────────────
+// random(): per-node LCG so runs are reproducible
+// ────────────────────────────────
+static uint32_t rngState = 1;
+
+void randomSeed(unsigned long s) { rngState = (uint32_t)s ? (uint32_t)s : 1; }
+
+static uint32_t nextRandom() {
+  rngState = rngState * 1664525u + 1013904223u;
+  return rngState >> 1;
+}
+
+long random(long max) { return max > 0 ? (long)(nextRandom() % (uint32_t)max) : 0; }
+long random(long min, long max) { return max > min ? min + random(max - min) : min; }
+
+// ────────────────────────────────
+// Serial: line-buffered to the host log
+// ────────────────────────────────
+SimSerial Serial;
+
+size_t SimSerial::write(uint8_t c) {
+  if (c == '\n' || len == sizeof(line) - 1) {
+    line[len] = 0;
+    if (sim::node.host) sim::node.host->log(sim::node.cfg.index, line);
+    len = 0;
+    if (c == '\n') return 1;
+  }
+  if (c != '\r') line[len++] = (char)c;
+  return 1;
+}
@@ -0,0 +1,30 @@
+#include <LittleFS.h>
+
+FS LittleFS;
+
+File FS::open(const char *path, const char *mode) {
+  bool read = mode[0] == 'r';
+  bool plus = mode[1] == '+';
+  auto it = files.find(path);
+
+  if (read) {
+    if (it == files.end()) return File();
+    return File(it->second, plus, false);
+  }
+
+  // "w" truncates, "a" appends; both create
+  if (it == files.end()) {
+    it = files.emplace(path, std::make_shared<std::vector<uint8_t>>()).first;
+  } else if (mode[0] == 'w') {
+    it->second->clear();
+  }
+  return File(it->second, true, mode[0] == 'a');
+}
+
+bool FS::rename(const char *from, const char *to) {
+  auto it = files.find(from);
+  if (it == files.end()) return false;
+  files[to] = it->second;
+  files.erase(it);
+  return true;
+}
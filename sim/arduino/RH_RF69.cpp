@@ -0,0 +1,274 @@
+#include <RH_RF69.h>
+#include "SimNode.h"
+
+RHGenericSPI hardware_spi;
+
+// Bit rate per ModemConfigChoice, same order as the enum
+static const uint32_t MODEM_BPS[] = {
+  2000, 2400, 4800, 9600, 19200, 38400, 57600, 125000, 250000, 55555,  // FSK
+  2000, 2400, 4800, 9600, 19200, 38400, 57600, 125000, 250000, 55555,  // GFSK
+  1000, 1200, 2400, 4800, 9600, 19200, 32000                           // OOK
+};
+static const uint8_t MODEM_COUNT = sizeof(MODEM_BPS) / sizeof(MODEM_BPS[0]);
+
+static RH_RF69 *interruptDevice = nullptr;
+
+uint8_t RHSPIDriver::spiBurstRead(uint8_t reg, uint8_t *dest, uint8_t len) {
+  simSpiTransfers++;
+  simSpiBurst = true;
+  for (uint8_t i = 0; i < len; i++) dest[i] = spiRead(reg == RH_RF69_REG_00_FIFO ? reg : reg + i);
+  simSpiBurst = false;
+  return 0;
+}
+
+uint8_t RHSPIDriver::spiBurstWrite(uint8_t reg, const uint8_t *src, uint8_t len) {
+  simSpiTransfers++;
+  simSpiBurst = true;
+  for (uint8_t i = 0; i < len; i++) spiWrite(reg == RH_RF69_REG_00_FIFO ? reg : reg + i, src[i]);
+  simSpiBurst = false;
+  return 0;
+}
+
+RH_RF69::RH_RF69(uint8_t slaveSelectPin, uint8_t interruptPin, RHGenericSPI &spi)
+  : RHSPIDriver(slaveSelectPin, spi), _interruptPin(interruptPin) {
+  sim::node.radio = this;
+}
+
+bool RH_RF69::init() {
+  interruptDevice = this;
+  attachInterrupt(digitalPinToInterrupt(_interruptPin), isr0, RISING);
+  setModeIdle();
+  setFrequency(434.0);
+  setModemConfig(GFSK_Rb250Fd250);
+  setPreambleLength(4);
+  setTxPower(13);
+  return true;
+}
+
+void RH_RF69::isr0() {
+  if (interruptDevice) interruptDevice->handleInterrupt();
+}
+
+// ────────────────────────────────
+// Register file
+// ────────────────────────────────
+uint8_t RH_RF69::spiRead(uint8_t reg) {
+  if (!simSpiBurst) simSpiTransfers++;
+  reg &= 0x7F;
+  switch (reg) {
+    case RH_RF69_REG_24_RSSIVALUE: {
+      int16_t rssi = sim::node.host ? sim::node.host->channelRssi(sim::node.cfg.index, frf()) : -127;
+      return (uint8_t)constrain(-rssi * 2, 0, 255);
+    }
+    case RH_RF69_REG_23_RSSICONFIG:
+      return RH_RF69_RSSICONFIG_RSSIDONE;
+    case RH_RF69_REG_27_IRQFLAGS1:
+      return RH_RF69_IRQFLAGS1_MODEREADY;
+    default:
+      return regs[reg];
+  }
+}
+
+uint8_t RH_RF69::spiWrite(uint8_t reg, uint8_t val) {
+  if (!simSpiBurst) simSpiTransfers++;
+  reg &= 0x7F;
+  uint8_t old = regs[reg];
+  if (reg == RH_RF69_REG_00_FIFO) {
+    if (fifoLen < sizeof(fifo)) fifo[fifoLen++] = val;
+    return old;
+  }
+  regs[reg] = val;
+  if (reg == RH_RF69_REG_01_OPMODE) {
+    switch (val & RH_RF69_OPMODE_MODE) {
+      case RH_RF69_OPMODE_MODE_TX: setModeTx(); break;
+      case RH_RF69_OPMODE_MODE_RX: setModeRx(); break;
+      case RH_RF69_OPMODE_MODE_SLEEP: _mode = RHModeSleep; break;
+      default: _mode = RHModeIdle; break;
+    }
+  }
+  return old;
+}
+
+uint32_t RH_RF69::frf() const {
+  return ((uint32_t)regs[RH_RF69_REG_07_FRFMSB] << 16) | ((uint32_t)regs[RH_RF69_REG_08_FRFMID] << 8) |
+         regs[RH_RF69_REG_09_FRFLSB];
+}
+
+bool RH_RF69::setFrequency(float centre, float afcPullInRange) {
+  (void)afcPullInRange;
+  uint32_t frf = (uint32_t)((centre * 1000000.0) / RH_RF69_FSTEP);
+  spiWrite(RH_RF69_REG_07_FRFMSB, (frf >> 16) & 0xff);
+  spiWrite(RH_RF69_REG_08_FRFMID, (frf >> 8) & 0xff);
+  spiWrite(RH_RF69_REG_09_FRFLSB, frf & 0xff);
+  return true;
+}
+
+int8_t RH_RF69::rssiRead() {
+  return -((int8_t)(spiRead(RH_RF69_REG_24_RSSIVALUE) >> 1));
+}
+
+// ────────────────────────────────
+// Modes
+// ────────────────────────────────
+void RH_RF69::setOpMode(uint8_t mode) {
+  regs[RH_RF69_REG_01_OPMODE] = (regs[RH_RF69_REG_01_OPMODE] & ~RH_RF69_OPMODE_MODE) | (mode & RH_RF69_OPMODE_MODE);
+}
+
+void RH_RF69::setModeIdle() {
+  if (_mode == RHModeIdle) return;
+  if (_mode == RHModeTx) txEndAt_us = 0;  // transmitter cut off mid-frame
+  setOpMode(_idleMode);
+  _mode = RHModeIdle;
+}
+
+void RH_RF69::setModeRx() {
+  if (_mode == RHModeRx) return;
+  setOpMode(RH_RF69_OPMODE_MODE_RX);
+  _mode = RHModeRx;
+}
+
+// The frame in the FIFO goes on air now
+void RH_RF69::setModeTx() {
+  if (_mode == RHModeTx) return;
+  setOpMode(RH_RF69_OPMODE_MODE_TX);
+  _mode = RHModeTx;
+
+  uint32_t air = simAirtimeUs(fifoLen > RH_RF69_HEADER_LEN ? fifoLen - RH_RF69_HEADER_LEN : 0);
+  txEndAt_us = sim::nowUs() + air;
+  if (sim::node.host)
+    sim::node.host->transmit(sim::node.cfg.index, frf(), modem, _power, fifo, fifoLen, air);
+  fifoLen = 0;
+}
+
+bool RH_RF69::sleep() {
+  if (_mode == RHModeTx) txEndAt_us = 0;
+  setOpMode(RH_RF69_OPMODE_MODE_SLEEP);
+  _mode = RHModeSleep;
+  return true;
+}
+
+void RH_RF69::setTxPower(int8_t power, bool ishighpowermodule) {
+  _power = ishighpowermodule ? constrain(power, -2, 20) : constrain(power, -18, 13);
+}
+
+bool RH_RF69::setModemConfig(ModemConfigChoice index) {
+  if ((uint8_t)index >= MODEM_COUNT) return false;
+  modem = (uint8_t)index;
+  uint16_t br = (uint16_t)(RH_RF69_FXOSC / MODEM_BPS[modem]);
+  regs[RH_RF69_REG_03_BITRATEMSB] = br >> 8;
+  regs[RH_RF69_REG_04_BITRATELSB] = br & 0xff;
+  return true;
+}
+
+// preamble + sync + length byte + (headers + payload, AES-padded) + CRC
+uint32_t RH_RF69::simAirtimeUs(uint8_t payloadLen) const {
+  uint32_t body = RH_RF69_HEADER_LEN + payloadLen;
+  if (encrypted) body = (body + 15) & ~15u;
+  uint32_t bits = 8 * (preambleLen + syncLen + 1 + body + 2);
+  return (uint32_t)((uint64_t)bits * 1000000u / MODEM_BPS[modem]);
+}
+
+// ────────────────────────────────
+// Packet API
+// ────────────────────────────────
+bool RH_RF69::send(const uint8_t *data, uint8_t len) {
+  if (len > RH_RF69_MAX_MESSAGE_LEN) return false;
+  waitPacketSent();
+  setModeIdle();
+
+  fifoLen = 0;
+  fifo[fifoLen++] = _txHeaderTo;
+  fifo[fifoLen++] = _txHeaderFrom;
+  fifo[fifoLen++] = _txHeaderId;
+  fifo[fifoLen++] = _txHeaderFlags;
+  memcpy(fifo + fifoLen, data, len);
+  fifoLen += len;
+
+  setModeTx();
+  return true;
+}
+
+// Blocking wait: run the clock forward to the end of the frame
+bool RH_RF69::waitPacketSent() {
+  if (_mode != RHModeTx) return true;
+  uint64_t now = sim::nowUs();
+  if (txEndAt_us > now) delayMicroseconds((uint32_t)(txEndAt_us - now));
+  simService();
+  return true;
+}
+
+bool RH_RF69::available() {
+  if (_mode == RHModeTx) return false;
+  setModeRx();
+  return _rxBufValid;
+}
+
+bool RH_RF69::recv(uint8_t *buf, uint8_t *len) {
+  if (!available()) return false;
+  if (buf && len) {
+    if (*len > _bufLen) *len = _bufLen;
+    memcpy(buf, _buf, *len);
+  }
+  _rxBufValid = false;
+  return true;
+}
+
+// ────────────────────────────────
+// DIO0: PacketSent in TX, PayloadReady in RX
+// ────────────────────────────────
+void RH_RF69::handleInterrupt() {
+  uint8_t irqflags2 = regs[RH_RF69_REG_28_IRQFLAGS2];
+  if (_mode == RHModeTx && (irqflags2 & RH_RF69_IRQFLAGS2_PACKETSENT)) {
+    regs[RH_RF69_REG_28_IRQFLAGS2] &= ~RH_RF69_IRQFLAGS2_PACKETSENT;
+    _txGood++;
+    setModeIdle();
+  }
+  if (_mode == RHModeRx && (irqflags2 & RH_RF69_IRQFLAGS2_PAYLOADREADY)) {
+    regs[RH_RF69_REG_28_IRQFLAGS2] &= ~RH_RF69_IRQFLAGS2_PAYLOADREADY;
+    _lastRssi = rxRssi;
+    _lastPreambleTime = millis();
+    setModeIdle();
+    readFifo();
+  }
+}
+
+void RH_RF69::readFifo() {
+  rxPending = false;
+  if (rxLen < RH_RF69_HEADER_LEN) return;
+
+  _rxHeaderTo = rxFrame[0];
+  _rxHeaderFrom = rxFrame[1];
+  _rxHeaderId = rxFrame[2];
+  _rxHeaderFlags = rxFrame[3];
+  if (_promiscuous || _rxHeaderTo == _thisAddress || _rxHeaderTo == RH_BROADCAST_ADDRESS) {
+    _bufLen = rxLen - RH_RF69_HEADER_LEN;
+    memcpy(_buf, rxFrame + RH_RF69_HEADER_LEN, _bufLen);
+    _rxGood++;
+    _rxBufValid = true;
+  }
+}
+
+void RH_RF69::simDeliver(uint32_t txFrf, uint8_t txModem, const uint8_t *frame, uint8_t len, int16_t rssi) {
+  // Only a receiver tuned to the same channel and rate, listening, demodulates it
+  if (txFrf != frf() || txModem != modem) return;
+  if (_mode != RHModeRx || _rxBufValid || len > sizeof(rxFrame)) {
+    _rxBad++;
+    return;
+  }
+  memcpy(rxFrame, frame, len);
+  rxLen = len;
+  rxRssi = rssi;
+  rxPending = true;
+}
+
+void RH_RF69::simService() {
+  if (_mode == RHModeTx && txEndAt_us && sim::nowUs() >= txEndAt_us) {
+    txEndAt_us = 0;
+    regs[RH_RF69_REG_28_IRQFLAGS2] |= RH_RF69_IRQFLAGS2_PACKETSENT;
+    sim::raise(digitalPinToInterrupt(_interruptPin), RISING);
+  }
+  if (_mode == RHModeRx && rxPending) {
+    regs[RH_RF69_REG_28_IRQFLAGS2] |= RH_RF69_IRQFLAGS2_PAYLOADREADY;
+    sim::raise(digitalPinToInterrupt(_interruptPin), RISING);
+  }
+}
@@ -0,0 +1,99 @@
+#include "SimNode.h"
+#include <chrono>
+#include "Radio.h"
+
+// ────────────────────────────────
+// Host benchmarks: firmware hot paths, timed on the host's clock
+// ────────────────────────────────
+// Called by the native tests on a node that was attached but not set up
+// unless stated; virtual time moves only through host->advance().
+extern Radio radio;
+
+typedef std::chrono::steady_clock BenchClock;
+
+static uint64_t elapsedNs(BenchClock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - since).count();
+}
+
+// One frame every gap_us, each air_us long: computeAirtime() before the send
+// fills air20/airtot, recordAirtime() at PacketSent. Returns the duty cycle
+// the window reports afterwards.
+SIM_EXPORT uint64_t sim_bench_airtime(uint32_t packets, uint32_t gap_us, uint32_t air_us, float *duty_pct) {
+  float last_ms, avg_ms, duty = 0;
+  BenchClock::time_point start = BenchClock::now();
+  for (uint32_t i = 0; i < packets; i++) {
+    sim::node.host->advance(gap_us);
+    radio.computeAirtime(last_ms, avg_ms, duty);
+    radio.recordAirtime(air_us);
+  }
+  uint64_t ns = elapsedNs(start);
+  radio.computeAirtime(last_ms, avg_ms, duty);
+  *duty_pct = duty;
+  return ns;
+}
+
+// RX, after sim_setup(): `frames` PT_PINs round-robin from node addresses
+// 1..nodes, each a new pin state, from the PayloadReady IRQ through the
+// receive dispatch to the HID side. Frames are injected on whatever channel
+// and rate the radio listens on; the ACKs they queue are never sent.
+SIM_EXPORT uint64_t sim_bench_rx(uint8_t nodes, uint32_t frames, uint8_t *active) {
+  static uint32_t seq[MAX_TX + 1];
+  uint8_t frame[RH_RF69_HEADER_LEN + sizeof(Packet)] = { RH_BROADCAST_ADDRESS };
+  Packet &pkt = *reinterpret_cast<Packet *>(frame + RH_RF69_HEADER_LEN);
+  pkt.to = 0;
+  pkt.type = PT_PIN;
+
+  BenchClock::time_point start = BenchClock::now();
+  for (uint32_t i = 0; i < frames; i++) {
+    uint8_t addr = 1 + i % nodes;
+    uint32_t s = ++seq[addr];
+    frame[1] = addr;
+    pkt.from = addr;
+    pkt.seq = s;
+    pkt.epoch = (uint16_t)s;
+    pkt.pins = (s & 1) ? 0xFFFE : 0xFFFF;  // pin 0 down, up, down…
+
+    sim::node.host->advance(100);
+    radio.rf69.setModeRx();  // as after the last releaseRx()
+    sim::node.radio->simInject(frame, sizeof(frame), -60);
+    sim::node.radio->simService();
+    radio.serviceRx();
+    radio.dispatchPinEvents();
+  }
+  uint64_t ns = elapsedNs(start);
+  *active = peers.activeCount();
+  return ns;
+}
+
+// Retune `n` times between the first two hop channels, alternately through
+// setFrequency() and through the cached RegFrf burst tuneChannel() uses.
+// Returns the ns of the cached path; *setFreqNs gets setFrequency()'s, and
+// the SPI transfers per retune of each go to *cachedSpi and *setFreqSpi.
+SIM_EXPORT uint64_t sim_bench_tune(uint32_t n, uint64_t *setFreqNs, uint32_t *cachedSpi, uint32_t *setFreqSpi) {
+  const float mhz[2] = { RF69_FREQ_MHZ, RF69_FREQ_MHZ + HOP_SPACING_KHZ / 1000.0f };
+  const uint32_t frf[2] = { RadioDriver::frfFor(mhz[0]), RadioDriver::frfFor(mhz[1]) };
+  RadioDriver &rf = radio.rf69;
+  rf.setModeIdle();
+
+  uint32_t spi = rf.simSpiTransfers;
+  BenchClock::time_point start = BenchClock::now();
+  for (uint32_t i = 0; i < n; i++) rf.setFrequency(mhz[i & 1]);
+  *setFreqNs = elapsedNs(start);
+  *setFreqSpi = (rf.simSpiTransfers - spi) / n;
+
+  spi = rf.simSpiTransfers;
+  start = BenchClock::now();
+  for (uint32_t i = 0; i < n; i++) rf.setFrf(frf[i & 1]);
+  uint64_t ns = elapsedNs(start);
+  *cachedSpi = (rf.simSpiTransfers - spi) / n;
+  return ns;
+}
+
+// A fresh TxGovernor asked to admit a frame of `type` every poll_ms for
+// duration_ms at 0 % duty; returns how many it let through
+SIM_EXPORT uint32_t sim_bench_governor(uint8_t type, uint32_t poll_ms, uint32_t duration_ms) {
+  TxGovernor gov;
+  uint32_t admitted = 0;
+  for (uint32_t t = 0; t <= duration_ms; t += poll_ms) admitted += gov.admit(type, 0, t);
+  return admitted;
+}
@@ -0,0 +1,76 @@
+#include "SimNode.h"
+#include <execinfo.h>
+#include <unistd.h>
+
+// ────────────────────────────────
+// Heap hook: allocations after setup()
+// ────────────────────────────────
+// build_firmware.py links the firmware with --wrap for each of these, so
+// every call the node's own objects make (firmware, stand-ins and the
+// templates instantiated in them; urgent hook, loop() and ISRs alike) comes
+// through here first. Once sim_setup() seals the heap each one is counted,
+// and the first per node prints a backtrace to stderr.
+extern "C" {
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t n);
+void *__real__Znwm(size_t n);                             // operator new
+void *__real__Znam(size_t n);                             // operator new[]
+void *__real__ZnwmRKSt9nothrow_t(size_t n, const void *tag);  // operator new, nothrow
+void *__real__ZnamRKSt9nothrow_t(size_t n, const void *tag);  // operator new[], nothrow
+}
+
+static void noteAlloc(size_t n) {
+  static bool tracing = false;  // backtrace() may allocate on first use
+  if (!sim::node.heapSealed || tracing) return;
+  sim::node.heapBytes += n;
+  if (sim::node.heapAllocs++) return;
+  tracing = true;
+  fprintf(stderr, "sim: node %u allocated %zu bytes after setup()\n", sim::node.cfg.index, n);
+  void *frames[24];
+  backtrace_symbols_fd(frames, backtrace(frames, 24), STDERR_FILENO);
+  tracing = false;
+}
+
+extern "C" {
+void *__wrap_malloc(size_t n) {
+  noteAlloc(n);
+  return __real_malloc(n);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+  noteAlloc(n * size);
+  return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *p, size_t n) {
+  noteAlloc(n);
+  return __real_realloc(p, n);
+}
+
+void *__wrap__Znwm(size_t n) {
+  noteAlloc(n);
+  return __real__Znwm(n);
+}
+
+void *__wrap__Znam(size_t n) {
+  noteAlloc(n);
+  return __real__Znam(n);
+}
+
+void *__wrap__ZnwmRKSt9nothrow_t(size_t n, const void *tag) {
+  noteAlloc(n);
+  return __real__ZnwmRKSt9nothrow_t(n, tag);
+}
+
+void *__wrap__ZnamRKSt9nothrow_t(size_t n, const void *tag) {
+  noteAlloc(n);
+  return __real__ZnamRKSt9nothrow_t(n, tag);
+}
+}
+
+// Allocations since setup() returned; *bytes gets their total size
+SIM_EXPORT uint32_t sim_heap(uint64_t *bytes) {
+  *bytes = sim::node.heapBytes;
+  return sim::node.heapAllocs;
+}
@@ -0,0 +1,156 @@
+#include "SimNode.h"
+#include <RH_RF69.h>
+#include <Adafruit_TinyUSB.h>
+#include <LittleFS.h>
+#include "Config.h"
+#include "Trace.h"
+#include "Radio.h"
+#include "Storage.h"
+
+// Constant-initialised (no constructor runs), so peripherals constructed by
+// the firmware's globals can register here regardless of init order.
+sim::Node sim::node;
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+extern Radio radio;
+
+// ────────────────────────────────
+// Host → node entry points
+// ────────────────────────────────
+SIM_EXPORT void sim_attach(SimHost *host, const SimNodeConfig *cfg) {
+  sim::node.host = host;
+  sim::node.cfg = *cfg;
+  DEBUG_LEVEL = cfg->debugLevel;
+  randomSeed(cfg->index + 1);
+
+  // Pre-provisioned identity, as if the node had been assigned earlier
+  if (cfg->nodeAddr) {
+    File f = LittleFS.open("/config.json", "w");
+    f.printf("{\"node_addr\":%u,\"node_name\":\"TX%u\"}", cfg->nodeAddr, cfg->nodeAddr);
+    f.close();
+  }
+}
+
+SIM_EXPORT void sim_setup() {
+  setup();
+  sim::node.heapSealed = true;
+}
+
+// Deliver whatever hardware events are due, then one pass of loop() unless
+// the node sleeps in WFE and none of them raised an interrupt
+SIM_EXPORT void sim_step() {
+  if (sim::node.radio) sim::node.radio->simService();
+  if (sim::node.hid) sim::node.hid->simService();
+  sim::node.steps++;
+  if (sim::node.asleep && sim::nowUs() < sim::node.wakeAt) return;
+  sim::node.asleep = false;
+  sim::node.awakeSteps++;
+  loop();
+}
+
+// Share of host ticks in which loop() ran, the stand-in for CPU active time
+SIM_EXPORT void sim_cpu(uint64_t *awake, uint64_t *steps) {
+  *awake = sim::node.awakeSteps;
+  *steps = sim::node.steps;
+}
+
+// Logical pin levels as the firmware sees them after PCF_INVERT_MASK
+SIM_EXPORT void sim_set_pins(uint16_t pins) {
+  uint16_t raw = pins ^ PCF_INVERT_MASK;
+  if (raw == sim::node.pcfPins) return;
+  sim::node.pcfPins = raw;
+  if (!sim::node.pcfIntLow) {
+    sim::node.pcfIntLow = true;
+    sim::raise(PCF_INT_PIN, FALLING);
+  }
+}
+
+SIM_EXPORT void sim_receive(uint32_t frf, uint8_t modem, const uint8_t *frame, uint8_t len, int16_t rssi) {
+  if (sim::node.radio) sim::node.radio->simDeliver(frf, modem, frame, len, rssi);
+}
+
+// First action bound to (node addr, pin), for the host's expected-output tracking
+SIM_EXPORT void sim_binding(uint8_t addr, uint8_t pin, uint8_t *type, uint8_t *code) {
+  const HidAction &act = hidMapFor(addr)[pin % BTN_COUNT].actions[0];
+  *type = act.type;
+  *code = act.code;
+}
+
+// End-of-run summary from the firmware's own instrumentation
+SIM_EXPORT void sim_report() {
+  Trace::report(Serial);
+}
+
+// One Trace stage's histogram: returns the pct percentile (bucket upper edge)
+SIM_EXPORT uint32_t sim_trace(uint8_t stage, uint8_t pct, uint32_t *max_us, uint32_t *count) {
+  Trace::task();
+  const LatencyHist &h = Trace::hist((LatencyStage)stage);
+  *max_us = h.maxUs();
+  *count = h.count();
+  return h.percentile(pct);
+}
+
+// The IRQ → dispatch histogram of Radio::serviceRx()/receiveTx()
+SIM_EXPORT uint32_t sim_rx_dispatch(uint8_t pct, uint32_t *max_us, uint32_t *count) {
+  *max_us = radio.rxLatency.maxUs();
+  *count = radio.rxLatency.count();
+  return radio.rxLatency.percentile(pct);
+}
+
+// A LatencyHist(shift) fed `samples`, for checking its percentiles
+SIM_EXPORT uint32_t sim_hist_percentile(uint8_t shift, const uint32_t *samples, uint32_t n, uint8_t pct) {
+  LatencyHist h(shift);
+  for (uint32_t i = 0; i < n; i++) h.add(samples[i]);
+  return h.percentile(pct);
+}
+
+// ────────────────────────────────
+// Error log probes (Storage.cpp) and the node's flash
+// ────────────────────────────────
+// A reboot is a fresh instance of the firmware given the old one's files.
+SIM_EXPORT bool sim_storage_begin() {
+  return Storage::begin();
+}
+
+SIM_EXPORT void sim_log_error(int code, uint16_t arg) {
+  Storage::logError(code, arg);
+}
+
+SIM_EXPORT void sim_log_flush() {
+  Storage::flushLog();
+}
+
+// Storage::exportLog() into buf, cut at len - 1 and terminated; returns the full length
+SIM_EXPORT uint32_t sim_log_export(char *buf, uint32_t len) {
+  struct BufferPrint : Print {
+    char *buf;
+    uint32_t len, n = 0;
+    BufferPrint(char *b, uint32_t l) : buf(b), len(l) {}
+    size_t write(uint8_t c) override {
+      if (n + 1 < len) buf[n] = (char)c;
+      n++;
+      return 1;
+    }
+  } out(buf, len);
+  Storage::exportLog(out);
+  if (len) buf[min(out.n, len - 1)] = 0;
+  return out.n;
+}
+
+// Copy a file out of the node's LittleFS; returns its size (0 if missing)
+SIM_EXPORT uint32_t sim_fs_read(const char *path, uint8_t *buf, uint32_t len) {
+  File f = LittleFS.open(path, "r");
+  if (!f) return 0;
+  uint32_t size = f.size();
+  f.read(buf, min(size, len));
+  f.close();
+  return size;
+}
+
+SIM_EXPORT void sim_fs_write(const char *path, const uint8_t *buf, uint32_t len) {
+  File f = LittleFS.open(path, "w");
+  f.write(buf, len);
+  f.close();
+}
@@ -0,0 +1,40 @@
+#include <Adafruit_TinyUSB.h>
+#include "SimNode.h"
+
+Adafruit_USBD_Device TinyUSBDevice;
+
+Adafruit_USBD_HID::Adafruit_USBD_HID() {
+  sim::node.hid = this;
+}
+
+bool Adafruit_USBD_HID::sendReport(uint8_t reportId, void const *report, uint8_t n) {
+  if (busy || n > sizeof(buf)) return false;
+  id = reportId;
+  len = n;
+  memcpy(buf, report, n);
+  busy = true;
+
+  // Taken at the next poll slot after now
+  uint64_t period = (uint64_t)pollMs * 1000;
+  dueAt_us = (sim::nowUs() / period + 1) * period;
+  return true;
+}
+
+bool Adafruit_USBD_HID::keyboardReport(uint8_t reportId, uint8_t modifier, uint8_t keycode[6]) {
+  uint8_t report[8] = { modifier, 0 };
+  if (keycode) memcpy(report + 2, keycode, 6);
+  return sendReport(reportId, report, sizeof(report));
+}
+
+bool Adafruit_USBD_HID::mouseReport(uint8_t reportId, uint8_t buttons, int8_t x, int8_t y,
+                                    int8_t vertical, int8_t horizontal) {
+  uint8_t report[5] = { buttons, (uint8_t)x, (uint8_t)y, (uint8_t)vertical, (uint8_t)horizontal };
+  return sendReport(reportId, report, sizeof(report));
+}
+
+void Adafruit_USBD_HID::simService() {
+  if (!busy || sim::nowUs() < dueAt_us) return;
+  busy = false;
+  if (sim::node.host) sim::node.host->hidReport(sim::node.cfg.index, id, buf, len);
+  if (tud_hid_report_complete_cb) tud_hid_report_complete_cb(0, buf, len);
+}
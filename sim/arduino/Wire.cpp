@@ -0,0 +1,20 @@
+#include <Wire.h>
+#include <PCF8575.h>
+#include "SimNode.h"
+#include "Config.h"
+
+TwoWire Wire;
+
+// Every board has the OLED; only TX boards carry the PCF8575
+uint8_t TwoWire::endTransmission(bool stop) {
+  (void)stop;
+  if (addr == OLED_ADDR) return 0;
+  if (addr == PCF8575_ADDR && sim::node.cfg.tx) return 0;
+  return 2;  // NACK on address
+}
+
+// Reading the expander releases /INT
+uint16_t PCF8575::read16() {
+  sim::node.pcfIntLow = false;
+  return sim::node.pcfPins;
+}
@@ -0,0 +1,50 @@
+# PlatformIO pre-script for [env:native]: builds libfirmware.so from src/ and
+# the stand-ins in sim/arduino/, next to the host program that loads it once
+# per simulated node. libfirmware_tdma.so is the same firmware with the TDMA
+# superframe (and the hopping, rate and power control riding on it) switched
+# on, for rfsim --firmware and the tests of those features.
+import glob
+import os
+
+Import("env")
+
+root = env.subst("$PROJECT_DIR")
+build = os.path.join(env.subst("$BUILD_DIR"), "firmware")
+
+fw = env.Clone()
+fw.Replace(
+    CPPPATH=[
+        os.path.join(root, "sim", "include"),
+        os.path.join(root, "src"),
+        os.path.join(root, "lib", "ArduinoJson", "src"),
+    ],
+    LIBS=[],
+)
+fw.Append(
+    CPPDEFINES=[("ARDUINO", 10819), ("RADIO_ON_CORE1", 0)],
+    CCFLAGS=["-fPIC", "-fvisibility=hidden"],
+    CXXFLAGS=["-std=gnu++17", "-fvisibility-inlines-hidden"],
+)
+# sim/arduino/SimHeap.cpp sees every allocation the firmware makes
+fw.Append(LINKFLAGS=["-Wl,--wrap=" + sym for sym in (
+    "malloc", "calloc", "realloc",
+    "_Znwm", "_Znam", "_ZnwmRKSt9nothrow_t", "_ZnamRKSt9nothrow_t",
+)])
+
+sources = sorted(glob.glob(os.path.join(root, "src", "*.cpp")) +
+                 glob.glob(os.path.join(root, "sim", "arduino", "*.cpp")))
+
+
+def variant(name, defines):
+    var = fw.Clone()
+    var.Append(CPPDEFINES=defines)
+    objects = [
+        var.SharedObject(os.path.join(build, name, os.path.relpath(src, root) + ".o"), src)
+        for src in sources
+    ]
+    lib = var.SharedLibrary(os.path.join("$BUILD_DIR", name), objects)
+    env.Depends("$BUILD_DIR/${PROGNAME}$PROGSUFFIX", lib)
+
+
+variant("libfirmware", [])
+variant("libfirmware_tdma", [("TDMA_ENABLE", 1)])
@@ -0,0 +1,77 @@
+#include "Firmware.h"
+#include <dlfcn.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fstream>
+
+std::string defaultFirmwarePath(const char *name) {
+  char exe[PATH_MAX];
+  ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+  if (n <= 0) return name;
+  exe[n] = 0;
+  std::string dir(exe);
+  return dir.substr(0, dir.find_last_of('/') + 1) + name;
+}
+
+template <typename T>
+static bool bind(void *dl, const char *name, T &fn) {
+  fn = reinterpret_cast<T>(dlsym(dl, name));
+  if (!fn) fprintf(stderr, "rfsim: missing %s\n", name);
+  return fn != nullptr;
+}
+
+bool loadNode(const std::string &lib, SimNodeHandle &h) {
+  char path[] = "/tmp/rfsim.XXXXXX.so";
+  int fd = mkstemps(path, 3);
+  if (fd < 0) {
+    perror("rfsim: mkstemps");
+    return false;
+  }
+  close(fd);
+  {
+    std::ifstream in(lib, std::ios::binary);
+    std::ofstream out(path, std::ios::binary);
+    if (!in || !out || !(out << in.rdbuf())) {
+      fprintf(stderr, "rfsim: cannot copy %s\n", lib.c_str());
+      unlink(path);
+      return false;
+    }
+  }
+  h.dl = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  unlink(path);
+  if (!h.dl) {
+    fprintf(stderr, "rfsim: %s\n", dlerror());
+    return false;
+  }
+  h.cpu = reinterpret_cast<SimCpuFn>(dlsym(h.dl, "sim_cpu"));
+  return bind(h.dl, "sim_attach", h.attach) && bind(h.dl, "sim_setup", h.setup) &&
+         bind(h.dl, "sim_step", h.step) && bind(h.dl, "sim_set_pins", h.setPins) &&
+         bind(h.dl, "sim_receive", h.receive) && bind(h.dl, "sim_binding", h.binding) &&
+         bind(h.dl, "sim_report", h.report);
+}
+
+void unloadNode(SimNodeHandle &h) {
+  if (h.dl) dlclose(h.dl);
+  h.dl = nullptr;
+}
+
+void *findExport(const SimNodeHandle &h, const char *name) {
+  return h.dl ? dlsym(h.dl, name) : nullptr;
+}
+
+bool loadSingleNode(Medium &medium, const char *label, bool runSetup) {
+  medium.nodes.resize(1);
+  SimNodeHandle &h = medium.nodes[0];
+  h.label = label;
+  if (strncmp(label, "TX", 2) == 0) {
+    h.cfg.tx = true;
+    h.cfg.nodeAddr = (uint8_t)atoi(label + 2);
+  }
+  if (!loadNode(defaultFirmwarePath(), h)) return false;
+  h.attach(&medium, &h.cfg);
+  if (runSetup) h.setup();
+  return true;
+}
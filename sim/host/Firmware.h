@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include "Medium.h"
+
+// ────────────────────────────────
+// Loading firmware instances (rfsim and the native tests)
+// ────────────────────────────────
+// A firmware build next to the running program (pio puts them in $BUILD_DIR):
+// libfirmware.so as configured, libfirmware_tdma.so with TDMA_ENABLE=1
+std::string defaultFirmwarePath(const char *name = "libfirmware.so");
+
+// A private copy of `lib` in h.dl with every required sim_* entry point bound.
+// dlopen() hands back the same instance for the same file, hence the copy.
+bool loadNode(const std::string &lib, SimNodeHandle &h);
+void unloadNode(SimNodeHandle &h);
+
+// Optional export of a loaded node (benchmarks, probes); nullptr if absent
+void *findExport(const SimNodeHandle &h, const char *name);
+template <typename T>
+bool findExport(const SimNodeHandle &h, const char *name, T &fn) {
+  fn = reinterpret_cast<T>(findExport(h, name));
+  return fn != nullptr;
+}
+
+// The benchmarks' fixture: medium.nodes[0] alone, loaded from libfirmware.so
+// and attached. "TXn" is a TX pre-assigned address n, "RX" the receiver;
+// setup() runs only when asked (the benches drive the firmware directly).
+bool loadSingleNode(Medium &medium, const char *label, bool runSetup = false);
+template <typename T>
+bool loadSingleNode(Medium &medium, const char *label, const char *name, T &fn, bool runSetup = false) {
+  return loadSingleNode(medium, label, runSetup) && findExport(medium.nodes[0], name, fn);
+}
@@ -0,0 +1,163 @@
+#include "Medium.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+// Bit rate per RH_RF69::ModemConfigChoice (same order as the enum)
+static const uint32_t MODEM_BPS[] = {
+  2000, 2400, 4800, 9600, 19200, 38400, 57600, 125000, 250000, 55555,
+  2000, 2400, 4800, 9600, 19200, 38400, 57600, 125000, 250000, 55555,
+  1000, 1200, 2400, 4800, 9600, 19200, 32000
+};
+
+static const int16_t NOISE_FLOOR_DBM = -115;
+
+// RFM69 datasheet: about -120 dBm at 1.2 kbps, losing 10 dB per decade of rate
+int16_t Medium::sensitivity(uint8_t modem) {
+  uint32_t bps = modem < sizeof(MODEM_BPS) / sizeof(MODEM_BPS[0]) ? MODEM_BPS[modem] : 250000;
+  return (int16_t)lround(-120.0 + 10.0 * log10(bps / 1200.0));
+}
+
+int16_t Medium::rssiAt(const Frame &f, uint8_t node) const {
+  if (f.from == JAMMER) return f.power;
+  float loss = pathLossDb + pathLossStepDb * abs((int)f.from - (int)node);
+  return (int16_t)lroundf(f.power - loss);
+}
+
+void Medium::transmit(uint8_t node, uint32_t frf, uint8_t modem, int8_t powerDbm,
+                      const uint8_t *frame, uint8_t len, uint32_t airtime_us) {
+  Frame f = {};
+  f.from = node;
+  f.frf = frf;
+  f.modem = modem;
+  f.power = powerDbm;
+  f.start = now;
+  f.end = now + airtime_us;
+  f.len = std::min<uint8_t>(len, sizeof(f.data));
+  memcpy(f.data, frame, f.len);
+
+  markOverlaps(f, node);
+  onAir.push_back(f);
+  st.sent++;
+  st.airtime_us += airtime_us;
+  if (lastPowerDbm.size() <= node) lastPowerDbm.resize(node + 1);
+  lastPowerDbm[node] = powerDbm;
+  if (node > 0) {
+    st.txFrames++;
+    st.txPowerDbm += powerDbm;
+    st.txEnergyMj += pow(10.0, powerDbm / 10.0) * airtime_us / 1e6;
+  }
+}
+
+void Medium::markOverlaps(Frame &f, uint8_t node) {
+  for (Frame &o : onAir) {
+    if (o.end <= now) continue;
+    if (node != JAMMER) o.deafMask |= 1ull << node;  // half duplex: this node misses whatever is on air
+    if (o.frf == f.frf) {
+      if (!o.collided && o.from != JAMMER) st.collided++;
+      if (!f.collided && f.from != JAMMER) st.collided++;
+      o.collided = f.collided = true;
+    }
+  }
+}
+
+// Bursts of 1-3 ms with gaps drawn so each jammer is on dutyPct of the time
+void Medium::serviceJammers() {
+  for (Jammer &j : jammers) {
+    if (now < j.nextAt || j.dutyPct <= 0.0f) continue;
+    jamSeed ^= jamSeed << 13;
+    jamSeed ^= jamSeed >> 17;
+    jamSeed ^= jamSeed << 5;
+    uint32_t burst = 1000 + jamSeed % 2000;
+    Frame f = {};
+    f.from = JAMMER;
+    f.frf = j.frf;
+    f.power = (int8_t)j.dbm;
+    f.start = now;
+    f.end = now + burst;
+    markOverlaps(f, JAMMER);
+    onAir.push_back(f);
+    double gap = j.dutyPct >= 100.0f ? 0.0 : burst * (100.0 - j.dutyPct) / j.dutyPct;
+    j.nextAt = f.end + (uint64_t)(gap * (0.5 + (jamSeed >> 8) % 1000 / 1000.0));
+  }
+}
+
+int16_t Medium::channelRssi(uint8_t node, uint32_t frf) {
+  int16_t best = NOISE_FLOOR_DBM;
+  for (const Frame &f : onAir) {
+    if (f.frf != frf || f.from == node || f.start > now || f.end <= now) continue;
+    best = std::max(best, rssiAt(f, node));
+  }
+  return best;
+}
+
+void Medium::hidReport(uint8_t node, uint8_t reportId, const uint8_t *data, uint8_t len) {
+  st.hidReports++;
+  if (hidSink) hidSink->onHidReport(now, node, reportId, data, len);
+}
+
+void Medium::log(uint8_t node, const char *line) {
+  if (!echoLogs) return;
+  printf("%10.3f %-4s| %s\n", now / 1e6, nodes[node].label.c_str(), line);
+}
+
+bool Medium::injectLoss() {
+  if (lossPct <= 0.0f) return false;
+  lossSeed ^= lossSeed << 13;
+  lossSeed ^= lossSeed >> 17;
+  lossSeed ^= lossSeed << 5;
+  return (lossSeed % 10000) < (uint32_t)(lossPct * 100.0f);
+}
+
+// Frames whose airtime has ended reach every other node that could hear them
+void Medium::deliverDue() {
+  for (size_t i = 0; i < onAir.size();) {
+    const Frame &f = onAir[i];
+    if (f.end > now) {
+      i++;
+      continue;
+    }
+    if (f.from == JAMMER) {
+      // noise: nothing to deliver
+    } else if (f.end >= blackoutFrom && f.end < blackoutUntil) {
+      st.dropped++;
+    } else if (f.collided) {
+      if (f.from != 0) st.rxMissed++;
+    } else {
+      for (uint8_t n = 0; n < nodes.size(); n++) {
+        if (n == f.from) continue;
+        if ((f.deafMask >> n) & 1) {
+          if (n == 0) st.rxMissed++;
+          continue;
+        }
+        int16_t rssi = rssiAt(f, n);
+        if (rssi < sensitivity(f.modem)) {
+          st.weak++;
+          if (n == 0) {
+            st.rxMissed++;
+            st.rxWeak++;
+          }
+          continue;
+        }
+        if (injectLoss()) {
+          st.dropped++;
+          continue;
+        }
+        nodes[n].receive(f.frf, f.modem, f.data, f.len, rssi);
+        st.delivered++;
+      }
+    }
+    onAir.erase(onAir.begin() + i);
+  }
+}
+
+void Medium::run(uint64_t until) {
+  while (now < until) {
+    serviceJammers();
+    deliverDue();
+    for (SimNodeHandle &n : nodes) n.step();
+    now += tick_us;
+  }
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "SimHost.h"
+
+// ────────────────────────────────
+// One loaded firmware instance
+// ────────────────────────────────
+struct SimNodeHandle {
+  std::string label;  // "RX", "TX3", …
+  SimNodeConfig cfg = {};
+  void *dl = nullptr;
+
+  SimAttachFn attach = nullptr;
+  SimVoidFn setup = nullptr;
+  SimVoidFn step = nullptr;
+  SimSetPinsFn setPins = nullptr;
+  SimReceiveFn receive = nullptr;
+  SimBindingFn binding = nullptr;
+  SimVoidFn report = nullptr;
+  SimCpuFn cpu = nullptr;  // optional: firmware built before tickless idle lacks it
+};
+
+// IN reports reach the workload through this hook (edge → USB latency)
+class SimHidSink {
+public:
+  virtual ~SimHidSink() {}
+  virtual void onHidReport(uint64_t t_us, uint8_t node, uint8_t reportId, const uint8_t *data, uint8_t len) = 0;
+};
+
+// ────────────────────────────────
+// Virtual clock + shared RF channel
+// ────────────────────────────────
+// Every frame occupies its FRF channel from start to end of airtime. Any
+// overlap on the same channel corrupts all overlapping frames (no capture
+// effect), a node cannot hear frames that overlap its own transmissions, and
+// a frame below the rate-dependent sensitivity is not received.
+class Medium : public SimHost {
+public:
+  struct Stats {
+    uint32_t sent = 0;
+    uint32_t delivered = 0;   // handed to a receiver in range (it may not be listening)
+    uint32_t collided = 0;    // frames destroyed by an overlap
+    uint32_t weak = 0;        // below sensitivity at some receiver
+    uint32_t rxMissed = 0;    // TX frames the RX (node 0) never got: collided, deaf or too weak
+    uint32_t rxWeak = 0;      // of those, below sensitivity at the RX
+    uint32_t dropped = 0;     // removed by loss injection or an outage
+    uint64_t airtime_us = 0;  // sum over all frames
+    uint32_t txFrames = 0;    // sent by TX nodes (index > 0)
+    double txPowerDbm = 0;    // summed over those frames
+    double txEnergyMj = 0;    // radiated: mW × airtime
+    uint32_t hidReports = 0;
+  };
+
+  std::vector<SimNodeHandle> nodes;
+  SimHidSink *hidSink = nullptr;
+  bool echoLogs = false;
+  uint32_t tick_us = 50;
+
+  // Path loss between two nodes: base + step × |index difference|
+  float pathLossDb = 60.0f;
+  float pathLossStepDb = 2.0f;
+
+  // Independent per-receiver frame loss on top of the channel model
+  float lossPct = 0.0f;
+  uint32_t lossSeed = 1;
+
+  // Every frame ending inside [blackoutFrom, blackoutUntil) is lost (outage)
+  uint64_t blackoutFrom = 0;
+  uint64_t blackoutUntil = 0;
+
+  // Interferers: noise bursts on one FRF for dutyPct of the time, heard at
+  // dbm by every node; they corrupt overlapping frames and raise RSSI
+  struct Jammer {
+    uint32_t frf;
+    float dutyPct;
+    int16_t dbm;
+    uint64_t nextAt;
+  };
+  std::vector<Jammer> jammers;
+  uint32_t jamSeed = 1;
+
+  std::vector<int8_t> lastPowerDbm;  // per node index: power of its last frame
+
+  // SimHost
+  uint64_t nowUs() override { return now; }
+  void advance(uint32_t us) override { now += us; }
+  void transmit(uint8_t node, uint32_t frf, uint8_t modem, int8_t powerDbm,
+                const uint8_t *frame, uint8_t len, uint32_t airtime_us) override;
+  int16_t channelRssi(uint8_t node, uint32_t frf) override;
+  void hidReport(uint8_t node, uint8_t reportId, const uint8_t *data, uint8_t len) override;
+  void log(uint8_t node, const char *line) override;
+
+  // Advance in tick_us steps until `until`, running every node once per tick
+  void run(uint64_t until);
+  const Stats &stats() const { return st; }
+
+private:
+  struct Frame {
+    uint8_t from;  // node index, or JAMMER
+    uint32_t frf;
+    uint8_t modem;
+    int8_t power;
+    uint64_t start, end;
+    uint8_t len;
+    uint8_t data[66];
+    bool collided;
+    uint64_t deafMask;  // nodes that were transmitting while this frame was on air
+  };
+
+  void deliverDue();
+  void serviceJammers();
+  void markOverlaps(Frame &f, uint8_t node);
+  bool injectLoss();
+  int16_t rssiAt(const Frame &f, uint8_t node) const;
+  static int16_t sensitivity(uint8_t modem);
+
+  static const uint8_t JAMMER = 0xFF;
+  uint64_t now = 0;
+  std::vector<Frame> onAir;
+  Stats st;
+};
@@ -0,0 +1,371 @@
+// ────────────────────────────────
+// rfsim: N TX nodes + 1 RX node of the real firmware on one virtual channel
+// ────────────────────────────────
+// Each node is a private copy of libfirmware.so (src/ + sim/arduino/), loaded
+// with RTLD_LOCAL so every global in the firmware exists once per node. The
+// host steps all nodes in lockstep on a virtual clock, so runs are
+// deterministic for a given seed.
+#include "Rfsim.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "Firmware.h"
+#include "Trace.h"
+
+// RH_RF69_FSTEP: RegFrf units in Hz
+static const double FRF_STEP_HZ = 32000000.0 / 524288;
+
+// Mirrors HidType in src/Hid.h
+enum : uint8_t { OUT_NONE = 0, OUT_KEYBOARD = 1, OUT_MOUSE = 2, OUT_MOUSE_AXIS = 3, OUT_GAMEPAD = 4 };
+
+// ────────────────────────────────
+// Workload: random presses on mapped pins, edge → USB latency at the host
+// ────────────────────────────────
+class Workload : public SimHidSink {
+public:
+  Workload(Medium &m, const SimOptions &o) : medium(m), opt(o), rng(o.seed ? o.seed : 1) {}
+
+  void begin(uint64_t t0) {
+    for (size_t i = 1; i < medium.nodes.size(); i++) {
+      TxState s;
+      s.node = (uint8_t)i;
+      s.nextPress = t0 + nextGap();
+      tx.push_back(s);
+    }
+  }
+
+  // Earliest time anything in the workload changes
+  uint64_t nextEvent() const {
+    uint64_t t = UINT64_MAX;
+    for (const TxState &s : tx) {
+      t = std::min(t, s.nextPress);
+      for (const Step &st : s.steps) t = std::min(t, st.t);
+    }
+    return t;
+  }
+
+  void fire(uint64_t now) {
+    for (TxState &s : tx) {
+      runDue(s, now);
+      if (s.steps.empty() && now >= s.nextPress) {
+        // Distinct pins from 0..7 (they carry bindings in every layout), rolled on and off
+        uint8_t chosen = 0;
+        for (int k = 0; k < opt.chord; k++) {
+          uint8_t pin;
+          do pin = next() % 8; while ((chosen >> pin) & 1);
+          chosen |= 1 << pin;
+          uint64_t at = now + k * (uint64_t)opt.rollUs;
+          s.steps.push_back({ at, pin, true });
+          s.steps.push_back({ at + opt.holdMs * 1000ull, pin, false });
+        }
+        s.nextPress = now + nextGap();
+        runDue(s, now);  // the first pin goes down now
+      }
+    }
+    expire(now);
+  }
+
+  // Lift every held pin and stop pressing; the run then settles
+  void finish(uint64_t now) {
+    for (TxState &s : tx) {
+      s.steps.clear();
+      for (uint8_t pin = 0; pin < 16; pin++) {
+        if (!((s.pins >> pin) & 1)) edge(s, pin, false, now);
+      }
+      s.nextPress = UINT64_MAX;
+    }
+  }
+
+  // Outputs the host still sees pressed (only meaningful after finish + settle)
+  uint32_t stuckOutputs() const {
+    uint32_t n = __builtin_popcount(mouseButtons) + __builtin_popcount(gamepadButtons);
+    for (uint8_t k : keys) n += k != 0;
+    return n;
+  }
+
+  void onHidReport(uint64_t t_us, uint8_t node, uint8_t reportId, const uint8_t *data, uint8_t len) override {
+    (void)node;
+    if (reportId == 1 && len >= 8) {
+      memcpy(keys, data + 2, 6);
+    } else if (reportId == 2 && len >= 1) {
+      mouseButtons = data[0];
+    } else if (reportId == 3 && len >= 11) {
+      memcpy(&gamepadButtons, data + 7, 4);
+    }
+
+    for (size_t i = 0; i < pending.size();) {
+      if (visible(pending[i].type, pending[i].code) == pending[i].pressed) {
+        uint32_t lat = (uint32_t)(t_us - pending[i].t);
+        latency.push_back(lat);
+        if (!pending[i].pressed) {
+          releaseWorst = std::max(releaseWorst, lat);
+          if (lat > EXPIRE_US) slowReleases++;
+        }
+        pending.erase(pending.begin() + i);
+      } else {
+        i++;
+      }
+    }
+  }
+
+  void summarize(uint64_t now, SimResult &r) {
+    // Releases that never showed up count as stuck for as long as the run lasted,
+    // unless their press never showed up either: then the whole tap was superseded
+    uint32_t neverReleased = 0;
+    for (size_t i = 0; i < pending.size(); i++) {
+      const Expect &e = pending[i];
+      if (e.pressed) continue;
+      auto tap = [&](const Expect &p) { return p.pressed && p.type == e.type && p.code == e.code; };
+      if (std::any_of(pending.begin(), pending.begin() + i, tap)) {
+        missedPresses++;
+        continue;
+      }
+      neverReleased++;
+      releaseWorst = std::max(releaseWorst, (uint32_t)(now - e.t));
+    }
+    r.edges = edges;
+    r.observed = (uint32_t)latency.size();
+    r.missedPresses = missedPresses;
+    r.heldAtEnd = stuckOutputs();
+    r.releaseWorst_us = releaseWorst;
+    r.slowReleases = slowReleases;
+    r.neverReleased = neverReleased;
+    printf("input: %u edges, %u observed at USB, %u presses missed, %u outputs held at end\n",
+           r.edges, r.observed, r.missedPresses, r.heldAtEnd);
+    printf("stuck input: worst release -> USB %.1f ms, %u releases > 1 s, %u never seen\n",
+           releaseWorst / 1000.0, slowReleases, neverReleased);
+    if (latency.empty()) return;
+    std::sort(latency.begin(), latency.end());
+    auto pct = [&](double p) { return latency[std::min(latency.size() - 1, (size_t)(p / 100.0 * latency.size()))]; };
+    r.p50_us = pct(50);
+    r.p99_us = pct(99);
+    r.max_us = latency.back();
+    printf("edge -> USB latency: p50 %.2f ms  p99 %.2f ms  max %.2f ms\n",
+           r.p50_us / 1000.0, r.p99_us / 1000.0, r.max_us / 1000.0);
+  }
+
+private:
+  struct Step {
+    uint64_t t;
+    uint8_t pin;
+    bool pressed;
+  };
+
+  struct TxState {
+    uint8_t node;
+    uint64_t nextPress = 0;
+    std::vector<Step> steps;  // scheduled edges of the current chord
+    uint16_t pins = 0xFFFF;   // logical levels; PRESSED_LEVEL is 0
+  };
+
+  struct Expect {
+    uint64_t t;
+    uint8_t type, code;
+    bool pressed;
+  };
+
+  static const uint64_t EXPIRE_US = 1000000;
+
+  uint32_t next() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+  }
+
+  void runDue(TxState &s, uint64_t now) {
+    for (size_t i = 0; i < s.steps.size();) {
+      if (now < s.steps[i].t) {
+        i++;
+        continue;
+      }
+      edge(s, s.steps[i].pin, s.steps[i].pressed, now);
+      s.steps.erase(s.steps.begin() + i);
+    }
+  }
+
+  uint64_t nextGap() {
+    double mean = 1e6 / opt.pressHz;
+    return (uint64_t)(mean * (0.5 + (next() % 1000) / 1000.0));
+  }
+
+  bool visible(uint8_t type, uint8_t code) const {
+    switch (type) {
+      case OUT_KEYBOARD: return std::find(keys, keys + 6, code) != keys + 6;
+      case OUT_MOUSE: return code < 8 && (mouseButtons >> code) & 1;
+      case OUT_GAMEPAD: return code < 32 && (gamepadButtons >> code) & 1;
+      default: return false;
+    }
+  }
+
+  void edge(TxState &s, uint8_t pin, bool pressed, uint64_t now) {
+    if (pressed) s.pins &= ~(1u << pin);
+    else s.pins |= 1u << pin;
+    SimNodeHandle &h = medium.nodes[s.node];
+    h.setPins(s.pins);
+    edges++;
+
+    uint8_t type = OUT_NONE, code = 0;
+    h.binding(h.cfg.nodeAddr, pin, &type, &code);
+    if (type == OUT_NONE || type == OUT_MOUSE_AXIS) return;
+
+    // Only the first press and the last release of a shared output change the report
+    uint8_t &held = holders[type][code];
+    bool changes = pressed ? held++ == 0 : held > 0 && --held == 0;
+    if (changes) pending.push_back({ now, type, code, pressed });
+  }
+
+  // A press can legitimately vanish (the whole tap was superseded); a release never may
+  void expire(uint64_t now) {
+    for (size_t i = 0; i < pending.size();) {
+      if (pending[i].pressed && now - pending[i].t > EXPIRE_US) {
+        missedPresses++;
+        pending.erase(pending.begin() + i);
+      } else {
+        i++;
+      }
+    }
+  }
+
+  Medium &medium;
+  const SimOptions &opt;
+  uint32_t rng;
+  std::vector<TxState> tx;
+  std::vector<Expect> pending;
+  std::vector<uint32_t> latency;
+  uint32_t edges = 0;
+  uint32_t missedPresses = 0;  // a whole tap superseded before it reached the RX
+  uint32_t slowReleases = 0;   // output still held a second after the pin was released
+  uint32_t releaseWorst = 0;   // µs, the worst-case stuck-input time
+
+  uint8_t holders[OUT_GAMEPAD + 1][256] = {};  // TX pins currently driving each output
+
+  uint8_t keys[6] = {};
+  uint8_t mouseButtons = 0;
+  uint32_t gamepadButtons = 0;
+};
+
+// After the last release (and any outage): long enough for every retry/backoff to run out
+static const uint64_t SETTLE_US = 5000000;
+
+bool runSim(const SimOptions &opt, SimResult &res) {
+  res = SimResult();
+  std::string firmware = opt.firmware.empty() ? defaultFirmwarePath() : opt.firmware;
+
+  Medium medium;
+  medium.tick_us = opt.tickUs;
+  medium.echoLogs = opt.log;
+  medium.lossPct = opt.lossPct;
+  medium.pathLossStepDb = opt.pathStepDb;
+  medium.lossSeed = opt.seed * 2654435761u | 1;
+  medium.nodes.resize(opt.txCount + 1);
+  medium.jamSeed = opt.seed * 40503u | 1;
+  for (float mhz : opt.jamMhz)  // same FRF rounding as RH_RF69::setFrequency()
+    medium.jammers.push_back({ (uint32_t)((mhz * 1000000.0) / FRF_STEP_HZ), opt.jamDutyPct, -50, 0 });
+
+  for (int i = 0; i <= opt.txCount; i++) {
+    SimNodeHandle &h = medium.nodes[i];
+    h.cfg.index = (uint8_t)i;
+    h.cfg.tx = i > 0;
+    h.cfg.nodeAddr = (uint8_t)i;  // TX nodes pre-assigned 1..N
+    h.cfg.debugLevel = opt.debugLevel;
+    h.cfg.noSleep = !opt.sleep;
+    h.cfg.wakeUs = (uint16_t)std::min<uint32_t>(opt.wakeUs, 0xFFFF);
+    h.label = i == 0 ? "RX" : "TX" + std::to_string(i);
+    if (!loadNode(firmware, h)) return false;
+    h.attach(&medium, &h.cfg);
+  }
+
+  for (SimNodeHandle &h : medium.nodes) h.setup();
+
+  Workload work(medium, opt);
+  medium.hidSink = &work;
+  uint64_t t0 = medium.nowUs();
+  uint64_t end = t0 + (uint64_t)(opt.seconds * 1e6);
+  work.begin(t0);
+
+  while (medium.nowUs() < end) {
+    work.fire(medium.nowUs());
+    medium.run(std::min(end, std::max(work.nextEvent(), medium.nowUs() + opt.tickUs)));
+  }
+
+  // An outage straddling the final releases: only retries or later refreshes can recover them
+  if (opt.outageMs) {
+    medium.blackoutFrom = medium.nowUs() - 100000;
+    medium.blackoutUntil = medium.blackoutFrom + opt.outageMs * 1000ull;
+  }
+  work.finish(medium.nowUs());
+  medium.run(medium.nowUs() + opt.outageMs * 1000ull + SETTLE_US);
+
+  const Medium::Stats &st = medium.stats();
+  res.air = st;
+  for (size_t i = 1; i <= (size_t)opt.txCount; i++)
+    res.txPowerDbm.push_back(i < medium.lastPowerDbm.size() ? medium.lastPowerDbm[i] : 0);
+  printf("rfsim: %d TX + 1 RX, %.1f s simulated, tick %u us, seed %u\n",
+         opt.txCount, opt.seconds, opt.tickUs, opt.seed);
+  printf("air: %u frames, %u delivered, %u collided, %u below sensitivity, %u dropped (%.1f%% loss), %.2f%% channel use\n",
+         st.sent, st.delivered, st.collided, st.weak, st.dropped, opt.lossPct,
+         st.airtime_us * 100.0 / (medium.nowUs() - t0));
+  printf("rx: %u TX frames missed (%u below sensitivity)\n", st.rxMissed, st.rxWeak);
+  if (st.txFrames)
+    printf("tx power: %.1f dBm average over %u TX frames, %.2f mJ radiated\n", st.txPowerDbm / st.txFrames,
+           st.txFrames, st.txEnergyMj);
+  for (float mhz : opt.jamMhz) printf("jam: %.1f MHz, %.0f%% duty\n", mhz, opt.jamDutyPct);
+  printf("usb: %u HID reports\n", st.hidReports);
+  // nodes[0] is the RX
+  double txAwake = 0, txMin = 100, txMax = 0, rxAwake = 0;
+  for (size_t i = 0; i < medium.nodes.size(); i++) {
+    uint64_t awake = 0, steps = 0;
+    if (medium.nodes[i].cpu) medium.nodes[i].cpu(&awake, &steps);
+    double pct = steps ? awake * 100.0 / steps : 100.0;
+    if (i == 0) {
+      rxAwake = pct;
+      continue;
+    }
+    txAwake += pct;
+    txMin = std::min(txMin, pct);
+    txMax = std::max(txMax, pct);
+  }
+  if (opt.txCount) res.txAwakePct = txAwake / opt.txCount;
+  if (opt.txCount)
+    printf("cpu: TX awake %.1f%% of loop ticks (%.1f-%.1f%%), RX %.1f%%\n", txAwake / opt.txCount, txMin, txMax,
+           rxAwake);
+  work.summarize(medium.nowUs(), res);
+
+  for (size_t i = 0; i < medium.nodes.size(); i++) {
+    uint32_t (*trace)(uint8_t, uint8_t, uint32_t *, uint32_t *);
+    if (!findExport(medium.nodes[i], "sim_trace", trace)) break;
+    uint32_t max_us, n;
+    if (i == 0) {
+      res.e2eP99_us = trace(LS_END_TO_END, 99, &max_us, &n);
+      res.e2eMax_us = max_us;
+      trace(LS_RX_TO_HID, 99, &res.rxHidMax_us, &n);
+      uint32_t (*dispatch)(uint8_t, uint32_t *, uint32_t *);
+      if (findExport(medium.nodes[i], "sim_rx_dispatch", dispatch))
+        res.rxDispatchP99_us = dispatch(99, &res.rxDispatchMax_us, &res.rxDispatchCount);
+    } else {
+      trace(LS_TX_EDGE_TO_AIR, 99, &max_us, &n);
+      res.edgeAirMax_us = std::max(res.edgeAirMax_us, max_us);
+      res.pcfIrqP99_us = std::max(res.pcfIrqP99_us, trace(LS_PCF_IRQ, 99, &max_us, &n));
+      res.pcfIrqMax_us = std::max(res.pcfIrqMax_us, max_us);
+    }
+  }
+  uint64_t heapBytes = 0;
+  for (SimNodeHandle &h : medium.nodes) {
+    uint32_t (*heap)(uint64_t *);
+    uint64_t bytes = 0;
+    if (!findExport(h, "sim_heap", heap)) break;
+    res.heapAllocs += heap(&bytes);
+    heapBytes += bytes;
+  }
+  if (res.heapAllocs) printf("heap: %u allocations (%llu bytes) after setup()\n", res.heapAllocs,
+                             (unsigned long long)heapBytes);
+
+  // Firmware-side view (Trace histograms) from the RX and the first TX
+  medium.echoLogs = true;
+  medium.nodes[0].report();
+  medium.nodes[1].report();
+
+  for (SimNodeHandle &h : medium.nodes) unloadNode(h);
+  return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Medium.h"
+
+// ────────────────────────────────
+// One rfsim run: N TX + 1 RX of the firmware under a random press workload
+// ────────────────────────────────
+struct SimOptions {
+  int txCount = 4;
+  double seconds = 10.0;
+  double pressHz = 2.0;   // presses per second per TX
+  uint32_t holdMs = 80;   // below the 400 ms first-repeat delay
+  int chord = 1;          // pins per press (a roll when rollUs > 0)
+  uint32_t rollUs = 0;    // spacing between the pins of one chord
+  uint32_t seed = 1;
+  uint32_t tickUs = 50;
+  float lossPct = 0.0f;
+  uint32_t outageMs = 0;
+  std::vector<float> jamMhz;  // interferer channels
+  float jamDutyPct = 50.0f;
+  float pathStepDb = 2.0f;    // extra path loss per node index away from the RX
+  bool sleep = true;      // false: every node spins instead of WFE
+  uint32_t wakeUs = 0;    // WFE exit latency after an interrupt
+  uint8_t debugLevel = 0;
+  bool log = false;
+  std::string firmware;
+};
+
+// What the USB host saw; edge → USB latency over every output change observed
+struct SimResult {
+  uint32_t edges = 0;
+  uint32_t observed = 0;         // output changes that reached USB
+  uint32_t missedPresses = 0;    // whole taps superseded before they reached the RX
+  uint32_t heldAtEnd = 0;        // outputs still pressed after the settle time
+  uint32_t neverReleased = 0;    // releases that never reached USB
+  uint32_t slowReleases = 0;     // releases more than 1 s late
+  uint32_t releaseWorst_us = 0;  // worst-case stuck-input time
+  uint32_t p50_us = 0, p99_us = 0, max_us = 0;
+  Medium::Stats air;
+  // Firmware Trace histograms (sim_trace): worst PCF edge → on air over all
+  // TX nodes, and the RX's end-to-end stage
+  uint32_t edgeAirMax_us = 0;
+  uint32_t e2eP99_us = 0, e2eMax_us = 0;
+  uint32_t rxHidMax_us = 0;
+  std::vector<int8_t> txPowerDbm;  // each TX's power on its last frame, TX1 first
+  // RX PayloadReady IRQ → dispatch (sim_rx_dispatch)
+  uint32_t rxDispatchCount = 0, rxDispatchP99_us = 0, rxDispatchMax_us = 0;
+  uint32_t heapAllocs = 0;
+  // TX /INT ISR → PCFInput::service over every TX (LS_PCF_IRQ), and the share
+  // of ticks the TXs ran loop()
+  uint32_t pcfIrqP99_us = 0, pcfIrqMax_us = 0;
+  double txAwakePct = 0;  // allocations after setup() over all nodes (sim_heap)
+
+  // No stuck input: every release arrived and nothing is held at the end
+  bool clean() const { return heldAtEnd == 0 && neverReleased == 0; }
+};
+
+// Loads opt.firmware (default: libfirmware.so next to the program) once per
+// node, runs the workload, settles and prints the summary; false if a node
+// could not be loaded
+bool runSim(const SimOptions &opt, SimResult &res);
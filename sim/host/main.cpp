@@ -0,0 +1,68 @@
+// ────────────────────────────────
+// rfsim command line (sim/host/Rfsim.cpp runs the simulation)
+// ────────────────────────────────
+// Exits 1 when input stays stuck (an output held after the run settled, or
+// a release that never reached USB), so scripts can gate on the result.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "Rfsim.h"
+
+#ifndef PIO_UNIT_TESTING  // pio test links sim/host/ into each test program
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--tx N] [--seconds S] [--rate HZ] [--hold MS] [--seed N]\n"
+          "          [--chord N] [--roll US] [--tick US] [--loss PCT] [--outage MS]\n"
+          "          [--jam MHZ]... [--jam-duty PCT] [--path-step DB] [--no-sleep] [--wake US]\n"
+          "          [--debug MASK] [--log]\n"
+          "          [--firmware PATH]\n",
+          argv0);
+}
+
+static bool parse(int argc, char **argv, SimOptions &o) {
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (a == "--log") o.log = true;
+    else if (a == "--no-sleep") o.sleep = false;
+    else if (a == "--wake" && hasValue) o.wakeUs = (uint32_t)atoi(argv[++i]);
+    else if (a == "--tx" && hasValue) o.txCount = atoi(argv[++i]);
+    else if (a == "--seconds" && hasValue) o.seconds = atof(argv[++i]);
+    else if (a == "--rate" && hasValue) o.pressHz = atof(argv[++i]);
+    else if (a == "--hold" && hasValue) o.holdMs = (uint32_t)atoi(argv[++i]);
+    else if (a == "--chord" && hasValue) o.chord = atoi(argv[++i]);
+    else if (a == "--roll" && hasValue) o.rollUs = (uint32_t)atoi(argv[++i]);
+    else if (a == "--seed" && hasValue) o.seed = (uint32_t)strtoul(argv[++i], nullptr, 0);
+    else if (a == "--tick" && hasValue) o.tickUs = (uint32_t)atoi(argv[++i]);
+    else if (a == "--loss" && hasValue) o.lossPct = (float)atof(argv[++i]);
+    else if (a == "--outage" && hasValue) o.outageMs = (uint32_t)atoi(argv[++i]);
+    else if (a == "--jam" && hasValue) o.jamMhz.push_back((float)atof(argv[++i]));
+    else if (a == "--jam-duty" && hasValue) o.jamDutyPct = (float)atof(argv[++i]);
+    else if (a == "--path-step" && hasValue) o.pathStepDb = (float)atof(argv[++i]);
+    else if (a == "--debug" && hasValue) o.debugLevel = (uint8_t)strtoul(argv[++i], nullptr, 0);
+    else if (a == "--firmware" && hasValue) o.firmware = argv[++i];
+    else return false;
+  }
+  return o.txCount >= 1 && o.txCount <= 32 && o.seconds > 0 && o.pressHz > 0 && o.tickUs > 0 &&
+         o.chord >= 1 && o.chord <= 8 &&
+         o.lossPct >= 0 && o.lossPct < 100 && o.jamDutyPct >= 0 && o.jamDutyPct <= 100 &&
+         o.pathStepDb >= 0;
+}
+
+
+int main(int argc, char **argv) {
+  SimOptions opt;
+  if (!parse(argc, argv, opt)) {
+    usage(argv[0]);
+    return 2;
+  }
+  SimResult res;
+  if (!runSim(opt, res)) return 1;
+  if (!res.clean()) {
+    fprintf(stderr, "rfsim: FAIL: %u outputs held at end, %u releases never seen\n", res.heldAtEnd,
+            res.neverReleased);
+    return 1;
+  }
+  return 0;
+}
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+#include <Arduino.h>
+
+// Text calls are accepted and dropped; nothing is rasterised
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+  void setTextSize(uint8_t) {}
+  void setTextColor(uint16_t) {}
+  void setTextColor(uint16_t, uint16_t) {}
+  void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+  void drawPixel(int16_t, int16_t, uint16_t) {}
+  void drawLine(int16_t, int16_t, int16_t, int16_t, uint16_t) {}
+  void drawRect(int16_t, int16_t, int16_t, int16_t, uint16_t) {}
+  void fillRect(int16_t, int16_t, int16_t, int16_t, uint16_t) {}
+  size_t write(uint8_t) override { return 1; }
+  using Print::write;
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+protected:
+  int16_t _width, _height;
+  int16_t cursor_x = 0, cursor_y = 0;
+};
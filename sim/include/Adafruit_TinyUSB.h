@@ -0,0 +1,86 @@
+#pragma once
+#include <Arduino.h>
+
+// ────────────────────────────────
+// TinyUSB HID device stand-in
+// ────────────────────────────────
+// One interrupt IN endpoint: a report handed over while idle is taken by the
+// host at its next poll slot (multiples of the poll interval), then
+// tud_hid_report_complete_cb() runs and ready() turns true again.
+
+#define HID_REPORT_ID(x) x
+#define TUD_HID_REPORT_DESC_KEYBOARD(...) 0x05, 0x01, 0x09, 0x06
+#define TUD_HID_REPORT_DESC_MOUSE(...) 0x05, 0x01, 0x09, 0x02
+#define TUD_HID_REPORT_DESC_GAMEPAD(...) 0x05, 0x01, 0x09, 0x05
+
+#define KEYBOARD_MODIFIER_LEFTCTRL 0x01
+#define KEYBOARD_MODIFIER_LEFTSHIFT 0x02
+#define KEYBOARD_MODIFIER_LEFTALT 0x04
+#define KEYBOARD_MODIFIER_LEFTGUI 0x08
+#define KEYBOARD_MODIFIER_RIGHTCTRL 0x10
+#define KEYBOARD_MODIFIER_RIGHTSHIFT 0x20
+#define KEYBOARD_MODIFIER_RIGHTALT 0x40
+#define KEYBOARD_MODIFIER_RIGHTGUI 0x80
+
+#define MOUSE_BUTTON_LEFT 0x01
+#define MOUSE_BUTTON_RIGHT 0x02
+#define MOUSE_BUTTON_MIDDLE 0x04
+#define MOUSE_BUTTON_BACKWARD 0x08
+#define MOUSE_BUTTON_FORWARD 0x10
+
+enum {
+  HID_KEY_NONE = 0x00,
+  HID_KEY_A = 0x04, HID_KEY_B, HID_KEY_C, HID_KEY_D, HID_KEY_E, HID_KEY_F, HID_KEY_G,
+  HID_KEY_H, HID_KEY_I, HID_KEY_J, HID_KEY_K, HID_KEY_L, HID_KEY_M, HID_KEY_N,
+  HID_KEY_O, HID_KEY_P, HID_KEY_Q, HID_KEY_R, HID_KEY_S, HID_KEY_T, HID_KEY_U,
+  HID_KEY_V, HID_KEY_W, HID_KEY_X, HID_KEY_Y, HID_KEY_Z,
+  HID_KEY_1, HID_KEY_2, HID_KEY_3, HID_KEY_4, HID_KEY_5,
+  HID_KEY_6, HID_KEY_7, HID_KEY_8, HID_KEY_9, HID_KEY_0,
+  HID_KEY_ENTER, HID_KEY_ESCAPE, HID_KEY_BACKSPACE, HID_KEY_TAB, HID_KEY_SPACE,
+  HID_KEY_ARROW_RIGHT = 0x4F, HID_KEY_ARROW_LEFT, HID_KEY_ARROW_DOWN, HID_KEY_ARROW_UP
+};
+
+typedef struct __attribute__((packed)) {
+  int8_t x, y, z, rz, rx, ry;
+  uint8_t hat;
+  uint32_t buttons;
+} hid_gamepad_report_t;
+
+class Adafruit_USBD_Device {
+public:
+  bool begin(uint8_t rhport = 0) { (void)rhport; return true; }
+  bool isInitialized() { return true; }
+  bool mounted() { return true; }
+  bool suspended() { return false; }
+  bool detach() { return true; }
+  bool attach() { return true; }
+  bool remoteWakeup() { return true; }
+};
+extern Adafruit_USBD_Device TinyUSBDevice;
+
+class Adafruit_USBD_HID {
+public:
+  Adafruit_USBD_HID();
+
+  void setReportDescriptor(const uint8_t *desc, uint16_t len) { (void)desc; (void)len; }
+  void setPollInterval(uint8_t ms) { pollMs = ms ? ms : 1; }
+  bool begin() { return true; }
+
+  bool ready() { return !busy; }
+  bool sendReport(uint8_t reportId, void const *report, uint8_t len);
+  bool keyboardReport(uint8_t reportId, uint8_t modifier, uint8_t keycode[6]);
+  bool mouseReport(uint8_t reportId, uint8_t buttons, int8_t x, int8_t y, int8_t vertical, int8_t horizontal);
+
+  // Called by the node runtime every step: completes the transfer at the poll slot
+  void simService();
+
+private:
+  uint8_t pollMs = 10;
+  bool busy = false;
+  uint64_t dueAt_us = 0;
+  uint8_t id = 0;
+  uint8_t buf[16];
+  uint8_t len = 0;
+};
+
+extern "C" void tud_hid_report_complete_cb(uint8_t instance, uint8_t const *report, uint16_t len) __attribute__((weak));
@@ -0,0 +1,230 @@
+#pragma once
+// Host stand-in for the earlephilhower Arduino core: just enough of the API
+// for the firmware in src/ to compile and run unmodified.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define PROGMEM
+#define PSTR(s) (s)
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strncmp_P strncmp
+#define strcmp_P strcmp
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+
+#define HEX 16
+#define DEC 10
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define LOW 0
+#define HIGH 1
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define SS 17
+#define digitalPinToInterrupt(p) (p)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+
+// ────────────────────────────────
+// String (std::string backed)
+// ────────────────────────────────
+// Its buffer comes from this node's malloc(), so sim/arduino/SimHeap.cpp sees
+// it like any other firmware allocation (libstdc++'s own std::string code
+// would allocate behind the hook's back).
+template <typename T>
+struct SimHeapAllocator {
+  typedef T value_type;
+  SimHeapAllocator() = default;
+  template <typename U>
+  SimHeapAllocator(const SimHeapAllocator<U> &) {}
+  T *allocate(size_t n) { return static_cast<T *>(malloc(n * sizeof(T))); }
+  void deallocate(T *p, size_t) { free(p); }
+  template <typename U>
+  bool operator==(const SimHeapAllocator<U> &) const { return true; }
+  template <typename U>
+  bool operator!=(const SimHeapAllocator<U> &) const { return false; }
+};
+
+class String {
+public:
+  String() {}
+  String(const char *c) : s(c ? c : "") {}
+  String(const std::string &x) : s(x.data(), x.size()) {}
+  String(const __FlashStringHelper *c) : s(reinterpret_cast<const char *>(c)) {}
+  explicit String(char c) : s(1, c) {}
+  String(int v, unsigned char base = DEC) : s(fmt(base == HEX ? "%X" : "%d", v)) {}
+  String(unsigned v, unsigned char base = DEC) : s(fmt(base == HEX ? "%X" : "%u", v)) {}
+  String(long v, unsigned char base = DEC) : s(fmt(base == HEX ? "%lX" : "%ld", v)) {}
+  String(unsigned long v, unsigned char base = DEC) : s(fmt(base == HEX ? "%lX" : "%lu", v)) {}
+  String(unsigned char v, unsigned char base = DEC) : String((unsigned)v, base) {}
+  String(float v, unsigned char digits = 2) { char b[32]; snprintf(b, sizeof b, "%.*f", digits, v); s = b; }
+  String(double v, unsigned char digits = 2) { char b[32]; snprintf(b, sizeof b, "%.*f", digits, v); s = b; }
+
+  const char *c_str() const { return s.c_str(); }
+  unsigned length() const { return s.size(); }
+  bool isEmpty() const { return s.empty(); }
+  void reserve(unsigned n) { s.reserve(n); }
+  char operator[](unsigned i) const { return i < s.size() ? s[i] : 0; }
+  char charAt(unsigned i) const { return (*this)[i]; }
+
+  String &operator+=(const String &o) { s += o.s; return *this; }
+  String &operator+=(const char *o) { s += o; return *this; }
+  String &operator+=(char c) { s += c; return *this; }
+  friend String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+  friend String operator+(const String &a, const char *b) { return String(a.s + b); }
+  friend String operator+(const char *a, const String &b) { return String(Str(a) + b.s); }
+  bool operator==(const String &o) const { return s == o.s; }
+  bool operator==(const char *o) const { return s == o; }
+  bool operator!=(const String &o) const { return s != o.s; }
+  bool equals(const String &o) const { return s == o.s; }
+
+  bool concat(const char *b, size_t n) { s.append(b, n); return true; }
+  bool concat(const char *b) { s += b; return true; }
+  bool concat(char c) { s.push_back(c); return true; }
+
+  int indexOf(char c, unsigned from = 0) const { size_t i = s.find(c, from); return i == std::string::npos ? -1 : (int)i; }
+  String substring(unsigned from, unsigned to = ~0u) const {
+    if (from > s.size()) return String();
+    return String(s.substr(from, to == ~0u ? std::string::npos : to - from));
+  }
+  bool startsWith(const String &p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+  void trim() {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    size_t b = s.find_last_not_of(" \t\r\n");
+    s = a == std::string::npos ? Str() : s.substr(a, b - a + 1);
+  }
+  void toLowerCase() { for (char &c : s) c = (char)tolower((unsigned char)c); }
+  long toInt() const { return strtol(s.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(s.c_str(), nullptr); }
+
+private:
+  typedef std::basic_string<char, std::char_traits<char>, SimHeapAllocator<char>> Str;
+  String(const Str &x) : s(x) {}
+  static Str fmt(const char *f, long v) { char b[24]; snprintf(b, sizeof b, f, v); return b; }
+  static Str fmt(const char *f, unsigned long v) { char b[24]; snprintf(b, sizeof b, f, v); return b; }
+  static Str fmt(const char *f, int v) { char b[24]; snprintf(b, sizeof b, f, v); return b; }
+  static Str fmt(const char *f, unsigned v) { char b[24]; snprintf(b, sizeof b, f, v); return b; }
+  Str s;
+};
+
+// ────────────────────────────────
+// Print / Stream
+// ────────────────────────────────
+class Print;
+class Printable {
+public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++) write(b[i]);
+    return n;
+  }
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t write(const char *b, size_t n) { return write((const uint8_t *)b, n); }
+  virtual void flush() {}
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const __FlashStringHelper *s) { return print(reinterpret_cast<const char *>(s)); }
+  size_t print(const String &s) { return print(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(long v, int base = DEC) { char b[24]; snprintf(b, sizeof b, base == HEX ? "%lX" : "%ld", v); return print(b); }
+  size_t print(unsigned long v, int base = DEC) { char b[24]; snprintf(b, sizeof b, base == HEX ? "%lX" : "%lu", v); return print(b); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(signed char v, int base = DEC) { return print((long)v, base); }
+  size_t print(short v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned short v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(double v, int digits = 2) { char b[32]; snprintf(b, sizeof b, "%.*f", digits, v); return print(b); }
+  size_t print(const Printable &p) { return p.printTo(*this); }
+
+  template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+  template <typename T> size_t println(T v, int b) { size_t n = print(v, b); return n + println(); }
+  size_t println() { return print("\n"); }
+
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char b[256];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(b, sizeof b, fmt, ap);
+    va_end(ap);
+    return print(b);
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  virtual int peek() { return -1; }
+  virtual size_t readBytes(char *b, size_t n) {
+    size_t k = 0;
+    while (k < n) {
+      int c = read();
+      if (c < 0) break;
+      b[k++] = (char)c;
+    }
+    return k;
+  }
+  size_t readBytes(uint8_t *b, size_t n) { return readBytes((char *)b, n); }
+  void setTimeout(unsigned long) {}
+};
+
+// Serial lines are forwarded to the host, tagged with the node and virtual time
+class SimSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override;
+  using Print::write;
+  operator bool() const { return true; }
+
+private:
+  char line[256];
+  size_t len = 0;
+};
+extern SimSerial Serial;
+
+// ────────────────────────────────
+// Core API (sim/arduino/Arduino.cpp)
+// ────────────────────────────────
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(int pin, int mode);
+int digitalRead(int pin);
+void digitalWrite(int pin, int val);
+int analogRead(int pin);
+void attachInterrupt(int irq, void (*fn)(), int mode);
+void detachInterrupt(int irq);
+void noInterrupts();
+void interrupts();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long s);
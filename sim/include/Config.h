@@ -0,0 +1,4 @@
+#pragma once
+// The firmware includes "Config.h" while the file is src/config.h; on a
+// case-sensitive host filesystem this forwards to it.
+#include "config.h"
@@ -0,0 +1,79 @@
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ────────────────────────────────
+// In-memory LittleFS, private to each node
+// ────────────────────────────────
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File : public Stream {
+public:
+  File() {}
+  File(std::shared_ptr<std::vector<uint8_t>> d, bool canWrite, bool append)
+    : data(d), writable(canWrite) { if (append) pos = d->size(); }
+
+  operator bool() const { return (bool)data; }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *b, size_t n) override {
+    if (!data || !writable) return 0;
+    if (pos + n > data->size()) data->resize(pos + n);
+    memcpy(data->data() + pos, b, n);
+    pos += n;
+    return n;
+  }
+  using Print::write;
+
+  int available() override { return data ? (int)(data->size() - pos) : 0; }
+  int read() override { return (data && pos < data->size()) ? (*data)[pos++] : -1; }
+  int peek() override { return (data && pos < data->size()) ? (*data)[pos] : -1; }
+  size_t read(uint8_t *b, size_t n) {
+    size_t k = 0;
+    while (data && k < n && pos < data->size()) b[k++] = (*data)[pos++];
+    return k;
+  }
+  size_t readBytes(char *b, size_t n) override { return read((uint8_t *)b, n); }
+  using Stream::readBytes;
+
+  bool seek(uint32_t p, SeekMode mode = SeekSet) {
+    if (!data) return false;
+    size_t base = mode == SeekSet ? 0 : mode == SeekCur ? pos : data->size();
+    pos = base + p;
+    return pos <= data->size();
+  }
+  size_t position() const { return pos; }
+  size_t size() const { return data ? data->size() : 0; }
+  void flush() override {}
+  void close() { data.reset(); }
+
+private:
+  std::shared_ptr<std::vector<uint8_t>> data;
+  size_t pos = 0;
+  bool writable = false;
+};
+
+class FS {
+public:
+  bool begin() { return true; }
+  void end() {}
+  bool format() { files.clear(); return true; }
+  bool exists(const char *path) { return files.count(path) != 0; }
+  bool exists(const String &path) { return exists(path.c_str()); }
+  bool mkdir(const char *) { return true; }
+  bool mkdir(const String &) { return true; }
+  bool remove(const char *path) { return files.erase(path) != 0; }
+  bool remove(const String &path) { return remove(path.c_str()); }
+  bool rename(const char *from, const char *to);
+
+  // "r", "r+", "w", "w+", "a", "a+" as on the target
+  File open(const char *path, const char *mode);
+  File open(const String &path, const char *mode) { return open(path.c_str(), mode); }
+
+private:
+  std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+};
+extern FS LittleFS;
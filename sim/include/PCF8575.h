@@ -0,0 +1,17 @@
+#pragma once
+#include <Wire.h>
+
+// Expander inputs come from sim_set_pins(); /INT is driven on every change
+class PCF8575 {
+public:
+  explicit PCF8575(const uint8_t deviceAddress = 0x20, TwoWire *wire = &Wire)
+    : addr(deviceAddress) { (void)wire; }
+  bool begin(uint16_t value = 0xFFFF) { out = value; return true; }
+  bool isConnected() { return true; }
+  uint16_t read16();
+  void write16(const uint16_t value) { out = value; }
+
+private:
+  uint8_t addr;
+  uint16_t out = 0xFFFF;
+};
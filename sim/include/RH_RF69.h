@@ -0,0 +1,248 @@
+#pragma once
+#include <Arduino.h>
+
+// ────────────────────────────────
+// RadioHead RH_RF69 stand-in backed by the simulated medium
+// ────────────────────────────────
+// Same public/protected surface as lib/RadioHead (what the firmware and
+// RadioDriver touch). Frames go on air in setModeTx() with the airtime the
+// real packet format would take; PacketSent and PayloadReady are raised on
+// DIO0 exactly like the module does. Registers live in a plain register
+// file, so direct spiRead/spiWrite access (FRF, RSSI, IRQ flags) also works.
+
+#define RH_BROADCAST_ADDRESS 0xff
+#define RH_FLAGS_APPLICATION_SPECIFIC 0x0f
+
+#define RH_RF69_FXOSC 32000000.0
+#define RH_RF69_FSTEP (RH_RF69_FXOSC / 524288)
+#define RH_RF69_FIFO_SIZE 66
+#define RH_RF69_MAX_ENCRYPTABLE_PAYLOAD_LEN 64
+#define RH_RF69_HEADER_LEN 4
+#ifndef RH_RF69_MAX_MESSAGE_LEN
+#define RH_RF69_MAX_MESSAGE_LEN (RH_RF69_MAX_ENCRYPTABLE_PAYLOAD_LEN - RH_RF69_HEADER_LEN)
+#endif
+#ifdef RFM69_HW
+#define RH_RF69_DEFAULT_HIGHPOWER true
+#else
+#define RH_RF69_DEFAULT_HIGHPOWER false
+#endif
+
+// Registers modelled by the simulator
+#define RH_RF69_REG_00_FIFO 0x00
+#define RH_RF69_REG_01_OPMODE 0x01
+#define RH_RF69_REG_02_DATAMODUL 0x02
+#define RH_RF69_REG_03_BITRATEMSB 0x03
+#define RH_RF69_REG_04_BITRATELSB 0x04
+#define RH_RF69_REG_07_FRFMSB 0x07
+#define RH_RF69_REG_08_FRFMID 0x08
+#define RH_RF69_REG_09_FRFLSB 0x09
+#define RH_RF69_REG_11_PALEVEL 0x11
+#define RH_RF69_REG_23_RSSICONFIG 0x23
+#define RH_RF69_REG_24_RSSIVALUE 0x24
+#define RH_RF69_REG_25_DIOMAPPING1 0x25
+#define RH_RF69_REG_27_IRQFLAGS1 0x27
+#define RH_RF69_REG_28_IRQFLAGS2 0x28
+#define RH_RF69_REG_29_RSSITHRESH 0x29
+#define RH_RF69_REG_37_PACKETCONFIG1 0x37
+
+#define RH_RF69_OPMODE_MODE 0x1c
+#define RH_RF69_OPMODE_MODE_SLEEP 0x00
+#define RH_RF69_OPMODE_MODE_STDBY 0x04
+#define RH_RF69_OPMODE_MODE_FS 0x08
+#define RH_RF69_OPMODE_MODE_TX 0x0c
+#define RH_RF69_OPMODE_MODE_RX 0x10
+
+#define RH_RF69_RSSICONFIG_RSSIDONE 0x02
+#define RH_RF69_RSSICONFIG_RSSISTART 0x01
+
+#define RH_RF69_IRQFLAGS1_MODEREADY 0x80
+#define RH_RF69_IRQFLAGS1_RXREADY 0x40
+#define RH_RF69_IRQFLAGS1_TXREADY 0x20
+#define RH_RF69_IRQFLAGS1_RSSI 0x08
+
+#define RH_RF69_IRQFLAGS2_FIFOFULL 0x80
+#define RH_RF69_IRQFLAGS2_FIFONOTEMPTY 0x40
+#define RH_RF69_IRQFLAGS2_PACKETSENT 0x08
+#define RH_RF69_IRQFLAGS2_PAYLOADREADY 0x04
+#define RH_RF69_IRQFLAGS2_CRCOK 0x02
+
+class RHGenericSPI {};
+extern RHGenericSPI hardware_spi;
+
+class RHGenericDriver {
+public:
+  typedef enum {
+    RHModeInitialising = 0,
+    RHModeSleep,
+    RHModeIdle,
+    RHModeTx,
+    RHModeRx,
+    RHModeCad
+  } RHMode;
+
+  virtual ~RHGenericDriver() {}
+  virtual bool init() { return true; }
+  virtual bool available() = 0;
+  virtual bool recv(uint8_t *buf, uint8_t *len) = 0;
+  virtual bool send(const uint8_t *data, uint8_t len) = 0;
+  virtual uint8_t maxMessageLength() = 0;
+  virtual bool waitPacketSent() = 0;
+
+  virtual void setThisAddress(uint8_t a) { _thisAddress = a; }
+  virtual void setHeaderTo(uint8_t to) { _txHeaderTo = to; }
+  virtual void setHeaderFrom(uint8_t from) { _txHeaderFrom = from; }
+  virtual void setHeaderId(uint8_t id) { _txHeaderId = id; }
+  virtual void setHeaderFlags(uint8_t set, uint8_t clear = RH_FLAGS_APPLICATION_SPECIFIC) {
+    _txHeaderFlags &= ~clear;
+    _txHeaderFlags |= set;
+  }
+  virtual void setPromiscuous(bool p) { _promiscuous = p; }
+  virtual uint8_t headerTo() { return _rxHeaderTo; }
+  virtual uint8_t headerFrom() { return _rxHeaderFrom; }
+  virtual uint8_t headerId() { return _rxHeaderId; }
+  virtual uint8_t headerFlags() { return _rxHeaderFlags; }
+  virtual int16_t lastRssi() { return _lastRssi; }
+  virtual RHMode mode() { return _mode; }
+  virtual void setMode(RHMode m) { _mode = m; }
+  virtual bool sleep() { return false; }
+  virtual uint16_t rxBad() { return _rxBad; }
+  virtual uint16_t rxGood() { return _rxGood; }
+  virtual uint16_t txGood() { return _txGood; }
+
+protected:
+  volatile RHMode _mode = RHModeInitialising;
+  uint8_t _thisAddress = 0;
+  bool _promiscuous = false;
+  volatile uint8_t _rxHeaderTo = 0;
+  volatile uint8_t _rxHeaderFrom = 0;
+  volatile uint8_t _rxHeaderId = 0;
+  volatile uint8_t _rxHeaderFlags = 0;
+  uint8_t _txHeaderTo = RH_BROADCAST_ADDRESS;
+  uint8_t _txHeaderFrom = RH_BROADCAST_ADDRESS;
+  uint8_t _txHeaderId = 0;
+  uint8_t _txHeaderFlags = 0;
+  volatile int16_t _lastRssi = 0;
+  volatile uint16_t _rxBad = 0;
+  volatile uint16_t _rxGood = 0;
+  volatile uint16_t _txGood = 0;
+};
+
+class RHSPIDriver : public RHGenericDriver {
+public:
+  RHSPIDriver(uint8_t slaveSelectPin = SS, RHGenericSPI &spi = hardware_spi) { (void)slaveSelectPin; (void)spi; }
+  bool init() override { return true; }
+  virtual uint8_t spiRead(uint8_t reg) = 0;
+  virtual uint8_t spiWrite(uint8_t reg, uint8_t val) = 0;
+  virtual uint8_t spiBurstRead(uint8_t reg, uint8_t *dest, uint8_t len);
+  virtual uint8_t spiBurstWrite(uint8_t reg, const uint8_t *src, uint8_t len);
+
+  // Simulator: chip-select cycles, for SPI cost benches (a burst is one)
+  uint32_t simSpiTransfers = 0;
+
+protected:
+  bool simSpiBurst = false;
+};
+
+class RH_RF69 : public RHSPIDriver {
+public:
+  typedef struct {
+    uint8_t reg_02, reg_03, reg_04, reg_05, reg_06, reg_19, reg_1a, reg_37;
+  } ModemConfig;
+
+  typedef enum {
+    FSK_Rb2Fd5 = 0,
+    FSK_Rb2_4Fd4_8,
+    FSK_Rb4_8Fd9_6,
+    FSK_Rb9_6Fd19_2,
+    FSK_Rb19_2Fd38_4,
+    FSK_Rb38_4Fd76_8,
+    FSK_Rb57_6Fd120,
+    FSK_Rb125Fd125,
+    FSK_Rb250Fd250,
+    FSK_Rb55555Fd50,
+
+    GFSK_Rb2Fd5,
+    GFSK_Rb2_4Fd4_8,
+    GFSK_Rb4_8Fd9_6,
+    GFSK_Rb9_6Fd19_2,
+    GFSK_Rb19_2Fd38_4,
+    GFSK_Rb38_4Fd76_8,
+    GFSK_Rb57_6Fd120,
+    GFSK_Rb125Fd125,
+    GFSK_Rb250Fd250,
+    GFSK_Rb55555Fd50,
+
+    OOK_Rb1Bw1,
+    OOK_Rb1_2Bw75,
+    OOK_Rb2_4Bw4_8,
+    OOK_Rb4_8Bw9_6,
+    OOK_Rb9_6Bw19_2,
+    OOK_Rb19_2Bw38_4,
+    OOK_Rb32Bw64,
+  } ModemConfigChoice;
+
+  RH_RF69(uint8_t slaveSelectPin = SS, uint8_t interruptPin = 2, RHGenericSPI &spi = hardware_spi);
+
+  bool init() override;
+  int8_t temperatureRead() { return 25; }
+  bool setFrequency(float centre, float afcPullInRange = 0.05);
+  int8_t rssiRead();
+  void setOpMode(uint8_t mode);
+  void setModeIdle();
+  void setModeRx();
+  void setModeTx();
+  void setTxPower(int8_t power, bool ishighpowermodule = RH_RF69_DEFAULT_HIGHPOWER);
+  bool setModemConfig(ModemConfigChoice index);
+  bool available() override;
+  bool recv(uint8_t *buf, uint8_t *len) override;
+  bool send(const uint8_t *data, uint8_t len) override;
+  bool waitPacketSent() override;
+  void setPreambleLength(uint16_t bytes) { preambleLen = bytes; }
+  void setSyncWords(const uint8_t *syncWords = NULL, uint8_t len = 0) { (void)syncWords; syncLen = len ? len : 2; }
+  void setEncryptionKey(uint8_t *key = NULL) { encrypted = key != NULL; }
+  uint32_t getLastPreambleTime() { return _lastPreambleTime; }
+  uint8_t maxMessageLength() override { return RH_RF69_MAX_MESSAGE_LEN; }
+  bool printRegisters() { return false; }
+  bool sleep() override;
+
+  uint8_t spiRead(uint8_t reg) override;
+  uint8_t spiWrite(uint8_t reg, uint8_t val) override;
+
+  // ───── Simulator hooks (sim/arduino/SimNode.cpp) ─────
+  void simService();  // raise DIO0 when a frame has finished (TX) or arrived (RX)
+  void simDeliver(uint32_t frf, uint8_t modem, const uint8_t *frame, uint8_t len, int16_t rssi);
+  void simInject(const uint8_t *frame, uint8_t len, int16_t rssi) { simDeliver(frf(), modem, frame, len, rssi); }
+  uint32_t simAirtimeUs(uint8_t payloadLen) const;
+
+protected:
+  void handleInterrupt();
+  void readFifo();
+
+  static void isr0();
+
+  uint8_t _interruptPin;
+  uint8_t _idleMode = RH_RF69_OPMODE_MODE_STDBY;
+  int8_t _power = 13;
+  volatile uint8_t _bufLen = 0;
+  uint8_t _buf[RH_RF69_MAX_MESSAGE_LEN];
+  volatile bool _rxBufValid = false;
+  uint32_t _lastPreambleTime = 0;
+
+private:
+  uint32_t frf() const;
+
+  uint8_t regs[0x80] = {};
+  uint8_t modem = GFSK_Rb250Fd250;
+  uint16_t preambleLen = 4;
+  uint8_t syncLen = 2;
+  bool encrypted = false;
+
+  uint8_t fifo[RH_RF69_FIFO_SIZE];  // length-less frame: to, from, id, flags, payload
+  uint8_t fifoLen = 0;
+  uint64_t txEndAt_us = 0;
+
+  uint8_t rxFrame[RH_RF69_FIFO_SIZE];
+  uint8_t rxLen = 0;
+  int16_t rxRssi = 0;
+  bool rxPending = false;
+};
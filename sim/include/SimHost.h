@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+
+// ────────────────────────────────
+// Boundary between the simulator host and one firmware instance
+// ────────────────────────────────
+// Every node is a private copy of the firmware shared object, so all of its
+// globals (radio, peers, scheduler, LittleFS, Serial…) are per node. The host
+// owns the virtual clock and the radio medium and is reached only through
+// this interface; node → host calls never go through the dynamic linker.
+
+class SimHost {
+public:
+  virtual ~SimHost() {}
+
+  // Virtual clock (µs since start); micros()/millis() truncate it like the RP2040 timer
+  virtual uint64_t nowUs() = 0;
+  // delay() inside a node: moves the clock without running other nodes
+  virtual void advance(uint32_t us) = 0;
+
+  // Frame put on air by node `node` on channel `frf` (RFM69 FRF register value);
+  // it occupies the channel for airtime_us from now
+  virtual void transmit(uint8_t node, uint32_t frf, uint8_t modem, int8_t powerDbm,
+                        const uint8_t *frame, uint8_t len, uint32_t airtime_us) = 0;
+  // Strongest signal currently on `frf` as seen by `node` (RssiValue register)
+  virtual int16_t channelRssi(uint8_t node, uint32_t frf) = 0;
+
+  // IN report taken by the USB host at its poll slot
+  virtual void hidReport(uint8_t node, uint8_t reportId, const uint8_t *data, uint8_t len) = 0;
+
+  // One complete Serial line
+  virtual void log(uint8_t node, const char *line) = 0;
+};
+
+struct SimNodeConfig {
+  uint8_t index;        // host slot, also seeds random()
+  bool tx;              // TX nodes see a PCF8575 on I2C, RX nodes do not
+  uint8_t nodeAddr;     // written to /config.json before setup(); 0 = leave default
+  uint8_t debugLevel;   // DEBUG_LEVEL override
+  bool noSleep;         // WFE returns at once, as if built with IDLE_ENABLE 0
+  uint16_t wakeUs;      // an ISR ending a WFE resumes loop() this much later
+};
+
+// Exported by every node instance (resolved by the host with dlsym)
+extern "C" {
+typedef void (*SimAttachFn)(SimHost *host, const SimNodeConfig *cfg);
+typedef void (*SimVoidFn)();
+typedef void (*SimSetPinsFn)(uint16_t pins);
+typedef void (*SimReceiveFn)(uint32_t frf, uint8_t modem, const uint8_t *frame, uint8_t len, int16_t rssi);
+typedef void (*SimBindingFn)(uint8_t addr, uint8_t pin, uint8_t *type, uint8_t *code);
+typedef void (*SimCpuFn)(uint64_t *awake, uint64_t *steps);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <Arduino.h>
+#include "SimHost.h"
+
+class RH_RF69;
+class Adafruit_USBD_HID;
+
+// ────────────────────────────────
+// Per-node runtime state (one copy per loaded firmware instance)
+// ────────────────────────────────
+namespace sim {
+  struct Node {
+    SimHost *host = nullptr;
+    SimNodeConfig cfg = {};
+
+    // Peripherals register themselves on construction
+    RH_RF69 *radio = nullptr;
+    Adafruit_USBD_HID *hid = nullptr;
+
+    // PCF8575 inputs (raw levels) and its open-drain /INT line
+    uint16_t pcfPins = 0xFFFF;
+    bool pcfIntLow = false;
+
+    // GPIO interrupts: one handler per pin, edge mode as given to attachInterrupt()
+    static const uint8_t PIN_COUNT = 32;
+    void (*isr[PIN_COUNT])() = {};
+    uint8_t isrMode[PIN_COUNT] = {};
+    bool irqMasked = false;
+
+    // WFE (best_effort_wfe_or_timeout): loop() is skipped until wakeAt or an ISR
+    bool asleep = false;
+    uint64_t wakeAt = 0;
+    uint64_t steps = 0;        // host ticks
+    uint64_t awakeSteps = 0;   // ticks that ran loop()
+
+    // Heap (SimHeap.cpp): sealed when setup() returns, then every allocation counts
+    bool heapSealed = false;
+    uint32_t heapAllocs = 0;
+    uint64_t heapBytes = 0;
+  };
+
+  extern Node node;
+
+  uint64_t nowUs();
+  // Run the handler attached to `pin` if it listens for `edge` (RISING/FALLING)
+  void raise(int pin, int edge);
+}
+
+#define SIM_EXPORT extern "C" __attribute__((visibility("default")))
@@ -0,0 +1,15 @@
+#pragma once
+#include <Arduino.h>
+
+// I2C bus: devices answer according to the node's simulated board
+class TwoWire {
+public:
+  void begin() {}
+  void setClock(uint32_t) {}
+  void beginTransmission(uint8_t a) { addr = a; }
+  uint8_t endTransmission(bool stop = true);
+
+private:
+  uint8_t addr = 0;
+};
+extern TwoWire Wire;
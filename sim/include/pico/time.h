@@ -0,0 +1,16 @@
+#pragma once
+#include <stdint.h>
+
+// ────────────────────────────────
+// pico-sdk time stand-ins (virtual clock)
+// ────────────────────────────────
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time();
+inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+
+// No thread blocks here: the node is marked asleep and the host skips its
+// loop() until the time has come or an interrupt handler runs. Returns false
+// like a wake-up by interrupt, since the wait has not happened yet. An
+// interrupt runs its handler at once but holds loop() for cfg.wakeUs.
+bool best_effort_wfe_or_timeout(absolute_time_t timeout);
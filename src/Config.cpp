@@ -36,7 +36,7 @@ uint16_t PCF_INVERT_MASK = 0x0000;
 
 
 // ======================================================
-// Example: Gamepad-only hidMap[]
+// Example: Gamepad-only hidLayouts[]
 // - BTN0 → Gamepad "A"
 // - BTN1 → Gamepad "B"
 // - BTN2 → Gamepad "X"
@@ -55,10 +55,11 @@ uint16_t PCF_INVERT_MASK = 0x0000;
 
 
 // ==========================================================
-// HID maps for multiple TX nodes (IDs 1..MAX_TX)
+// HID layouts, shared by TX nodes (IDs 1..MAX_TX) via hidMapFor()
+// TX1, TX5, TX9 … → layout 0; TX2, TX6 … → layout 1; and so on
 // ==========================================================
 
-HidBinding hidMap[MAX_TX][BTN_COUNT] = {
+HidBinding hidLayouts[HID_LAYOUT_COUNT][BTN_COUNT] = {
   // ────────────────────────────────
   // TX1 — Gamepad standard layout (original)
   // ────────────────────────────────
@@ -0,0 +1,37 @@
+#include "Console.h"
+#include "Trace.h"
+#include "Storage.h"
+
+static char line[32];
+static uint8_t lineLen = 0;
+
+static void run(const char *cmd, Scheduler &scheduler, Radio &radio) {
+  if (!strcmp(cmd, "tasks")) {
+    scheduler.report(Serial);
+  } else if (!strcmp(cmd, "tasks reset")) {
+    scheduler.resetStats();
+    Serial.println(F("[CONSOLE] task stats cleared"));
+  } else if (!strcmp(cmd, "radio")) {
+    radio.report(Serial);
+  } else if (!strcmp(cmd, "trace")) {
+    Trace::report(Serial);
+  } else if (!strcmp(cmd, "errors")) {
+    Storage::exportLog(Serial);
+    Storage::reportLog(Serial);
+  } else if (cmd[0]) {
+    Serial.println(F("[CONSOLE] commands: tasks, tasks reset, radio, trace, errors"));
+  }
+}
+
+void Console::task(Scheduler &scheduler, Radio &radio) {
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c == '\r' || c == '\n') {
+      line[lineLen] = 0;
+      run(line, scheduler, radio);
+      lineLen = 0;
+    } else if (lineLen < sizeof(line) - 1) {
+      line[lineLen++] = c;
+    }
+  }
+}
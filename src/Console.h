@@ -0,0 +1,17 @@
+#pragma once
+#include <Arduino.h>
+#include "Scheduler.h"
+#include "Radio.h"
+
+// ────────────────────────────────
+// Serial console
+// ────────────────────────────────
+// Line commands on the USB serial port (115200, newline-terminated):
+//   tasks        per-task runtime, start jitter and deadline misses
+//   tasks reset  clear those counters
+//   radio        the radio's monitor reports
+//   trace        latency histograms
+//   errors       the flash error log as JSON, then its counters
+namespace Console {
+  void task(Scheduler &scheduler, Radio &radio);  // non-blocking: reads what has arrived
+}
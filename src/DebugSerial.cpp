@@ -0,0 +1,45 @@
+#include "DebugSerial.h"
+#include "Config.h"
+
+CoreSerial DebugSerial;
+
+static bool onRadioCore() {
+#if RADIO_ON_CORE1
+  return rp2040.cpuid() == 1;
+#else
+  return false;
+#endif
+}
+
+size_t CoreSerial::write(uint8_t c) {
+  if (!onRadioCore()) return Serial.write(c);
+  line[len++] = (char)c;
+  if (c == '\n' || len == sizeof(line)) queueLine();
+  return 1;
+}
+
+size_t CoreSerial::write(const uint8_t *buf, size_t n) {
+  if (!onRadioCore()) return Serial.write(buf, n);
+  for (size_t i = 0; i < n; i++) write(buf[i]);
+  return n;
+}
+
+// Radio core: the whole line or none of it, so drain() never ends mid-line
+void CoreSerial::queueLine() {
+  if (lines.capacity() - lines.size() >= len) {
+    for (uint8_t i = 0; i < len; i++) lines.push(line[i]);
+  } else {
+    droppedLines.store(droppedLines.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+  len = 0;
+}
+
+void CoreSerial::drain() {
+  char c;
+  while (lines.pop(c)) Serial.write((uint8_t)c);
+  uint32_t dropped = droppedLines.load(std::memory_order_relaxed);
+  if (dropped != reportedDrops) {
+    Serial.printf("[LOG] %lu radio core lines dropped\n", (unsigned long)(dropped - reportedDrops));
+    reportedDrops = dropped;
+  }
+}
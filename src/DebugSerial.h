@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "SpscRing.h"
+
+// ────────────────────────────────
+// Debug output from either core
+// ────────────────────────────────
+// Serial belongs to core 0. Code that may run on the radio core (RX with
+// RADIO_ON_CORE1) prints through DebugSerial instead: on core 0 it writes
+// straight to Serial, on core 1 it collects each line and queues it whole
+// for core 0's loop to drain(), so core 1 never waits on USB CDC and its
+// lines never split around core 0's. A line that does not fit is dropped
+// and counted.
+class CoreSerial : public Print {
+public:
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t n) override;
+  using Print::write;
+
+  void drain();  // core 0, every loop pass
+
+  std::atomic<uint32_t> droppedLines{ 0 };
+
+private:
+  void queueLine();
+
+  SpscRing<char, 1024> lines;
+  char line[128];
+  uint8_t len = 0;
+  uint32_t reportedDrops = 0;
+};
+
+extern CoreSerial DebugSerial;
@@ -1,13 +1,15 @@
 #include "Config.h"
 #include "Hid.h"
+#include "Trace.h"
+#include "Peers.h"
 #include <type_traits>
 #include <utility>
 
 // ====== Globals ======
 Adafruit_USBD_HID usb_hid;
 
-// Track per-node/per-pin HID runtime state so repeats work across multiple transmitters
-HidRuntime hidState[MAX_TX][BTN_COUNT];  // runtime state per node/pin
+// Per-node/per-pin HID runtime state lives in the sparse peer table (Peer::hid)
+// so repeats work across multiple transmitters without a MAX_TX-sized array
 
 // ====== Keyboard state ======
 static uint8_t kbd_report[6] = { 0 };
@@ -66,74 +68,50 @@ static bool addKeyToReport(uint8_t keycode) {
   return false;
 }
 
-static bool isKeyHeldElsewhere(uint8_t skipTx, uint8_t skipPin, uint8_t keycode) {
-  for (uint8_t tx = 0; tx < MAX_TX; ++tx) {
-    for (uint8_t pin = 0; pin < BTN_COUNT; ++pin) {
-      if (tx == skipTx && pin == skipPin) continue;
-      const HidRuntime &state = hidState[tx][pin];
-      if (!state.pressed || state.binding == nullptr) continue;
-      for (const HidAction &act : state.binding->actions) {
-        if (act.type == HID_KEYBOARD && act.code == keycode) return true;
-      }
-    }
+// ====== Held-output reference counts ======
+// Maintained on press/release so a release only has to look at its own
+// actions instead of scanning every node × pin for other holders. A press
+// first releases the pin's previous binding, so one output has at most one
+// hold per node × pin × action; nodes share layouts, so that can be them all.
+typedef uint16_t HoldRef;
+static_assert(MAX_TX * BTN_COUNT * 4 <= 0xFFFF, "HoldRef must count every node × pin × action");
+static HoldRef keyRefs[256] = { 0 };
+static HoldRef modifierRefs[8] = { 0 };
+static HoldRef mouseRefs[8] = { 0 };
+static HoldRef gamepadRefs[32] = { 0 };
+
+static void holdModifiers(uint8_t mods) {
+  for (uint8_t bit = 0; bit < 8; ++bit) {
+    if (mods & (1 << bit)) modifierRefs[bit]++;
   }
-  return false;
 }
 
-static uint8_t modifiersHeldElsewhere(uint8_t skipTx, uint8_t skipPin) {
-  uint8_t mask = 0;
-  for (uint8_t tx = 0; tx < MAX_TX; ++tx) {
-    for (uint8_t pin = 0; pin < BTN_COUNT; ++pin) {
-      if (tx == skipTx && pin == skipPin) continue;
-      const HidRuntime &state = hidState[tx][pin];
-      if (!state.pressed || state.binding == nullptr) continue;
-      for (const HidAction &act : state.binding->actions) {
-        if (act.type == HID_KEYBOARD) {
-          mask |= act.modifiers;
-        }
-      }
-    }
+// Returns the modifier bits whose last holder just let go
+static uint8_t dropModifiers(uint8_t mods) {
+  uint8_t cleared = 0;
+  for (uint8_t bit = 0; bit < 8; ++bit) {
+    if (!(mods & (1 << bit)) || modifierRefs[bit] == 0) continue;
+    if (--modifierRefs[bit] == 0) cleared |= (1 << bit);
   }
-  return mask;
+  return cleared;
 }
 
-static bool isMouseButtonHeldElsewhere(uint8_t skipTx, uint8_t skipPin, uint8_t button) {
-  for (uint8_t tx = 0; tx < MAX_TX; ++tx) {
-    for (uint8_t pin = 0; pin < BTN_COUNT; ++pin) {
-      if (tx == skipTx && pin == skipPin) continue;
-      const HidRuntime &state = hidState[tx][pin];
-      if (!state.pressed || state.binding == nullptr) continue;
-      for (const HidAction &act : state.binding->actions) {
-        if (act.type == HID_MOUSE && act.code == button) {
-          return true;
-        }
-      }
-    }
-  }
-  return false;
-}
-
-static bool isGamepadButtonHeldElsewhere(uint8_t skipTx, uint8_t skipPin, uint8_t button) {
-  for (uint8_t tx = 0; tx < MAX_TX; ++tx) {
-    for (uint8_t pin = 0; pin < BTN_COUNT; ++pin) {
-      if (tx == skipTx && pin == skipPin) continue;
-      const HidRuntime &state = hidState[tx][pin];
-      if (!state.pressed || state.binding == nullptr) continue;
-      for (const HidAction &act : state.binding->actions) {
-        if (act.type == HID_GAMEPAD && act.code == button) {
-          return true;
-        }
-      }
-    }
-  }
-  return false;
+// Decrement a refcount; true when this was the last holder
+static bool dropRef(HoldRef &ref) {
+  if (ref == 0) return false;
+  return --ref == 0;
 }
 
 // ====== Shared helpers ======
+static void doRelease(uint8_t txIndex, uint8_t pin);
+
 static void doPress(uint8_t txIndex, uint8_t pin, const HidBinding &bind) {
-  if (txIndex >= MAX_TX || pin >= BTN_COUNT) return;
+  Peer *peer = peers.find(txIndex + 1);
+  if (!peer || pin >= BTN_COUNT) return;  // no frame from that node yet: nothing to press for
+
+  HidRuntime &state = peer->hid[pin];
+  if (state.binding) doRelease(txIndex, pin);  // repeated press: keep refcounts balanced
 
-  HidRuntime &state = hidState[txIndex][pin];
   state.pressed = true;
   state.binding = &bind;
   state.pressStart = millis();
@@ -145,6 +123,8 @@ static void doPress(uint8_t txIndex, uint8_t pin, const HidBinding &bind) {
 
     switch (act.type) {
       case HID_KEYBOARD:
+        keyRefs[act.code]++;
+        holdModifiers(act.modifiers);
         if (!addKeyToReport(act.code) && (DEBUG_LEVEL & HID_DEBUG)) {
           Serial.println(F("[HID] keyboard rollover full; drop key"));
         }
@@ -161,6 +141,8 @@ static void doPress(uint8_t txIndex, uint8_t pin, const HidBinding &bind) {
         break;
 
       case HID_MOUSE:
+        if (act.code >= 8) break;
+        mouseRefs[act.code]++;
         mouse_buttons |= (1 << act.code);
         mouseDirty = true;
         if (DEBUG_LEVEL & HID_DEBUG) {
@@ -194,7 +176,9 @@ static void doPress(uint8_t txIndex, uint8_t pin, const HidBinding &bind) {
         break;
 
       case HID_GAMEPAD:
-        gp_report.buttons |= (1 << act.code);
+        if (act.code >= 32) break;
+        gamepadRefs[act.code]++;
+        gp_report.buttons |= (1UL << act.code);
         gpDirty = true;
         if (DEBUG_LEVEL & HID_DEBUG) {
           Serial.print(F("[HID] node="));
@@ -213,9 +197,10 @@ static void doPress(uint8_t txIndex, uint8_t pin, const HidBinding &bind) {
 }
 
 static void doRelease(uint8_t txIndex, uint8_t pin) {
-  if (txIndex >= MAX_TX || pin >= BTN_COUNT) return;
+  Peer *peer = peers.find(txIndex + 1);
+  if (!peer || pin >= BTN_COUNT) return;
 
-  HidRuntime &state = hidState[txIndex][pin];
+  HidRuntime &state = peer->hid[pin];
   const HidBinding *binding = state.binding;
   if (!binding) return;
 
@@ -231,7 +216,12 @@ static void doRelease(uint8_t txIndex, uint8_t pin) {
     switch (act.type) {
       case HID_KEYBOARD: {
         bool removed = false;
-        if (!isKeyHeldElsewhere(txIndex, pin, act.code)) {
+        uint8_t cleared = dropModifiers(act.modifiers);
+        if (cleared) {
+          kbd_modifiers &= ~cleared;
+          kbdDirty = true;
+        }
+        if (dropRef(keyRefs[act.code])) {
           for (int i = 0; i < 6; ++i) {
             if (kbd_report[i] == act.code) {
               kbd_report[i] = 0;
@@ -255,8 +245,9 @@ static void doRelease(uint8_t txIndex, uint8_t pin) {
       }
 
       case HID_MOUSE: {
+        if (act.code >= 8) break;
         uint8_t before = mouse_buttons;
-        if (!isMouseButtonHeldElsewhere(txIndex, pin, act.code)) {
+        if (dropRef(mouseRefs[act.code])) {
           mouse_buttons &= ~(1 << act.code);
         }
         if (mouse_buttons != before) {
@@ -276,8 +267,9 @@ static void doRelease(uint8_t txIndex, uint8_t pin) {
       }
 
       case HID_GAMEPAD: {
+        if (act.code >= 32) break;
         uint32_t before = gp_report.buttons;
-        if (!isGamepadButtonHeldElsewhere(txIndex, pin, act.code)) {
+        if (dropRef(gamepadRefs[act.code])) {
           gp_report.buttons &= ~(1UL << act.code);
         }
         if (gp_report.buttons != before) {
@@ -300,12 +292,6 @@ static void doRelease(uint8_t txIndex, uint8_t pin) {
         break;
     }
   }
-
-  uint8_t modifierMask = modifiersHeldElsewhere(txIndex, pin);
-  if (kbd_modifiers != modifierMask) {
-    kbd_modifiers = modifierMask;
-    kbdDirty = true;
-  }
 }
 
 // ====== Init ======
@@ -327,46 +313,210 @@ void hidBegin() {
     delay(10);
     TinyUSBDevice.attach();
   }
+}
 
-  for (uint8_t tx = 0; tx < MAX_TX; ++tx) {
-    for (uint8_t pin = 0; pin < BTN_COUNT; ++pin) {
-      hidState[tx][pin] = { false, 0, 0, nullptr };
+// ====== Report pump ======
+// All three report IDs share one interrupt IN endpoint, so only one report
+// can be in flight. Dirty state is coalesced and the next report is sent
+// from the loop pass after tud_hid_report_complete_cb, so back-to-back
+// changes follow the 2 ms poll instead of the task tick.
+//
+// TinyUSB runs its callbacks in interrupt context. They only raise the flags
+// below; the report and pulse state, the trace ring and Serial are touched
+// from the loop alone.
+static const uint8_t PULSE_MAX = 64;
+static uint8_t pulseQueue[PULSE_MAX];  // keycodes awaiting a synthetic repeat pulse
+static uint8_t pulseHead = 0;
+static uint8_t pulseCount = 0;
+static bool pulseReleaseSent = false;
+
+static volatile bool endpointFree = false;  // report taken by the host
+static volatile bool usbMounted = false;
+static volatile bool usbUnmounted = false;
+static volatile bool usbSuspended = false;
+static volatile bool usbResumed = false;
+
+static void queuePulse(uint8_t keycode) {
+  if (pulseCount >= PULSE_MAX) return;
+  pulseQueue[(pulseHead + pulseCount) % PULSE_MAX] = keycode;
+  pulseCount++;
+}
+
+static void popPulse() {
+  pulseHead = (pulseHead + 1) % PULSE_MAX;
+  pulseCount--;
+  pulseReleaseSent = false;
+}
+
+// Send the single most urgent pending report; false when nothing went out
+static bool sendNextReport() {
+  // Repeat pulse: key-up report, then the normal keyboard report restores it
+  while (pulseCount) {
+    uint8_t keycode = pulseQueue[pulseHead];
+    if (pulseReleaseSent) {
+      popPulse();
+      kbdDirty = true;
+      break;
     }
+    if (!keyInReport(keycode)) {  // key no longer held
+      popPulse();
+      continue;
+    }
+    uint8_t releaseReport[6];
+    memcpy(releaseReport, kbd_report, sizeof(releaseReport));
+    for (int slot = 0; slot < 6; ++slot) {
+      if (releaseReport[slot] == keycode) {
+        releaseReport[slot] = 0;
+        break;
+      }
+    }
+    if (!usb_hid.keyboardReport(1, kbd_modifiers, releaseReport)) return false;
+    pulseReleaseSent = true;
+    return true;
+  }
+
+  if (kbdDirty) {
+    if (!usb_hid.keyboardReport(1, kbd_modifiers, kbd_report)) return false;
+    kbdDirty = false;
+    return true;
+  }
+
+  if (mouseDirty) {
+    if (!usb_hid.mouseReport(2, mouse_buttons, mouse_dx, mouse_dy, mouse_wheel, 0)) return false;
+    if (DEBUG_LEVEL & HID_DEBUG) {
+      Serial.print(F("[HID] Mouse moved (dx="));
+      Serial.print(mouse_dx);
+      Serial.print(F(", dy="));
+      Serial.print(mouse_dy);
+      Serial.print(F(", wheel="));
+      Serial.print(mouse_wheel);
+      Serial.println(F(")"));
+    }
+    mouse_dx = mouse_dy = mouse_wheel = 0;
+    mouseDirty = false;
+    return true;
+  }
+
+  if (gpDirty) {
+    if (!usb_hid.sendReport(3, &gp_report, sizeof(gp_report))) return false;
+    gpDirty = false;
+    return true;
   }
+
+  return false;
+}
+
+// Emit the next report if the endpoint is idle (loop context only)
+static void hidPump() {
+  if (!usb_hid.ready()) return;
+  if (sendNextReport()) Trace::mark(TP_HID_REPORT, 0xFF);
+}
+
+// The host has dropped everything: so do the holders, and a node still
+// pressing a pin shows up again on its next edge
+static void resetReports() {
+  memset(keyRefs, 0, sizeof(keyRefs));
+  memset(modifierRefs, 0, sizeof(modifierRefs));
+  memset(mouseRefs, 0, sizeof(mouseRefs));
+  memset(gamepadRefs, 0, sizeof(gamepadRefs));
+  for (uint8_t i = 0; i < peers.activeCount(); ++i) {
+    for (HidRuntime &state : peers.active(i)->hid) state = {};
+  }
+  memset(kbd_report, 0, sizeof(kbd_report));
+  kbd_modifiers = 0;
+  mouse_buttons = 0;
+  gp_report.buttons = 0;
+  pulseCount = 0;
+  pulseReleaseSent = false;
+}
+
+// Loop side of the TinyUSB callbacks (every loop pass)
+void hidService() {
+  if (usbUnmounted) {
+    usbUnmounted = false;
+    resetReports();
+    if (DEBUG_LEVEL & HID_DEBUG) Serial.println(F("[USB] HID reset state on unmount"));
+  }
+  if (DEBUG_LEVEL & HID_DEBUG) {
+    if (usbMounted) Serial.println(F("[USB] HID mounted and enumerated"));
+    if (usbSuspended) Serial.println(F("[USB] HID suspended"));
+    if (usbResumed) Serial.println(F("[USB] HID resumed"));
+  }
+  usbMounted = usbSuspended = usbResumed = false;
+
+  if (!endpointFree) return;
+  endpointFree = false;  // only one report is in flight, so none can complete before the next send
+  hidPump();
 }
 
 // ====== Wrappers for TX (single-node row 0) ======
 void hidHandlePress(uint8_t pin) {
   if (pin >= BTN_COUNT) return;
-  doPress(0, pin, hidMap[0][pin]);
+  peers.acquire(1);  // local buttons press as node 1
+  doPress(0, pin, hidMapFor(1)[pin]);
+  hidPump();
 }
 
 void hidHandleRelease(uint8_t pin) {
   if (pin >= BTN_COUNT) return;
   doRelease(0, pin);
+  hidPump();
 }
 
 // ====== Wrappers for RX multi-node ======
-void hidHandlePressWithMap(uint8_t txIndex, uint8_t pin, const HidBinding *map) {
-  if (!map || pin >= BTN_COUNT) return;
+// What the host sees; a press or release that leaves it as it was (unbound
+// pin, output already held by another node) produces no report
+struct HidOutputs {
+  uint8_t kbd[6];
+  uint8_t modifiers;
+  uint8_t mouse;
+  int8_t dx, dy, wheel;
+  uint32_t gamepad;
+
+  static HidOutputs now() {
+    HidOutputs o;
+    memcpy(o.kbd, kbd_report, sizeof(o.kbd));
+    o.modifiers = kbd_modifiers;
+    o.mouse = mouse_buttons;
+    o.dx = mouse_dx;
+    o.dy = mouse_dy;
+    o.wheel = mouse_wheel;
+    o.gamepad = gp_report.buttons;
+    return o;
+  }
+  bool operator!=(const HidOutputs &b) const {
+    return memcmp(kbd, b.kbd, sizeof(kbd)) || modifiers != b.modifiers || mouse != b.mouse || dx != b.dx ||
+           dy != b.dy || wheel != b.wheel || gamepad != b.gamepad;
+  }
+};
+
+bool hidHandlePressWithMap(uint8_t txIndex, uint8_t pin, const HidBinding *map) {
+  if (!map || pin >= BTN_COUNT) return false;
+  HidOutputs before = HidOutputs::now();
   doPress(txIndex, pin, map[pin]);
+  return HidOutputs::now() != before;
 }
 
-void hidHandleReleaseWithMap(uint8_t txIndex, uint8_t pin) {
-  if (pin >= BTN_COUNT) return;
+bool hidHandleReleaseWithMap(uint8_t txIndex, uint8_t pin) {
+  if (pin >= BTN_COUNT) return false;
+  HidOutputs before = HidOutputs::now();
   doRelease(txIndex, pin);
+  return HidOutputs::now() != before;
+}
+
+void hidFlush() {
+  hidPump();  // goes out now if the IN endpoint is idle
 }
 
 // ====== Repeat Task ======
 void hidTask() {
   // Iterate across every node/pin so RX repeats stay active for all transmitters
   uint32_t now = millis();
-  uint8_t repeatQueue[MAX_TX * BTN_COUNT];  // queue repeated keycodes for synthetic keypress pulses
-  size_t repeatCount = 0;
-
-  for (uint8_t tx = 0; tx < MAX_TX; ++tx) {
+  for (uint8_t i = 0; i < peers.activeCount(); ++i) {
+    Peer *peer = peers.active(i);
+    uint8_t tx = peer->addr - 1;
     for (uint8_t pin = 0; pin < BTN_COUNT; ++pin) {
-      HidRuntime &state = hidState[tx][pin];
+      HidRuntime &state = peer->hid[pin];
       if (!state.pressed || state.binding == nullptr) continue;
       const HidBinding &bind = *state.binding;
       if (bind.nextDelay == 0) continue;
@@ -383,10 +533,7 @@ void hidTask() {
 
           switch (act.type) {
             case HID_KEYBOARD:
-              kbdDirty = true;
-              if (repeatCount < MAX_TX * BTN_COUNT) {
-                repeatQueue[repeatCount++] = act.code;
-              }
+              queuePulse(act.code);
               break;
 
             case HID_MOUSE:
@@ -435,92 +582,38 @@ void hidTask() {
     }
   }
 
-  if (repeatCount) {
-    kbdDirty = true;  // ensure base state is re-sent after synthetic repeats
-  }
-
+  // Normally drained by hidService() after each completion; this covers a
+  // missed completion and the first report after an idle endpoint
   if (usb_hid.ready()) {
-    if (repeatCount) {
-      uint8_t snapshot[6];
-      memcpy(snapshot, kbd_report, sizeof(snapshot));
-
-      for (size_t idx = 0; idx < repeatCount; ++idx) {
-        uint8_t keycode = repeatQueue[idx];
-        uint8_t releaseReport[6];
-        memcpy(releaseReport, snapshot, sizeof(releaseReport));
-
-        bool removed = false;
-        for (int slot = 0; slot < 6; ++slot) {
-          if (releaseReport[slot] == keycode) {
-            releaseReport[slot] = 0;
-            removed = true;
-            break;
-          }
-        }
-        if (!removed) continue;  // key no longer held
-
-        usb_hid.keyboardReport(1, kbd_modifiers, releaseReport);
-        usb_hid.keyboardReport(1, kbd_modifiers, snapshot);
-      }
-    }
-
-    if (kbdDirty) {
-      usb_hid.keyboardReport(1, kbd_modifiers, kbd_report);
-      kbdDirty = false;
-    }
-
-    if (mouseDirty) {
-      if (DEBUG_LEVEL & HID_DEBUG) {
-        Serial.print(F("[HID] Mouse moved (dx="));
-        Serial.print(mouse_dx);
-        Serial.print(F(", dy="));
-        Serial.print(mouse_dy);
-        Serial.print(F(", wheel="));
-        Serial.print(mouse_wheel);
-        Serial.println(F(")"));
-      }
-      usb_hid.mouseReport(2, mouse_buttons, mouse_dx, mouse_dy, mouse_wheel, 0);
-      mouse_dx = mouse_dy = mouse_wheel = 0;
-      mouseDirty = false;
-    }
-
-    if (gpDirty) {
-      usb_hid.sendReport(3, &gp_report, sizeof(gp_report));
-      gpDirty = false;
-    }
-  } else if (DEBUG_LEVEL & HID_DEBUG) {
+    hidPump();
+  } else if ((kbdDirty || mouseDirty || gpDirty || pulseCount) && (DEBUG_LEVEL & HID_DEBUG)) {
     Serial.println(F("[HID] USB not ready for report"));
   }
 }
-// ====== TinyUSB callbacks ======
+// ====== TinyUSB callbacks (interrupt context: flags only, see hidService) ======
 extern "C" {
+  // Previous IN report taken by the host: the endpoint is free for the next one
+  void tud_hid_report_complete_cb(uint8_t instance, uint8_t const *report, uint16_t len) {
+    (void)instance;
+    (void)report;
+    (void)len;
+    endpointFree = true;
+  }
+
   void tud_mount_cb(void) {
-    if (DEBUG_LEVEL & HID_DEBUG) {
-      Serial.println(F("[USB] HID mounted and enumerated"));
-    }
+    usbMounted = true;
   }
 
   void tud_umount_cb(void) {
-    memset(kbd_report, 0, sizeof(kbd_report));
-    kbd_modifiers = 0;
-    mouse_buttons = 0;
-    gp_report.buttons = 0;
-
-    if (DEBUG_LEVEL & HID_DEBUG) {
-      Serial.println(F("[USB] HID reset state on unmount"));
-    }
+    usbUnmounted = true;
   }
 
   void tud_suspend_cb(bool remote_wakeup_en) {
     (void)remote_wakeup_en;
-    if (DEBUG_LEVEL & HID_DEBUG) {
-      Serial.println(F("[USB] HID suspended"));
-    }
+    usbSuspended = true;
   }
 
   void tud_resume_cb(void) {
-    if (DEBUG_LEVEL & HID_DEBUG) {
-      Serial.println(F("[USB] HID resumed"));
-    }
+    usbResumed = true;
   }
 }
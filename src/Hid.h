@@ -32,14 +32,16 @@ struct HidRuntime {
   const HidBinding* binding;  // active binding for this node/pin (null when idle)
 };
 
-extern HidRuntime hidState[MAX_TX][BTN_COUNT];
-
 void hidBegin();
 void hidHandlePress(uint8_t pin);
 void hidHandleRelease(uint8_t pin);
 void hidTask();
-void hidHandlePressWithMap(uint8_t txIndex, uint8_t pin, const HidBinding* map);
-void hidHandleReleaseWithMap(uint8_t txIndex, uint8_t pin);
+void hidService();  // every loop pass: sends the next report once the last one completed
+// RX: apply one node's pin change; true if it changed what the host will see.
+// Nothing is sent until hidFlush().
+bool hidHandlePressWithMap(uint8_t txIndex, uint8_t pin, const HidBinding* map);
+bool hidHandleReleaseWithMap(uint8_t txIndex, uint8_t pin);
+void hidFlush();
 
 
 // TinyUSB HID object
@@ -0,0 +1,143 @@
+#include "HopSet.h"
+#include "DebugSerial.h"
+
+static_assert(!HOP_ENABLE || TDMA_ENABLE, "frequency hopping follows the TDMA superframe");
+
+// Fisher-Yates over the channel indices, driven by an xorshift seeded with
+// FNV-1a of the key; the RegFrf values are computed once here
+void HopSet::begin(Role role) {
+  uint32_t h = 2166136261u;
+  for (uint8_t b : ENCRYPTKEY) h = (h ^ b) * 16777619u;
+  if (!h) h = 1;
+  for (uint8_t i = 0; i < HOP_CHANNELS; i++) {
+    hopSeq[i] = i;
+    hopFrf[i] = RadioDriver::frfFor(RF69_FREQ_MHZ + i * (HOP_SPACING_KHZ / 1000.0f));
+  }
+  for (uint8_t i = HOP_CHANNELS - 1; i > 0; i--) {
+    h ^= h << 13;
+    h ^= h >> 17;
+    h ^= h << 5;
+    uint8_t j = h % (i + 1);
+    uint8_t t = hopSeq[i];
+    hopSeq[i] = hopSeq[j];
+    hopSeq[j] = t;
+  }
+
+  // setFrequency() once more, timed against the cached write in tune()
+  uint32_t t0 = micros();
+  rf.setFrequency(RF69_FREQ_MHZ);
+  hopSetFreq_us = micros() - t0;
+  hopChannel = 0;
+  hopParkAt = millis() + HOP_PARK_MS;
+  if (role == Role::TX) tune(hopSeq[0]);
+
+  if (DEBUG_LEVEL & RADIO_DEBUG) {
+    DebugSerial.print(F("[HOP] sequence"));
+    for (uint8_t ch : hopSeq) DebugSerial.printf(" %d", ch);
+    DebugSerial.printf(", setFrequency %luus\n", (unsigned long)hopSetFreq_us);
+  }
+}
+
+// Blacklisted channels hand their turn to the next one in the sequence
+uint8_t HopSet::channelFor(uint16_t sf, uint16_t mask) const {
+  for (uint8_t i = 0; i < HOP_CHANNELS; i++) {
+    uint8_t ch = hopSeq[(sf + i) % HOP_CHANNELS];
+    if ((mask >> ch) & 1) return ch;
+  }
+  return hopSeq[0];
+}
+
+void HopSet::tune(uint8_t ch) {
+  if (ch == hopChannel) return;
+  bool listening = rf.rxActive();
+  uint32_t t0 = micros();
+  rf.setFrf(hopFrf[ch]);
+  if (listening) rf.setModeRx();
+  hopTune_us += micros() - t0;
+  hopRetunes++;
+  hopChannel = ch;
+}
+
+// The next superframe's channel comes from the mask the last beacon announced
+void HopSet::nextSuperframe(uint16_t sf) {
+  uint16_t mask = hopMask;
+  score();
+  hopPrevChannel = hopChannel;
+  tune(channelFor(sf, mask));
+}
+
+// TX: synced, retune HOP_LEAD_US ahead of every expected beacon, missed ones included
+void HopSet::track(uint16_t sf) {
+  tune(channelFor(sf, hopMask));
+}
+
+void HopSet::park() {
+  if ((int32_t)(millis() - hopParkAt) < 0) return;
+  hopParkAt = millis() + HOP_PARK_MS;
+  hopParkIdx = (hopParkIdx + 1) % HOP_CHANNELS;
+  tune(hopSeq[hopParkIdx]);
+}
+
+void HopSet::noteRx(int16_t rssi, bool beforeAnchor) {
+  int8_t ch = beforeAnchor ? hopPrevChannel : hopChannel;
+  if (ch < 0) return;
+  ChannelScore &c = hopScore[ch];
+  c.rx++;
+  c.rssi = c.rx == 1 ? rssi : c.rssi + (rssi - c.rssi) / 8;
+}
+
+// A slotted TX re-sends one superframe after a lost copy
+void HopSet::noteLoss(uint32_t lost) {
+  if (hopPrevChannel < 0) return;
+  ChannelScore &c = hopScore[hopPrevChannel];
+  c.lost = min<uint32_t>(c.lost + min<uint32_t>(lost, 8), 0xFFFF);
+}
+
+// The superframe on hopChannel is ending. Sample its quiet gap before the
+// beacon and, every HOP_SCORE_VISITS visits, judge the channel.
+void HopSet::score() {
+  for (uint8_t ch = 0; ch < HOP_CHANNELS; ch++) {
+    ChannelScore &c = hopScore[ch];
+    if (((hopMask >> ch) & 1) || millis() - c.blacklistedAt < HOP_BLACKLIST_MS) continue;
+    c = ChannelScore();
+    hopMask |= 1u << ch;  // probation: judged again after its next visits
+  }
+  if (hopChannel < 0) return;
+
+  ChannelScore &c = hopScore[hopChannel];
+  if (rf.rxActive()) {
+    c.samples++;
+    if (rf.rssiRead() >= CSMA_BUSY_DBM) c.busy++;
+  }
+  if (++c.visits < HOP_SCORE_VISITS) return;
+
+  uint32_t frames = c.rx + c.lost;
+  bool lossy = frames >= HOP_SCORE_VISITS / 2 && c.lost * 100u > frames * HOP_BAD_PCT;
+  bool noisy = c.samples && c.busy * 100u > c.samples * HOP_BAD_PCT;
+  bool drop = (lossy || noisy) && __builtin_popcount(hopMask) > HOP_MIN_CHANNELS;
+  if (drop) {
+    hopMask &= ~(1u << hopChannel);
+    hopBlacklists++;
+    if (DEBUG_LEVEL & RADIO_DEBUG)
+      DebugSerial.printf("[HOP] channel %d blacklisted: lost %u/%lu, busy %u/%u\n", hopChannel, c.lost,
+                         (unsigned long)frames, c.busy, c.samples);
+  }
+  int16_t rssi = c.rssi;
+  c = ChannelScore();
+  c.rssi = rssi;
+  if (drop) c.blacklistedAt = millis();
+}
+
+void HopSet::report(Print &out, Role role) const {
+  if (!HOP_ENABLE) return;
+  out.printf("[HOP] ch=%d mask=0x%04X retunes=%lu tune=%luus avg (setFrequency %luus) blacklists=%lu\n", hopChannel,
+             hopMask, (unsigned long)hopRetunes, (unsigned long)(hopRetunes ? hopTune_us / hopRetunes : 0),
+             (unsigned long)hopSetFreq_us, (unsigned long)hopBlacklists);
+  if (role != Role::RX) return;
+  for (uint8_t ch = 0; ch < HOP_CHANNELS; ch++) {
+    const ChannelScore &c = hopScore[ch];
+    out.printf("[HOP]   %d %.1fMHz %s rx=%u lost=%u busy=%u/%u rssi=%d\n", ch,
+               RF69_FREQ_MHZ + ch * (HOP_SPACING_KHZ / 1000.0f), (hopMask >> ch) & 1 ? "on " : "off",
+               c.rx, c.lost, c.busy, c.samples, c.rssi);
+  }
+}
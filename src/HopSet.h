@@ -0,0 +1,59 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "RadioDriver.h"
+
+// ────────────────────────────────
+// Frequency hopping
+// ────────────────────────────────
+// Every superframe is on the next channel of a sequence derived from
+// ENCRYPTKEY. The RX scores the channels and announces the set still in use
+// (the mask) in its beacon; the TX follows the last mask it heard.
+class HopSet {
+public:
+  explicit HopSet(RadioDriver &rf) : rf(rf) {}
+
+  void begin(Role role);
+  uint16_t mask() const { return hopMask; }
+
+  // RX: scores the channel of the ending superframe and moves to the one for superframe sf
+  void nextSuperframe(uint16_t sf);
+  void noteRx(int16_t rssi, bool beforeAnchor);  // a frame; taken after the beacon, it may be the last channel's
+  void noteLoss(uint32_t lost);  // PT_PIN seqs skipped, charged to the superframe before
+
+  // TX
+  void follow(uint16_t mask) { hopMask = mask; }
+  void track(uint16_t sf);  // synced: sf's channel
+  void park();              // no beacon: one channel at a time until the RX's hop comes by
+
+  void report(Print &out, Role role) const;
+
+private:
+  struct ChannelScore {
+    uint16_t visits = 0;      // superframes spent on it since the last verdict
+    uint16_t rx = 0;          // frames received
+    uint16_t lost = 0;        // PT_PIN seqs skipped, charged to the superframe before
+    uint16_t samples = 0;     // RSSI samples of the quiet gap before the next beacon
+    uint16_t busy = 0;        // of those, at or above CSMA_BUSY_DBM
+    int16_t rssi = 0;         // received frames, smoothed
+    uint32_t blacklistedAt = 0;
+  };
+
+  RadioDriver &rf;
+  uint8_t hopSeq[HOP_CHANNELS] = {};   // channel order, from ENCRYPTKEY
+  uint32_t hopFrf[HOP_CHANNELS] = {};  // cached RegFrf values
+  uint16_t hopMask = (1u << HOP_CHANNELS) - 1;  // RX: announced; TX: from the last beacon
+  int8_t hopChannel = -1;      // tuned channel
+  int8_t hopPrevChannel = -1;  // RX: the superframe before's (seq gaps land there)
+  ChannelScore hopScore[HOP_CHANNELS];  // RX
+  uint8_t hopParkIdx = 0;      // TX: searching for a beacon
+  uint32_t hopParkAt = 0;
+  uint32_t hopRetunes = 0;
+  uint32_t hopTune_us = 0;     // total time in tune()
+  uint32_t hopSetFreq_us = 0;  // one setFrequency() at boot, for comparison
+  uint32_t hopBlacklists = 0;
+
+  uint8_t channelFor(uint16_t sf, uint16_t mask) const;
+  void tune(uint8_t ch);
+  void score();
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+
+// ────────────────────────────────
+// Fixed-capacity callable
+// ────────────────────────────────
+// std::function without the heap: the callable is copied into Capacity bytes
+// held inline, and a call is one indirect jump through a per-type thunk.
+// Only trivially copyable callables fit (lambdas capturing pointers,
+// references and plain values), so copying and destruction need no thunks.
+template <typename Sig, size_t Capacity = 2 * sizeof(void *)>
+class InplaceFunction;
+
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+public:
+  InplaceFunction() = default;
+
+  template <typename Fn, typename = typename std::enable_if<!std::is_same<Fn, InplaceFunction>::value>::type>
+  InplaceFunction(Fn f) {
+    static_assert(sizeof(Fn) <= Capacity, "callable too large: capture less or raise Capacity");
+    static_assert(alignof(Fn) <= alignof(void *), "callable over-aligned for InplaceFunction");
+    static_assert(std::is_trivially_copyable<Fn>::value && std::is_trivially_destructible<Fn>::value,
+                  "InplaceFunction holds trivially copyable callables only");
+    new (store) Fn(f);
+    invoke = [](void *p, Args... args) -> R { return (*static_cast<Fn *>(p))(args...); };
+  }
+
+  R operator()(Args... args) { return invoke(store, args...); }
+  explicit operator bool() const { return invoke != nullptr; }
+
+private:
+  alignas(void *) unsigned char store[Capacity];
+  R (*invoke)(void *, Args...) = nullptr;
+};
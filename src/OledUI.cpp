@@ -3,6 +3,7 @@
 #include "Utils.h"
 #include "RejoinFSM.h"
 #include "Peers.h"
+#include "Trace.h"
 
 extern RejoinFSM rejoinFSM;
 
@@ -213,8 +214,8 @@ void OledUI::taskUpdate(Radio &radio, PCFInput &pcf, Role role) {
 
       display.setCursor(0, 20);
       {
-        String delta = formatPinDelta(pcf.prev, pcf.pinsState);
-        if (delta.length() > 0) {
+        char delta[PIN_DELTA_LEN];
+        if (formatPinDelta(pcf.prev, pcf.pinsState, delta, sizeof(delta)) > 0) {
           display.print(F("I "));
           display.print(delta);
         }
@@ -223,18 +224,52 @@ void OledUI::taskUpdate(Radio &radio, PCFInput &pcf, Role role) {
       display.setCursor(70, 0);
       display.print(F("ID"));
       display.print(PeerConfig::getNodeAddr());
+
+      if (Trace::hist(LS_TX_EDGE_TO_AIR).count()) {
+        display.setCursor(70, 10);
+        display.print(F("99:"));
+        display.print(Trace::hist(LS_TX_EDGE_TO_AIR).percentile(99) / 1000.0f, 1);
+      }
       break;
 
     case Role::RX:
-      for (int i = 0; i < MAX_TX; i++) {
-        display.setCursor(0, i * 10);
-        display.print(F("TX"));
-        display.print(i + 1);
-        display.print(F(":"));
-        if (peers[i].fsm.link == LinkState::UP) {
-          display.print(peers[i].lastRssi);
-        } else {
-          display.print(F("--"));
+      // Page through active nodes, PEER_ROWS at a time
+      {
+        uint8_t n = peers.activeCount();
+        uint8_t pages = (n + PEER_ROWS - 1) / PEER_ROWS;
+        uint8_t first = pages ? ((millis() / PEER_PAGE_MS) % pages) * PEER_ROWS : 0;
+        for (uint8_t row = 0; row < PEER_ROWS && first + row < n; row++) {
+          const Peer *p = peers.active(first + row);
+          PeerStatus st = p->status.read();  // written by the radio core
+          display.setCursor(0, row * 10);
+          display.print(F("TX"));
+          display.print(p->addr);
+          display.print(F(":"));
+          if (st.link == LinkState::UP) {
+            display.print(st.lastRssi);
+          } else {
+            display.print(F("--"));
+          }
+        }
+        if (n == 0) {
+          display.setCursor(0, 0);
+          display.print(F("No TX"));
+        }
+      }
+
+      // End-to-end input latency (ms): p50 / p99 / max
+      {
+        const LatencyHist &h = Trace::hist(LS_END_TO_END);
+        if (h.count()) {
+          display.setCursor(70, 0);
+          display.print(F("50:"));
+          display.print(h.percentile(50) / 1000.0f, 1);
+          display.setCursor(70, 10);
+          display.print(F("99:"));
+          display.print(h.percentile(99) / 1000.0f, 1);
+          display.setCursor(70, 20);
+          display.print(F("mx:"));
+          display.print(h.maxUs() / 1000.0f, 1);
         }
       }
       break;
@@ -24,6 +24,8 @@ private:
   // Internal state for button handling
   // ────────────────────────────────
   static constexpr uint16_t LONG_PRESS_MS = 2000;
+  static constexpr uint8_t PEER_ROWS = 3;         // RX node rows per page
+  static constexpr uint16_t PEER_PAGE_MS = 2000;  // RX page rotation period
   unsigned long cPressStart = 0;
   bool cHeld = false;
   bool awaitingAck = false;
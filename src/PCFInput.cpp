@@ -1,10 +1,21 @@
 #include "PCFInput.h"
+#include "Scheduler.h"
 #include "Config.h"
 #include "Utils.h"
 #include "OledUI.h"
+#include "Trace.h"
 
 extern OledUI oledUI;  // from main .ino
 
+volatile bool PCFInput::irqPending = false;
+volatile uint32_t PCFInput::irqAt = 0;
+
+// PCF8575 pulls /INT low on any input change and releases it on the next read,
+// so a falling edge means "expander state differs from the last read16()".
+void PCFInput::onInterrupt() {
+  irqAt = micros();
+  irqPending = true;
+}
 
 void PCFInput::begin() {
   if (!pcf.begin()) {
@@ -13,19 +24,64 @@ void PCFInput::begin() {
   }
   pcf.write16(0xFFFF);  // inputs with pullups
   pinsState = prev = pcf.read16();
+
+  if (PCF_INT_PIN >= 0) {
+    pinMode(PCF_INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(PCF_INT_PIN), onInterrupt, FALLING);
+    if (DEBUG_LEVEL & PCF_DEBUG) Serial.println(F("[PCF] /INT edge mode enabled"));
+  }
   if (DEBUG_LEVEL & PCF_DEBUG) Serial.println(F("[PCF] ready"));
 }
 
 
+// Called from loop() on every iteration; costs nothing until /INT fires.
+void PCFInput::service(Radio& radio) {
+#if PCF_BATCH_US  // at 0 readInputs() flushes every edge itself
+  if (batchLen && micros() - batchStartAt >= PCF_BATCH_US) flushBatch(radio);
+#endif
+  if (!irqPending) return;
+  irqPending = false;  // clear before reading so a new edge during the read re-arms
+  uint32_t at = irqAt;
+  Trace::mark(TP_PCF_IRQ, 0, (uint16_t)min<uint32_t>(micros() - at, 0xFFFF));
+  readInputs(radio, at);
+}
 
+uint32_t PCFInput::idleBudget_us(uint32_t now) const {
+  if (irqPending) return 0;
+  if (!batchLen) return IDLE_FOREVER;
+#if PCF_BATCH_US
+  uint32_t open = now - batchStartAt;
+  return open >= PCF_BATCH_US ? 0 : PCF_BATCH_US - open;
+#else
+  (void)now;
+  return 0;
+#endif
+}
 
+// Periodic fallback: catches edges missed while /INT was already low
+// and keeps working when PCF_INT_PIN is not wired.
 void PCFInput::taskPoll(Radio& radio) {
+  readInputs(radio, micros());
+}
+
+void PCFInput::readInputs(Radio& radio, uint32_t edgeAt) {
   uint16_t val = pcf.read16() ^ PCF_INVERT_MASK;
   if (val != pinsState) {
-    Packet pkt = {};
-    pkt.type = PT_PIN;
-    pkt.pins = val;
-    radio.sendPacket(pkt, Role::TX);
+    uint16_t changed = val ^ pinsState;
+    // A pin flipping back would cancel out of the snapshot: close the batch first
+    if (batchLen && ((changed & batchPins) || batchLen + __builtin_popcount(changed) > CF_BATCH_MAX))
+      flushBatch(radio);
+
+    if (batchLen == 0) {
+      Trace::markAt(TP_PCF_EDGE, edgeAt);
+      batchStartAt = edgeAt;
+    }
+    uint8_t at = (uint8_t)min<uint32_t>((edgeAt - batchStartAt) / 100, 255);
+    for (uint8_t pin = 0; pin < BTN_COUNT && batchLen < CF_BATCH_MAX; pin++) {
+      if (changed & (1 << pin))
+        batch[batchLen++] = { (uint8_t)(((val >> pin) & 1 ? CF_DELTA_LEVEL : 0) | pin), at };
+    }
+    batchPins |= changed;
 
     if (DEBUG_LEVEL & PCF_DEBUG) {
       Serial.print(F("[PCF] TX I: "));
@@ -40,5 +96,17 @@ void PCFInput::taskPoll(Radio& radio) {
     pinsState = val;
     prev = val;
     oledUI.markDirty();
+    if (PCF_BATCH_US == 0) flushBatch(radio);
   }
 }
+
+void PCFInput::flushBatch(Radio& radio) {
+  Packet pkt = {};
+  pkt.type = PT_PIN;
+  pkt.pins = pinsState;
+  // rsv carries edge → send latency so the RX can report end-to-end
+  pkt.rsv = pinLatencyRsv(micros() - batchStartAt);
+  radio.sendPinBatch(pkt, batch, batchLen);
+  batchLen = 0;
+  batchPins = 0;
+}
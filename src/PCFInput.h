@@ -13,5 +13,28 @@ public:
   uint16_t prev = 0xFFFF;       // previous snapshot
 
   void begin();
-  void taskPoll(Radio& radio);
+  void taskPoll(Radio& radio);  // periodic fallback read (scheduler)
+  void service(Radio& radio);   // fast path: read only after /INT fired (every loop)
+  uint32_t idleBudget_us(uint32_t now) const;  // until service() has work without a new /INT
+
+private:
+  // ────────────────────────────────
+  // /INT edge flag (set from GPIO ISR)
+  // ────────────────────────────────
+  static volatile bool irqPending;
+  static volatile uint32_t irqAt;  // micros() of the last /INT edge
+  static void onInterrupt();
+
+  void readInputs(Radio& radio, uint32_t edgeAt);
+
+  // ────────────────────────────────
+  // Edge batch (PCF_BATCH_US)
+  // ────────────────────────────────
+  // Transitions since the batch's first edge, each pin at most once, so the
+  // final snapshot still implies every one of them.
+  PinStep batch[CF_BATCH_MAX];
+  uint8_t batchLen = 0;
+  uint16_t batchPins = 0;     // pins already in the batch
+  uint32_t batchStartAt = 0;  // micros() of the first edge
+  void flushBatch(Radio& radio);
 };
@@ -1,5 +1,7 @@
 #pragma once
 #include <Arduino.h>
+#include <stddef.h>
+#include "Config.h"
 
 // ────────────────────────────────
 // Packet Types
@@ -15,28 +17,167 @@ enum PacketType : uint8_t {
   PT_ADVERTISE = 10,       // TX0 → RX: ephemeral advertisement
   PT_ASSIGN_REQUEST = 11,  // TX0 → RX: request permanent node number
   PT_ASSIGN_ACK = 12,      // RX → TX: assignment successful
-  PT_ASSIGN_NACK = 13      // RX → TX: assignment failed
+  PT_ASSIGN_NACK = 13,     // RX → TX: assignment failed
+  PT_PIN_ACK = 14,         // RX → TX: PT_PIN sequence window
+  PT_BEACON = 15           // RX → all TX: TDMA superframe start, slot map, slot ACKs
 };
 
 // ────────────────────────────────
-// Generic 14-byte base packet
+// Generic 20-byte base packet
 // ────────────────────────────────
 struct __attribute__((packed)) Packet {
   uint8_t from;          // sender addr (0 for TX0)
   uint8_t to;            // receiver addr (0xFF for broadcast)
   uint8_t type;          // PacketType
-  uint8_t rsv;           // reserved
+  uint8_t rsv;           // PT_PIN: TX edge → send latency (pinLatencyRsv); PT_HB: HB_RSV_POWER
   uint16_t pins;         // PCF8575 state
   uint32_t seq;          // sequence number
   uint16_t air20;        // last TX airtime (0.1ms units)
   uint16_t airtot;       // rolling 20s airtime total (ms)
   uint16_t fingerprint;  // ephemeral 16-bit unique ID (used by TX0)
+  uint16_t epoch;        // PT_PIN / PT_HB: TX pin-state epoch, bumped on every new snapshot
 };
 
+// PT_PIN rsv: the TX's edge → send latency, in 100 µs steps up to 12.7 ms,
+// then 4 ms steps up to ~520 ms; PIN_RSV_SATURATED means later than that
+#define PIN_RSV_FINE 128      // codes below: 100 µs units
+#define PIN_RSV_COARSE 40     // 100 µs units per code from PIN_RSV_FINE on
+#define PIN_RSV_SATURATED 0xFF
+
+inline uint8_t pinLatencyRsv(uint32_t us) {
+  uint32_t u = us / 100;
+  if (u < PIN_RSV_FINE) return (uint8_t)u;
+  return (uint8_t)min<uint32_t>(PIN_RSV_FINE + (u - PIN_RSV_FINE) / PIN_RSV_COARSE, PIN_RSV_SATURATED);
+}
+
+// 100 µs units, rounded down; PIN_RSV_SATURATED gives the top of the scale
+inline uint16_t pinLatencyFromRsv(uint8_t rsv) {
+  return rsv < PIN_RSV_FINE ? rsv : PIN_RSV_FINE + (rsv - PIN_RSV_FINE) * PIN_RSV_COARSE;
+}
+
+// PT_HB rsv: the TX's power, flagged so that a heartbeat leaving rsv at 0
+// (or any other use of it) is never read as a power level
+#define HB_RSV_POWER 0x80   // bits 6..0 hold dBm + HB_POWER_BIAS
+#define HB_POWER_BIAS 64
+
+inline uint8_t hbPowerRsv(int8_t dbm) {
+  return HB_RSV_POWER | (uint8_t)(constrain(dbm + HB_POWER_BIAS, 0, 0x7F));
+}
+
+// true and *dbm set if rsv carries a power level
+inline bool hbPowerFromRsv(uint8_t rsv, int8_t *dbm) {
+  if (!(rsv & HB_RSV_POWER)) return false;
+  *dbm = (int8_t)((rsv & 0x7F) - HB_POWER_BIAS);
+  return true;
+}
+
+// ────────────────────────────────
+// PT_PIN acknowledgment (RX → TX)
+// ────────────────────────────────
+// Sent for every PT_PIN the RX accepts or recognises. seq is the highest
+// PT_PIN sequence seen from that node, window bit i means seq - 1 - i also
+// arrived, so one ACK covers every frame since the previous one.
+struct __attribute__((packed)) PinAck {
+  uint8_t from;     // RX addr
+  uint8_t to;       // TX node being acknowledged (all TXs share one RH address)
+  uint8_t type;     // PT_PIN_ACK
+  uint8_t formats;  // PT_PIN wire formats the RX decodes (1 << PIN_FORMAT_*)
+  uint32_t seq;     // highest PT_PIN seq received
+  uint32_t window;  // receive bitmap of the 32 seqs before it
+};
+
+// ────────────────────────────────
+// Modem rates (RATE_ADAPT)
+// ────────────────────────────────
+enum LinkRate : uint8_t {
+  RATE_FAST = 0,   // RF69_MODEM_CONFIG
+  RATE_ROBUST = 1  // RATE_ROBUST_CONFIG
+};
+
+// ────────────────────────────────
+// TDMA beacon (RX → all TX)
+// ────────────────────────────────
+// Its end (PacketSent at the RX, PayloadReady at a TX) starts a superframe:
+// one slot per bit set in slotMap, in node address order, then the
+// contention period. With n slot owners, acks[i] (i < n) is the low byte of
+// the newest PT_PIN seq the RX accepted from the i-th, so in-slot frames need
+// no PT_PIN_ACK. When the frame has room, acks[n + i] follows as an int8_t:
+// what the i-th owner's newest frame of the superframe before measured at the
+// RX (0 = none heard), which drives its TX power (TPC_ENABLE).
+// robustMap gives each slot's rate for this superframe only, so both ends of
+// a link change rate together, at the superframe whose beacon announces it.
+// Beacons and contention traffic use the basic rate, which every TX must
+// know before the beacon arrives; changes to it are announced several
+// superframes ahead and take effect at superframe basicAt.
+struct __attribute__((packed)) Beacon {
+  uint8_t from;              // RX addr
+  uint8_t to;                // 0xFF
+  uint8_t type;              // PT_BEACON
+  uint8_t formats;           // as PinAck::formats
+  uint16_t seq;              // superframe number
+  uint16_t hopMask;          // channels hopped over from the next superframe on (HOP_ENABLE)
+  uint32_t prevInterval_us;  // RX clock between the two previous beacons (0 = unknown)
+  uint32_t slotMap;          // bit addr - 1: node addr owns a slot
+  uint32_t robustMap;        // bit addr - 1: that slot runs at RATE_ROBUST (RATE_ADAPT)
+  uint8_t basic;             // LinkRate of this beacon and contention (bits 0-3), from basicAt on (bits 4-7)
+  uint8_t basicAt;           // low byte of that superframe's seq
+  uint8_t acks[2 * MAX_TX];  // n ACKs, then n RSSI reports if they fit
+};
+static const uint8_t BEACON_HEADER_LEN = offsetof(Beacon, acks);
+static_assert(MAX_TX <= 32, "Beacon::slotMap holds one bit per node address");
+static_assert(HOP_CHANNELS <= 16, "Beacon::hopMask holds one bit per channel");
+
+// ────────────────────────────────
+// Compact PT_PIN (RX-negotiated)
+// ────────────────────────────────
+// PT_PIN without the telemetry that only heartbeats need: 6-7 bytes instead of
+// 20, so RH header + frame fit one 16-byte AES block (half the airtime).
+// The first byte tells the families apart: a Packet starts with a node address
+// (< 0x80), a compact frame with CF_FAMILY set. seq / epoch are the low bytes of
+// the TX's 32-bit PT_PIN seq and 16-bit epoch; the RX widens them against the
+// last values it holds for that node. The TX starts every boot in the legacy
+// format, so the RX always learns the full values before the first compact frame.
+enum PinFormat : uint8_t {
+  PIN_FORMAT_LEGACY = 0,   // Packet
+  PIN_FORMAT_COMPACT = 1   // CompactPin, version 1
+};
+
+#define CF_FAMILY 0x80        // compact frame (legacy frames start with a node address)
+#define CF_VERSION_MASK 0x60
+#define CF_VERSION_1 0x20
+#define CF_DELTA 0x10         // data = changed pins, else the full uint16 snapshot
+#define CF_KIND_MASK 0x0F
+#define CF_KIND_PIN 0x01
+#define CF_KIND_PIN_BATCH 0x02  // data = uint16 snapshot + PinStep list (first copy of a batch)
+
+// Delta entry: bit 7 = new level, bits 3..0 = pin. Applies only on top of epoch - 1.
+#define CF_DELTA_LEVEL 0x80
+#define CF_DELTA_PIN 0x0F
+
+// One transition of a coalesced edge batch, replayed by the RX at the same offset
+#define CF_BATCH_MAX 7
+struct __attribute__((packed)) PinStep {
+  uint8_t pin;  // CF_DELTA_LEVEL | pin index, as a delta entry
+  uint8_t at;   // 100 µs units after the batch's first edge
+};
+
+struct __attribute__((packed)) CompactPin {
+  uint8_t typeFlags;  // CF_FAMILY | CF_VERSION_1 | [CF_DELTA] | CF_KIND_*
+  uint8_t from;       // sender addr
+  uint8_t seq;        // low byte of the PT_PIN seq
+  uint8_t epoch;      // low byte of the pin-state epoch
+  uint8_t rsv;        // TX edge → send latency (pinLatencyRsv)
+  uint8_t data[2 + 2 * CF_BATCH_MAX];  // snapshot [+ PinSteps], or one byte per changed pin (delta)
+};
+static const uint8_t CPIN_HEADER_LEN = offsetof(CompactPin, data);
+
 // ────────────────────────────────
 // Assignment Request (TX → RX)
 // ────────────────────────────────
 struct __attribute__((packed)) AssignRequest {
+  uint8_t from;          // 0 (TX0)
+  uint8_t to;            // 0xFF
+  uint8_t type;          // PT_ASSIGN_REQUEST
   uint16_t fingerprint;  // matches TX ephemeral ID
   uint8_t requested_id;  // requested TX node number
   char node_name[16];    // optional name (may be empty)
@@ -46,6 +187,9 @@ struct __attribute__((packed)) AssignRequest {
 // Assignment Acknowledgment (RX → TX)
 // ────────────────────────────────
 struct __attribute__((packed)) AssignAck {
+  uint8_t from;          // RX addr
+  uint8_t to;            // 0 (TX0)
+  uint8_t type;          // PT_ASSIGN_ACK
   uint16_t fingerprint;  // echoes TX ephemeral ID
   uint8_t assigned_id;   // assigned TX number
   char node_name[16];    // confirmed name
@@ -63,6 +207,9 @@ enum AssignError : uint8_t {
 };
 
 struct __attribute__((packed)) AssignNack {
+  uint8_t from;
+  uint8_t to;
+  uint8_t type;    // PT_ASSIGN_NACK
   uint16_t fingerprint;
   uint8_t reason;  // AssignError code
 };
@@ -79,3 +226,25 @@ inline const __FlashStringHelper* getAssignErrorMsg(uint8_t code) {
     default: return F("General error");
   }
 }
+
+// ────────────────────────────────
+// Wire sizes (receive dispatch)
+// ────────────────────────────────
+// Shortest valid frame of each message, and the longest it can be; the
+// variable-length ones differ. Radio's dispatch table drops frames shorter
+// than min and checks max against RH_RF69_MAX_MESSAGE_LEN at compile time.
+template <typename T>
+struct WireSize {
+  static const uint8_t min = sizeof(T);
+  static const uint8_t max = sizeof(T);
+};
+template <>
+struct WireSize<Beacon> {
+  static const uint8_t min = BEACON_HEADER_LEN;
+  static const uint8_t max = BEACON_HEADER_LEN + MAX_TX;  // the RSSI reports only go in if they fit
+};
+template <>
+struct WireSize<CompactPin> {
+  static const uint8_t min = CPIN_HEADER_LEN + 1;
+  static const uint8_t max = sizeof(CompactPin);
+};
@@ -1,8 +1,54 @@
 //Peers.cpp
 #include "Peers.h"
 #include "Config.h"
+#include "DebugSerial.h"
 
-Peer peers[MAX_TX];  // existing global, unchanged
+PeerTable peers;
+
+Peer *PeerTable::acquire(uint8_t addr) {
+  if (addr < 1 || addr > MAX_TX) return nullptr;
+  if (Peer *p = byAddr[addr].load(std::memory_order_relaxed)) return p;
+
+  uint8_t n = count.load(std::memory_order_relaxed);
+  Peer *p = &pool[n];  // n < MAX_TX: every address takes at most one
+  p->addr = addr;
+  p->map = hidMapFor(addr);
+  list[n] = p;
+  count.store(n + 1, std::memory_order_release);  // publish after the slot is filled
+  byAddr[addr].store(p, std::memory_order_release);
+
+  if (DEBUG_LEVEL & ROLE_DEBUG)
+    DebugSerial.printf("[PEERS] node %d active (%d total)\n", addr, n + 1);
+  return p;
+}
+
+// TXs start their PT_PIN sequence at a random value on every boot, so a jump
+// of more than the window in either direction is a restart, not reordering.
+PinSeqResult Peer::notePinSeq(uint32_t seq) {
+  int32_t d = (int32_t)(seq - pinSeq);
+  if (!pinSeqValid || d > 0 || d < -32) {
+    if (pinSeqValid && d > 0 && d <= 32) {
+      pinWindow = d == 32 ? 1u << 31 : (pinWindow << d) | (1u << (d - 1));
+    } else {
+      pinWindow = 0;
+    }
+    pinSeq = seq;
+    pinSeqValid = true;
+    return PIN_SEQ_NEW;
+  }
+  if (d == 0) return PIN_SEQ_DUP;
+
+  uint32_t bit = 1u << (-d - 1);
+  if (pinWindow & bit) return PIN_SEQ_DUP;
+  pinWindow |= bit;
+  return PIN_SEQ_STALE;
+}
+
+// Heartbeats may trail the newest PT_PIN; a big backwards jump is a TX restart.
+bool Peer::isCurrentEpoch(uint16_t epoch) const {
+  int16_t d = (int16_t)(epoch - pinEpoch);
+  return !pinEpochValid || d >= 0 || d < -1024;
+}
 
 NodeConfig PeerConfig::self;
 
@@ -17,17 +63,17 @@ void PeerConfig::begin(Role role) {
     self.node_name = DEFAULT_NODE_NAME;
 
     if (DEBUG_LEVEL & ROLE_DEBUG) {
-      Serial.println(F("[PEERCFG] config.json missing, using defaults"));
+      DebugSerial.println(F("[PEERCFG] config.json missing, using defaults"));
     }
   }
 
   if (DEBUG_LEVEL & ROLE_DEBUG) {
-    Serial.print(F("[PEERCFG] role="));
-    Serial.print(role == Role::TX ? "TX" : "RX");
-    Serial.print(F(" addr="));
-    Serial.print(self.node_addr);
-    Serial.print(F(" name="));
-    Serial.println(self.node_name);
+    DebugSerial.print(F("[PEERCFG] role="));
+    DebugSerial.print(role == Role::TX ? "TX" : "RX");
+    DebugSerial.print(F(" addr="));
+    DebugSerial.print(self.node_addr);
+    DebugSerial.print(F(" name="));
+    DebugSerial.println(self.node_name);
   }
 }
 
@@ -45,14 +91,14 @@ void PeerConfig::setNode(uint8_t addr, const String &name) {
 
   if (!Storage::saveConfig(self)) {
     if (DEBUG_LEVEL & ROLE_DEBUG) {
-      Serial.println(F("[PEERCFG] save failed"));
+      DebugSerial.println(F("[PEERCFG] save failed"));
     }
   } else {
     if (DEBUG_LEVEL & ROLE_DEBUG) {
-      Serial.print(F("[PEERCFG] node saved: addr="));
-      Serial.print(addr);
-      Serial.print(F(" name="));
-      Serial.println(name);
+      DebugSerial.print(F("[PEERCFG] node saved: addr="));
+      DebugSerial.print(addr);
+      DebugSerial.print(F(" name="));
+      DebugSerial.println(name);
     }
   }
 }
@@ -65,11 +111,11 @@ void PeerConfig::setNode(uint8_t addr, const String &name) {
 void PeerConfig::save() {
   if (!Storage::saveConfig(self)) {
     if (DEBUG_LEVEL & ROLE_DEBUG) {
-      Serial.println(F("[PEERCFG] manual save failed"));
+      DebugSerial.println(F("[PEERCFG] manual save failed"));
     }
   } else {
     if (DEBUG_LEVEL & ROLE_DEBUG) {
-      Serial.println(F("[PEERCFG] manual save OK"));
+      DebugSerial.println(F("[PEERCFG] manual save OK"));
     }
   }
 }
@@ -83,8 +129,8 @@ void PeerConfig::nextNode() {
   String newName = String("TX") + String(newAddr);
 
   if (DEBUG_LEVEL & ROLE_DEBUG) {
-    Serial.print(F("[PEERCFG] cycling to next node: "));
-    Serial.println(newName);
+    DebugSerial.print(F("[PEERCFG] cycling to next node: "));
+    DebugSerial.println(newName);
   }
 
   setNode(newAddr, newName);
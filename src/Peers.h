@@ -1,16 +1,101 @@
 #pragma once
+#include <atomic>
 #include "RejoinFSM.h"
+#include "Seqlock.h"
 #include "Storage.h"
 #include "Config.h"
 
-// Existing peer connection state
+// Verdict of the PT_PIN sequence window
+enum PinSeqResult : uint8_t {
+  PIN_SEQ_NEW,    // newest state from this node: apply it
+  PIN_SEQ_STALE,  // older than a state already applied: ACK, never replay
+  PIN_SEQ_DUP     // seen before
+};
+
+// What the UI/HID core reads of a peer: copied out whole through Peer::status
+struct PeerStatus {
+  uint32_t lastSeen = 0;
+  int8_t lastRssi = 0;
+  LinkState link = LinkState::DOWN;
+  uint8_t rate = 0;  // RATE_FAST
+};
+
+// ────────────────────────────────
+// Per-node RX state (taken from a static pool on first contact)
+// ────────────────────────────────
+// With RADIO_ON_CORE1 the radio core owns every field except hid[], which
+// only the HID core touches, and map, fixed before the peer is published.
+// Pin changes cross over as PinEvents; everything else the other core shows
+// comes from status, which the radio core refreshes with publish().
 struct Peer {
+  uint8_t addr = 0;                 // TX node address (1..MAX_TX)
   RejoinFSM fsm;
-  int8_t lastRssi;
+  int8_t lastRssi = 0;
+  uint16_t prevPins = 0xFFFF;       // last pin snapshot turned into HID events
+  const HidBinding *map = nullptr;  // shared layout from hidLayouts, never copied
+  HidRuntime hid[BTN_COUNT] = {};   // press/repeat state per pin
+
+  // PT_PIN sequence window (dedup + ACK bitmap)
+  uint32_t pinSeq = 0;      // highest PT_PIN seq received
+  uint32_t pinWindow = 0;   // bit i: pinSeq - 1 - i received
+  bool pinSeqValid = false;
+  uint32_t pinAckSeq = 0;   // newest seq ACKed (repeated in the TDMA beacon)
+  PinSeqResult notePinSeq(uint32_t seq);
+
+  // Epoch of the pin state in prevPins (heartbeat reconciliation)
+  uint16_t pinEpoch = 0;
+  bool pinEpochValid = false;
+  bool isCurrentEpoch(uint16_t epoch) const;  // not older than the applied state
+
+  // Uplink rate (RATE_ADAPT): its TDMA slot's LinkRate and the link behind it
+  uint8_t rate = 0;          // RATE_FAST
+  int16_t rssiAvg = 0;       // smoothed over every frame received (0 = none yet)
+  uint16_t rateFrames = 0;   // PT_PIN frames received in this window
+  uint16_t rateLost = 0;     // and seqs skipped
+  uint32_t rateAt = 0;       // millis() of the last step
+  int8_t sfRssi = 0;         // its newest frame this superframe, for the next beacon (0 = none)
+  int8_t txPower = RF69_TX_POWER;  // dBm, from its heartbeats (TPC_ENABLE)
+  bool downRobust = false;   // our beacons reach it only at the robust rate
+
+  // Assignment registry
+  uint16_t fingerprint = 0;  // the name it was given is in /nodes/TX<n>.json
+  bool assigned = false;
+  uint32_t lastSeen = 0;
+
+  Seqlock<PeerStatus> status;
+  void publish() { status.write({ lastSeen, lastRssi, fsm.link, rate }); }
+};
+
+// ────────────────────────────────
+// Sparse peer table: O(1) lookup by address, dense list of active nodes
+// ────────────────────────────────
+// Entries are appended by the radio path and never freed, so the HID/UI
+// core can iterate active(0..activeCount()-1) without locking. They come
+// from a fixed pool, so a node's first frame never touches the heap. The
+// pool costs MAX_TX x sizeof(Peer) of .bss whether or not the nodes show
+// up: ~328 B each on the RP2040 (hid[] press state is 256 of them), ~10.5 KB
+// at MAX_TX 32, 4% of SRAM. The linker accounts for it at build time, where
+// allocating on contact could fail or fragment mid-session; lower MAX_TX to
+// reclaim it.
+class PeerTable {
+public:
+  Peer *find(uint8_t addr) const {
+    return (addr >= 1 && addr <= MAX_TX) ? byAddr[addr].load(std::memory_order_acquire) : nullptr;
+  }
+  Peer *acquire(uint8_t addr);  // find, or allocate on first contact
+
+  uint8_t activeCount() const { return count.load(std::memory_order_acquire); }
+  Peer *active(uint8_t i) const { return list[i]; }
+
+private:
+  Peer pool[MAX_TX];  // pool[i] is list[i]
+  std::atomic<Peer *> byAddr[MAX_TX + 1] = {};
+  Peer *list[MAX_TX] = {};
+  std::atomic<uint8_t> count{ 0 };
 };
 
 // Global peer table (for link tracking)
-extern Peer peers[MAX_TX];
+extern PeerTable peers;
 
 // Local node identity/config
 namespace PeerConfig {
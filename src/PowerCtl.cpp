@@ -0,0 +1,99 @@
+#include "PowerCtl.h"
+#include "DebugSerial.h"
+
+static_assert(!TPC_ENABLE || TDMA_ENABLE, "RSSI reports ride in the TDMA beacon");
+
+// ────────────────────────────────
+// RX
+// ────────────────────────────────
+// Links silent for RATE_SILENT_MS don't count
+bool PowerCtl::live(const Peer &peer) {
+  return peer.rssiAvg && millis() - peer.lastSeen < RATE_SILENT_MS;
+}
+
+// The path loss is its power less its RSSI
+int16_t PowerCtl::beaconNeed(const Peer &peer) {
+  return TPC_TARGET_DBM + peer.txPower - peer.rssiAvg;
+}
+
+void PowerCtl::reach(int16_t need) {
+  if (need > txPower || need < txPower - TPC_HYST_DB) tpcWant = constrain(need, TPC_MIN_DBM, TPC_MAX_DBM);
+}
+
+// ────────────────────────────────
+// TX
+// ────────────────────────────────
+// The beacon opening superframe seq reports on our slot frame of the one
+// before. A frame can go missing on a good link, so only TPC_MISSES in a row
+// count as fading; RSSI from frames sent before the last change is stale.
+// After toMax() there is no settled link to wait on or back off gently from.
+void PowerCtl::noteReport(uint16_t seq, int8_t rssi) {
+  if (!tpcSlotSent || tpcSlotSf != (uint16_t)(seq - 1)) return;
+  tpcSlotSent = false;
+  tpcRssi = rssi;
+  tpcMisses = rssi == 0 ? tpcMisses + 1 : 0;
+  if (!tpcBlind && millis() - tpcAt < TPC_STEP_MS) return;
+
+  if (tpcMisses >= TPC_MISSES) {
+    tpcWant = txPower + TPC_STEP_UP_DB;
+    tpcMisses = 0;
+  } else if (rssi == 0 || (int16_t)(tpcSlotSf - tpcChangedSf) <= 0) {
+    return;
+  } else if (rssi < TPC_TARGET_DBM - TPC_HYST_DB) {
+    tpcWant = txPower + min(TPC_TARGET_DBM - rssi, TPC_STEP_UP_DB);
+  } else if (rssi > TPC_TARGET_DBM + TPC_HYST_DB) {
+    tpcWant = txPower - (tpcBlind ? rssi - TPC_TARGET_DBM : min(rssi - TPC_TARGET_DBM, TPC_STEP_DOWN_DB));
+  }
+  tpcBlind = false;
+}
+
+// Until that first report, each beacon sizes us, taken as sent at TPC_MAX_DBM:
+// the RX is never louder, so the path loss it gives errs on the loud side
+void PowerCtl::noteBeacon(int8_t rssi) {
+  if (tpcBlind && rssi) tpcWant = TPC_TARGET_DBM + TPC_MAX_DBM - rssi;
+}
+
+void PowerCtl::noteSlotFrame(uint16_t sf) {
+  tpcSlotSf = sf;
+  tpcSlotSent = true;
+}
+
+// Unslotted, a TX gets no reports
+void PowerCtl::noteRetry() {
+  if (millis() - tpcAt >= TPC_STEP_MS) tpcWant = txPower + TPC_STEP_UP_DB;
+}
+
+// ────────────────────────────────
+// Both roles
+// ────────────────────────────────
+void PowerCtl::service(uint16_t sf, Role role) {
+  int8_t dbm = constrain(tpcWant, TPC_MIN_DBM, TPC_MAX_DBM);
+  tpcWant = dbm;
+  if (dbm == txPower) return;
+  if (DEBUG_LEVEL & RADIO_DEBUG) {
+    DebugSerial.printf("[TPC] %d -> %d dBm", txPower, dbm);
+    if (role == Role::TX) DebugSerial.printf(" (rssi@rx=%d)", tpcRssi);
+    DebugSerial.println();
+  }
+  if (dbm > txPower)
+    tpcUps++;
+  else
+    tpcDowns++;
+  rf.setTxPower(dbm, RF69_IS_HCW);
+  txPower = dbm;
+  tpcAt = millis();
+  tpcChangedSf = sf;
+}
+
+void PowerCtl::noteSent() {
+  tpcPowerSum += txPower;
+  tpcFrames++;
+}
+
+void PowerCtl::report(Print &out, Role role) const {
+  if (!TPC_ENABLE) return;
+  out.printf("[TPC] power=%ddBm", txPower);
+  if (role == Role::TX) out.printf(" rssi@rx=%d", tpcRssi);
+  out.printf(" target=%d ups=%lu downs=%lu avg=%.1fdBm/frame\n", TPC_TARGET_DBM, (unsigned long)tpcUps,
+             (unsigned long)tpcDowns, tpcFrames ? (float)tpcPowerSum / tpcFrames : (float)txPower);
+}
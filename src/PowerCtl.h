@@ -0,0 +1,54 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "Peers.h"
+#include "RadioDriver.h"
+
+// ────────────────────────────────
+// Transmit power
+// ────────────────────────────────
+// The RX sizes its power to the weakest live link and reports each slot
+// owner's RSSI in the beacon; a TX steps its own towards TPC_TARGET_DBM at
+// the RX on those reports. Changes are applied between frames by service().
+class PowerCtl {
+public:
+  explicit PowerCtl(RadioDriver &rf) : rf(rf) {}
+
+  int8_t dbm() const { return txPower; }     // as last set
+  int8_t wanted() const { return tpcWant; }  // as service() will set it
+
+  // ───── RX ─────
+  static bool live(const Peer &peer);           // heard recently enough to size the beacon to
+  static int16_t beaconNeed(const Peer &peer);  // for the beacon to reach a live peer at TPC_TARGET_DBM
+  void reach(int16_t need);                     // the most any slot owner needs
+
+  // ───── TX ─────
+  void noteReport(uint16_t seq, int8_t rssi);   // the beacon opening superframe seq reports rssi
+  void noteBeacon(int8_t rssi);                 // a beacon arrived at rssi
+  void noteSlotFrame(uint16_t sf);              // a slot frame left in superframe sf
+  void noteRetry();                             // unslotted: a PT_PIN needed a retry
+  void toMax() {  // at boot, and on a lost beacon (TX) or no live link (RX)
+    tpcWant = TPC_MAX_DBM;
+    tpcBlind = true;
+  }
+
+  void service(uint16_t sf, Role role);  // applies the wanted power between frames
+  void noteSent();                       // a frame left at the current power
+  void report(Print &out, Role role) const;
+
+private:
+  RadioDriver &rf;
+  int8_t txPower = RF69_TX_POWER;  // dBm, as last set
+  int8_t tpcWant = RF69_TX_POWER;  // applied by service() between frames
+  int8_t tpcRssi = 0;              // TX: last report from the RX (0 = frame not heard)
+  uint8_t tpcMisses = 0;           // TX: slot frames in a row the RX didn't hear
+  bool tpcBlind = false;           // TX: no report since toMax(); the next one backs off in one go
+  uint16_t tpcSlotSf = 0;          // TX: superframe of our newest slot frame
+  bool tpcSlotSent = false;
+  uint16_t tpcChangedSf = 0;       // TX: superframe of the last change
+  uint32_t tpcAt = 0;              // millis() of the last change
+  uint32_t tpcUps = 0;
+  uint32_t tpcDowns = 0;
+  int32_t tpcPowerSum = 0;         // dBm summed over frames sent, for the average
+  uint32_t tpcFrames = 0;
+};
@@ -1,10 +1,13 @@
 #include "Radio.h"
+#include "Scheduler.h"
 #include "Utils.h"
 #include "Config.h"
 #include "Hid.h"
 #include "Peers.h"
 #include "Storage.h"
 #include "OledUI.h"
+#include "Trace.h"
+#include "DebugSerial.h"
 
 // ────────────────────────────────
 // Initialize radio
@@ -19,7 +22,7 @@ void Radio::begin(Role role) {
   delay(10);
 
   if (!rf69.init()) {
-    if (DEBUG_LEVEL & RADIO_DEBUG) Serial.println(F("[RADIO] init failed"));
+    if (DEBUG_LEVEL & RADIO_DEBUG) DebugSerial.println(F("[RADIO] init failed"));
     while (1);
   }
 
@@ -32,25 +35,40 @@ void Radio::begin(Role role) {
 
   if (!rf69.setModemConfig(RF69_MODEM_CONFIG)) {
     if (DEBUG_LEVEL & RADIO_DEBUG)
-      Serial.println(F("[RADIO] setModemConfig failed, using default"));
+      DebugSerial.println(F("[RADIO] setModemConfig failed, using default"));
   }
 
   if (DEBUG_LEVEL & RADIO_DEBUG) {
-    Serial.print(F("[RADIO] init OK @ "));
-    Serial.print(RF69_FREQ_MHZ);
-    Serial.print(F(" MHz, bitrate="));
-    Serial.print(RF69_BITRATE_KBPS);
-    Serial.println(F(" kbps"));
+    DebugSerial.print(F("[RADIO] init OK @ "));
+    DebugSerial.print(RF69_FREQ_MHZ);
+    DebugSerial.print(F(" MHz, bitrate="));
+    DebugSerial.print(RF69_BITRATE_KBPS);
+    DebugSerial.print(F(" kbps"));
+    if (RATE_ADAPT) DebugSerial.printf(", robust %lu bps", (unsigned long)RATE_ROBUST_BPS);
+    DebugSerial.println();
   }
 
+  this->role = role;
+  tdma.begin(micros());
+  if (HOP_ENABLE) hop.begin(role);
+  // Nothing sized yet, in either direction: start loud and let TPC step down
+  if (TPC_ENABLE) powerCtl.toMax();
+
   // ───── TX startup mode ─────
   if (role == Role::TX) {
+    randomSeed(analogRead(0));
+    // Fresh PT_PIN sequence space per boot; the RX reads a jump as a restart
+    pinSeq = (uint32_t)random(0x7FFFFFFF);
+    pinAckedSeq = pinSeq - 1;
+    pinEpoch = (uint16_t)random(0x10000);
+    pinLatest.type = PT_PIN;
+    pinLatest.pins = 0xFFFF;  // matches the RX's initial snapshot until the first edge
+
     if (PeerConfig::getNodeAddr() == 0) {
       txMode = TX_MODE_EPHEMERAL;
-      randomSeed(analogRead(0));
       txFingerprint = random(1, 65535);
       if (DEBUG_LEVEL & RADIO_DEBUG)
-        Serial.printf("[TX0] Ephemeral fingerprint 0x%04X\n", txFingerprint);
+        DebugSerial.printf("[TX0] Ephemeral fingerprint 0x%04X\n", txFingerprint);
     } else {
       txMode = TX_MODE_ASSIGNED;
     }
@@ -61,16 +79,26 @@ void Radio::begin(Role role) {
 // Unified periodic task
 // ────────────────────────────────
 void Radio::task(Role role) {
-  if (role == Role::TX)
+  serviceGovernor();
+  serviceTx();
+  if (role == Role::TX) {
     taskTx(role);
-  else
-    taskRx(role);
+  } else {
+    finishAssignments();
+    taskRx();
+  }
 }
 
 // ────────────────────────────────
 // TX Task
 // ────────────────────────────────
 void Radio::taskTx(Role role) {
+  if (tdma.syncLost()) {
+    takeHeldPins();  // unslotted, the newest state goes out right away
+    rateCtl.startSearch(tdma.seq() + 1);
+    if (TPC_ENABLE) powerCtl.toMax();
+  }
+
   switch (txMode) {
     case TX_MODE_EPHEMERAL: {
       if (millis() - lastAdvertise > 2000) {
@@ -83,7 +111,7 @@ void Radio::taskTx(Role role) {
         lastAdvertise = millis();
 
         if (DEBUG_LEVEL & RADIO_DEBUG)
-          Serial.printf("[TX0] ADVERTISE (fp=0x%04X)\n", txFingerprint);
+          DebugSerial.printf("[TX0] ADVERTISE (fp=0x%04X)\n", txFingerprint);
       }
       break;
     }
@@ -91,136 +119,407 @@ void Radio::taskTx(Role role) {
     case TX_MODE_ASSIGN_REQ: {
       if (!awaitingAssignResponse) {
         AssignRequest req = {};
+        req.to = 0xFF;
+        req.type = PT_ASSIGN_REQUEST;
         req.fingerprint = txFingerprint;
         req.requested_id = requestedId;
         strncpy(req.node_name, PeerConfig::getNodeName().c_str(), sizeof(req.node_name) - 1);
-        rf69.send((uint8_t*)&req, sizeof(req));
+        sendRaw(&req, sizeof(req), PT_ASSIGN_REQUEST);
         assignRequestSentAt = millis();
         awaitingAssignResponse = true;
 
         if (DEBUG_LEVEL & RADIO_DEBUG)
-          Serial.printf("[TX0] Sent ASSIGN_REQ #%d\n", requestedId);
+          DebugSerial.printf("[TX0] Sent ASSIGN_REQ #%d\n", requestedId);
       }
 
       if (awaitingAssignResponse && millis() - assignRequestSentAt > 1000) {
         awaitingAssignResponse = false;
         txMode = TX_MODE_EPHEMERAL;
 
-        Serial.printf("[TX0] Assignment #%d Denied (timeout)\n", requestedId);
+        DebugSerial.printf("[TX0] Assignment #%d Denied (timeout)\n", requestedId);
         OledUI::showMessage(String("Assign ") + String(requestedId) + " Denied");
-        Storage::logError(ERR_ASSIGN_DENIED);
+        Storage::logError(ERR_ASSIGN_DENIED, requestedId);
       }
       break;
     }
 
     case TX_MODE_ASSIGNED: {
       // Normal PT_PIN transmission handled elsewhere (via pin poller)
+      servicePinRetransmit(role);
+      serviceHello(role);
+      if (hbPending && (int32_t)(millis() - hbDueAt) >= 0) {
+        Packet pkt = {};
+        pkt.type = PT_HB;
+        sendPacket(pkt, role);  // pins + epoch are stamped in transmitPacket
+        hbPending = false;
+      }
       break;
     }
   }
 
-  // RX processing (ACK/NACK reception)
-  if (rf69.available()) {
-    uint8_t buf[64];
-    uint8_t len = sizeof(buf);
-    if (!rf69.recv(buf, &len)) return;
-    uint8_t type = buf[2];
+  receiveTx();
+}
 
-    if (type == PT_ASSIGN_ACK && txMode == TX_MODE_ASSIGN_REQ) {
-      AssignAck* ack = (AssignAck*)buf;
-      if (ack->fingerprint == txFingerprint) {
-        PeerConfig::setNode(ack->assigned_id, String(ack->node_name));
-        OledUI::showMessage("Assigned TX#" + String(ack->assigned_id));
-        txMode = TX_MODE_ASSIGNED;
-        awaitingAssignResponse = false;
-        if (DEBUG_LEVEL & RADIO_DEBUG)
-          Serial.printf("[TX] Assigned TX#%d (%s)\n", ack->assigned_id, ack->node_name);
-      }
-    } else if (type == PT_ASSIGN_NACK && txMode == TX_MODE_ASSIGN_REQ) {
-      AssignNack* nack = (AssignNack*)buf;
-      if (nack->fingerprint == txFingerprint) {
-        const __FlashStringHelper* msg = getAssignErrorMsg(nack->reason);
-        Serial.printf("[TX0] Assignment #%d Denied (%s)\n", requestedId, (const char*)msg);
-        OledUI::showMessage("Denied: " + String((const char*)msg));
-        Storage::logError(ERR_ASSIGN_DENIED);
-        txMode = TX_MODE_EPHEMERAL;
-        awaitingAssignResponse = false;
-      }
+// RX processing (ACK/NACK/beacon reception); also polled from serviceTx so a
+// beacon is taken before the first slot after it starts
+void Radio::receiveTx() {
+  static const RxRoute routes[] = {
+    route<AssignAck, &Radio::onAssignAck>(PT_ASSIGN_ACK),
+    route<AssignNack, &Radio::onAssignNack>(PT_ASSIGN_NACK),
+    route<PinAck, &Radio::onPinAck>(PT_PIN_ACK),
+    route<Beacon, &Radio::handleBeacon>(PT_BEACON),
+  };
+  RxView frame;
+  if (!rf69.peekRx(frame)) return;
+  rxLatency.add(micros() - rf69.lastRxAt_us());
+  rateCtl.holdSearch();
+  dispatch(routes, frame);
+  rf69.releaseRx();
+}
+
+// Frames too short for their type are dropped rather than read past their end
+template <size_t N>
+void Radio::dispatch(const RxRoute (&routes)[N], const RxView &frame) {
+  if (frame.len < 3) return;
+  for (const RxRoute &r : routes) {
+    if (r.type != frame.data[2]) continue;
+    if (frame.len < r.minLen) {
+      rxRunts++;
+      return;
     }
+    r.handle(*this, frame);
+    return;
   }
 }
 
+void Radio::onAssignAck(const AssignAck &ack, uint8_t) {
+  if (txMode != TX_MODE_ASSIGN_REQ || ack.fingerprint != txFingerprint) return;
+  PeerConfig::setNode(ack.assigned_id, String(ack.node_name));
+  OledUI::showMessage("Assigned TX#" + String(ack.assigned_id));
+  txMode = TX_MODE_ASSIGNED;
+  awaitingAssignResponse = false;
+  if (DEBUG_LEVEL & RADIO_DEBUG)
+    DebugSerial.printf("[TX] Assigned TX#%d (%s)\n", ack.assigned_id, ack.node_name);
+}
+
+void Radio::onAssignNack(const AssignNack &nack, uint8_t) {
+  if (txMode != TX_MODE_ASSIGN_REQ || nack.fingerprint != txFingerprint) return;
+  const __FlashStringHelper* msg = getAssignErrorMsg(nack.reason);
+  DebugSerial.printf("[TX0] Assignment #%d Denied (%s)\n", requestedId, (const char*)msg);
+  OledUI::showMessage("Denied: " + String((const char*)msg));
+  Storage::logError(ERR_ASSIGN_DENIED, requestedId);
+  txMode = TX_MODE_EPHEMERAL;
+  awaitingAssignResponse = false;
+}
+
+void Radio::onPinAck(const PinAck &ack, uint8_t) {
+  if (txMode == TX_MODE_ASSIGNED && ack.to == PeerConfig::getNodeAddr()) handlePinAck(ack);
+}
+
+// ────────────────────────────────
+// PT_PIN retransmit (TX)
+// ────────────────────────────────
+// Only the newest snapshot is ever re-sent, with a fresh seq, so the RX can
+// tell it apart from a duplicate and never sees an older state after a newer one.
+// The optional refresh burst sends the same snapshot on a fixed schedule after
+// each edge without waiting for the ACK timeout; both stop once an ACK covers it.
+void Radio::servicePinRetransmit(Role role) {
+  if (!pinUnacked || tdma.slotted()) return;  // slotted: serviceSlot re-sends once per superframe
+  bool refresh = pinRefreshLeft > 0 && (int32_t)(millis() - pinRefreshAt) >= 0;
+  if (!refresh && (int32_t)(millis() - pinRetryAt) < 0) return;
+
+  if (!refresh && pinRetries >= PIN_RETRY_MAX) {
+    pinUnacked = false;
+    pinGiveUps++;
+    if (DEBUG_LEVEL & RADIO_DEBUG) DebugSerial.println(F("[RADIO] PT_PIN unacknowledged, giving up"));
+    return;
+  }
+
+  Packet pkt = pinLatest;
+  pkt.rsv = pinLatencyRsv(micros() - pinEdgeAt_us);
+  if (refresh) {
+    pinRefreshLeft--;
+    pinRefreshAt = millis() + PIN_REFRESH_DELTA_MS;
+    pinRefreshes++;
+  } else {
+    pinRetries++;
+    pinRetransmits++;
+  }
+  transmitPacket(pkt, role);
+
+  if (DEBUG_LEVEL & RADIO_DEBUG)
+    DebugSerial.printf("[RADIO] PT_PIN %s #%d seq=%lu\n", refresh ? "refresh" : "retransmit",
+                       refresh ? PIN_REFRESH_BURST - pinRefreshLeft : pinRetries, (unsigned long)pkt.seq);
+}
+
+// Every ACK and beacon re-advertises what the RX decodes, so a swapped RX renegotiates.
+// A beacon arrives before the first PT_PIN, so upgrading waits until the RX has ACKed
+// a legacy frame and learned our full seq and epoch.
+void Radio::noteRxFormats(uint8_t formats) {
+  bool offered = PIN_COMPACT && pinLegacyAcked && (formats & (1 << PIN_FORMAT_COMPACT));
+  uint8_t format = offered ? PIN_FORMAT_COMPACT : PIN_FORMAT_LEGACY;
+  if (format == pinFormat) return;
+  pinFormat = format;
+  if (DEBUG_LEVEL & RADIO_DEBUG)
+    DebugSerial.printf("[RADIO] PT_PIN format %s\n", format == PIN_FORMAT_COMPACT ? "compact" : "legacy");
+}
+
+void Radio::handlePinAck(const PinAck &ack) {
+  // An RX that only ever saw compact frames knows just the low byte of our seq
+  uint32_t ackSeq = pinLatest.seq + (int8_t)((uint8_t)ack.seq - (uint8_t)pinLatest.seq);
+  // A deferred state still carries the seq of the frame before it, which may be what this ACKs
+  if (!pinUnacked || pinDeferred || ackSeq != pinLatest.seq) {  // an older frame's ACK; keep waiting
+    noteRxFormats(ack.formats);
+    return;
+  }
+
+  // Frames between the previous covered ACK and this one that never arrived
+  uint32_t span = min<uint32_t>(ackSeq - pinAckedSeq - 1, 32);
+  uint32_t mask = span == 32 ? 0xFFFFFFFFu : (1u << span) - 1;
+  pinLost += span - __builtin_popcount(ack.window & mask);
+
+  pinAckedSeq = ackSeq;
+  pinUnacked = false;
+  pinLegacyAcked = true;
+  noteRxFormats(ack.formats);
+}
+
 // ────────────────────────────────
 // RX Task
 // ────────────────────────────────
-void Radio::taskRx(Role role) {
-  if (!rf69.available()) return;
-  uint8_t buf[64];
-  uint8_t len = sizeof(buf);
-  if (!rf69.recv(buf, &len)) return;
-  uint8_t type = buf[2];
-
-  switch (type) {
-    case PT_PIN: {
-      Packet* pkt = (Packet*)buf;
-      uint8_t peerIndex = pkt->from - 1;
-      if (peerIndex >= MAX_TX) break;
-
-      static uint16_t prevPins[MAX_TX] = {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF};
-      uint16_t newPins = pkt->pins;
-      uint16_t changed = prevPins[peerIndex] ^ newPins;
-      if (changed) {
-        String delta = formatPinDelta(prevPins[peerIndex], newPins);
-        if (delta.length() > 0) {
-          Serial.printf("RX [%d] %s\n", peerIndex, delta.c_str());
-        }
-        for (int pin = 0; pin < BTN_COUNT; pin++) {
-          if (changed & (1 << pin)) {
-            bool newState = (newPins >> pin) & 1;
-            if (newState == PRESSED_LEVEL)
-              hidHandlePressWithMap(peerIndex, pin, hidMap[peerIndex]);
-            else
-              hidHandleReleaseWithMap(peerIndex, pin);
-          }
-        }
-      }
-      prevPins[peerIndex] = newPins;
-      peers[peerIndex].lastRssi = rf69.lastRssi();
-      peers[peerIndex].fsm.notePacket();
-      break;
+void Radio::taskRx() {
+  static const RxRoute routes[] = {
+    route<Packet, &Radio::onPin>(PT_PIN),
+    route<Packet, &Radio::onHeartbeat>(PT_HB),
+    route<Packet, &Radio::onHello>(PT_HELLO),
+    route<Packet, &Radio::onAdvertise>(PT_ADVERTISE),
+    route<AssignRequest, &Radio::handleAssignRequest>(PT_ASSIGN_REQUEST),
+  };
+  RxView frame;
+  if (!rf69.peekRx(frame)) return;
+  rxLatency.add(micros() - rf69.lastRxAt_us());
+  // A frame taken after the beacon may still have arrived on the channel before
+  if (HOP_ENABLE) hop.noteRx(rf69.lastRssi(), (int32_t)(rf69.lastRxAt_us() - tdma.anchor_us()) < 0);
+  uint8_t rxRate = rxRateAt(rf69.lastRxAt_us());
+  rateCtl.noteRx(rxRate, frameAirtime_us(frame.len, rxRate));
+
+  if ((frame.data[0] & (CF_FAMILY | CF_VERSION_MASK)) == (CF_FAMILY | CF_VERSION_1)) {
+    if (frame.len >= WireSize<CompactPin>::min)
+      handleCompactPin(frame.as<CompactPin>(), frame.len);
+    else
+      rxRunts++;
+  } else {
+    dispatch(routes, frame);
+  }
+  rf69.releaseRx();
+}
+
+// PinEvent::upstream of a PT_PIN: its rsv plus its own airtime (100 µs units)
+static uint16_t pinUpstream(uint8_t rsv, uint16_t air) {
+  if (rsv == PIN_RSV_SATURATED) return PIN_UPSTREAM_SATURATED;
+  return (uint16_t)min<uint32_t>(pinLatencyFromRsv(rsv) + air, PIN_UPSTREAM_SATURATED - 1);
+}
+
+void Radio::onPin(const Packet &pkt, uint8_t) {
+  Peer *peer = peers.acquire(pkt.from);
+  if (!peer) return;
+
+  receivePin(*peer, pkt.seq, pkt.epoch, 0xFFFF, pkt.pins, pinUpstream(pkt.rsv, pkt.air20));
+  notePeerRx(*peer);
+}
+
+void Radio::onHeartbeat(const Packet &pkt, uint8_t) {
+  Peer *peer = peers.acquire(pkt.from);
+  if (!peer) return;
+
+  reconcilePinState(*peer, pkt);
+  tdma.allocate(peer->addr);
+  notePeerRx(*peer);
+  int8_t dbm;
+  if (TPC_ENABLE && hbPowerFromRsv(pkt.rsv, &dbm)) peer->txPower = dbm;
+}
+
+// Slot request from a synced TX the last beacon did not list
+void Radio::onHello(const Packet &pkt, uint8_t) {
+  Peer *peer = peers.acquire(pkt.from);
+  if (!peer) return;
+
+  tdma.allocate(peer->addr);
+  notePeerRx(*peer);
+}
+
+void Radio::onAdvertise(const Packet &pkt, uint8_t) {
+  updateEphemeralTable(pkt.fingerprint, rf69.lastRssi());
+}
+
+void Radio::handleCompactPin(const CompactPin &f, uint8_t len) {
+  uint8_t kind = f.typeFlags & CF_KIND_MASK;
+  if (kind != CF_KIND_PIN && kind != CF_KIND_PIN_BATCH) return;
+
+  uint8_t n = min<uint8_t>(len - CPIN_HEADER_LEN, sizeof(f.data));
+  uint16_t mask = 0xFFFF, pins = 0;
+  const PinStep *steps = nullptr;
+  uint8_t stepCount = 0;
+  if (f.typeFlags & CF_DELTA) {
+    mask = 0;
+    for (uint8_t i = 0; i < n; i++) {
+      uint16_t bit = 1u << (f.data[i] & CF_DELTA_PIN);
+      mask |= bit;
+      if (f.data[i] & CF_DELTA_LEVEL) pins |= bit;
     }
+  } else if (n >= 2) {
+    memcpy(&pins, f.data, sizeof(pins));
+    if (kind == CF_KIND_PIN_BATCH) {
+      steps = (const PinStep *)(f.data + 2);
+      stepCount = (n - 2) / sizeof(PinStep);
+    }
+  } else {
+    return;
+  }
 
-    case PT_ADVERTISE: {
-      Packet* pkt = (Packet*)buf;
-      updateEphemeralTable(pkt->fingerprint, rf69.lastRssi());
-      break;
+  // Only a well-formed frame gets a peer entry
+  Peer *peer = peers.acquire(f.from);
+  if (!peer) return;
+
+  // Widen the low bytes against this node's last values (nearest match)
+  bool epochKnown = peer->pinEpochValid;
+  uint32_t seq = peer->pinSeqValid ? peer->pinSeq + (int8_t)(f.seq - (uint8_t)peer->pinSeq) : f.seq;
+  uint16_t epoch = epochKnown ? peer->pinEpoch + (int8_t)(f.epoch - (uint8_t)peer->pinEpoch) : f.epoch;
+  // The frame's own airtime stands in for the legacy air20 field
+  uint16_t air = frameAirtime_us(len, rxRateAt(rf69.lastRxAt_us())) / 100;
+  receivePin(*peer, seq, epoch, mask, pins, pinUpstream(f.rsv, air), steps, stepCount);
+  // Without a full epoch yet, let the next heartbeat's snapshot win
+  if (!epochKnown) peer->pinEpochValid = false;
+
+  notePeerRx(*peer);
+}
+
+// Common PT_PIN path for both wire formats. A delta (mask != 0xFFFF) only
+// applies on top of the state right before it; otherwise it is left un-ACKed
+// and the TX's re-send, always a full snapshot, repairs it.
+void Radio::receivePin(Peer &peer, uint32_t seq, uint16_t epoch, uint16_t mask, uint16_t pins, uint16_t upstream,
+                       const PinStep *steps, uint8_t n) {
+  bool accepted = true;
+  uint32_t gap = peer.pinSeqValid && (int32_t)(seq - peer.pinSeq) > 1 ? seq - peer.pinSeq - 1 : 0;
+  if (HOP_ENABLE && gap) hop.noteLoss(gap);
+  if (RATE_ADAPT) rateCtl.noteFrame(peer, gap);
+  PinSeqResult verdict = peer.notePinSeq(seq);
+  if (verdict == PIN_SEQ_DUP) {
+    pinDuplicates++;
+  } else if (verdict == PIN_SEQ_STALE) {
+    pinStale++;
+  } else if (mask != 0xFFFF && !(peer.pinEpochValid && epoch == (uint16_t)(peer.pinEpoch + 1))) {
+    accepted = false;
+    pinDeltaMisses++;
+  } else {
+    // On queue overflow withhold the ACK: the TX re-sends
+    accepted = applyPinState(peer, (peer.prevPins & ~mask) | (pins & mask), upstream, steps, n);
+    if (accepted) {
+      peer.pinEpoch = epoch;
+      peer.pinEpochValid = true;
     }
+  }
+  if (!accepted) return;
+  tdma.allocate(peer.addr);
+  peer.pinAckSeq = peer.pinSeq;
+  // In-slot frames are ACKed by the next beacon; an ACK now would land in someone else's slot
+  if (!tdma.inOwnSlot(peer.addr, rf69.lastRxAt_us())) sendPinAck(peer);
+}
 
-    case PT_ASSIGN_REQUEST: {
-      AssignRequest* req = (AssignRequest*)buf;
-      handleAssignRequest(*req);
-      break;
+// Diffs a new snapshot against the last one handed to HID; false if the event queue is full.
+// Batch steps become one event each, due at their offset, so HID sees the original
+// spacing; whatever the steps don't cover is applied together with the last one.
+bool Radio::applyPinState(Peer &peer, uint16_t pins, uint16_t upstream, const PinStep *steps, uint8_t n) {
+  if (pins == peer.prevPins) return true;
+
+  // Keep the old snapshot on overflow so the next frame re-diffs against it
+  if (pinEvents.capacity() - pinEvents.size() < n + 1) {
+    if (DEBUG_LEVEL & RADIO_DEBUG) DebugSerial.println(F("[RADIO] pin event queue full"));
+    return false;
+  }
+
+  uint32_t now = micros();
+  uint8_t node = (uint8_t)(peer.addr - 1);
+  uint16_t cur = peer.prevPins;
+  uint32_t due = now;
+  for (uint8_t i = 0; i < n; i++) {
+    uint16_t bit = 1u << (steps[i].pin & CF_DELTA_PIN);
+    uint16_t next = (steps[i].pin & CF_DELTA_LEVEL) ? cur | bit : cur & ~bit;
+    if (next == cur) continue;
+    due = now + steps[i].at * 100u;
+    pinEvents.push({ due, cur, next, upstream, node });
+    cur = next;
+  }
+  if (cur != pins) pinEvents.push({ due, cur, pins, upstream, node });
+  peer.prevPins = pins;
+  return true;
+}
+
+// Heartbeat snapshot: repairs a state whose PT_PIN frames (and retries) were all
+// lost. Snapshots older than the state already applied are ignored.
+void Radio::reconcilePinState(Peer &peer, const Packet &pkt) {
+  if (!peer.isCurrentEpoch(pkt.epoch)) return;
+
+  if (pkt.pins != peer.prevPins) {
+    // The epoch must keep describing prevPins: compact deltas build on it
+    if (!applyPinState(peer, pkt.pins, PIN_UPSTREAM_UNKNOWN)) return;
+    pinResyncs++;
+    if (DEBUG_LEVEL & RADIO_DEBUG)
+      DebugSerial.printf("[RADIO] node %d pins resynced from heartbeat\n", peer.addr);
+  }
+  peer.pinEpoch = pkt.epoch;
+  peer.pinEpochValid = true;
+}
+
+// ────────────────────────────────
+// PT_PIN dispatch (HID core)
+// ────────────────────────────────
+void Radio::dispatchPinEvents() {
+  while (const PinEvent *head = pinEvents.peek()) {
+    // Replayed batch steps wait for their offset (holds later events for at most PCF_BATCH_US)
+    if ((int32_t)(micros() - head->t_us) < 0) break;
+    PinEvent ev = *head;
+    pinEvents.pop(ev);
+
+    char delta[PIN_DELTA_LEN];
+    if (formatPinDelta(ev.prev, ev.pins, delta, sizeof(delta)) > 0) {
+      DebugSerial.printf("RX [%d] %s\n", ev.node, delta);
     }
 
-    default:
-      break;
+    const Peer *peer = peers.find(ev.node + 1);
+    if (!peer) continue;
+
+    uint16_t changed = ev.prev ^ ev.pins;
+    bool reported = false;
+    for (int pin = 0; pin < BTN_COUNT; pin++) {
+      if (changed & (1 << pin)) {
+        bool newState = (ev.pins >> pin) & 1;
+        if (newState == PRESSED_LEVEL)
+          reported |= hidHandlePressWithMap(ev.node, pin, peer->map);
+        else
+          reported |= hidHandleReleaseWithMap(ev.node, pin);
+      }
+    }
+    // Only an event the host will see opens an rx>hid interval: one that
+    // changes nothing would stay open until some unrelated report
+    if (reported && ev.upstream != PIN_UPSTREAM_UNKNOWN) Trace::markAt(TP_RX_PIN, ev.t_us, ev.node + 1, ev.upstream);
+    hidFlush();
   }
 }
 
 // ────────────────────────────────
 // Assignment Handling (RX)
 // ────────────────────────────────
-void Radio::handleAssignRequest(const AssignRequest &req) {
+void Radio::handleAssignRequest(const AssignRequest &req, uint8_t) {
   if (req.requested_id == 0 || req.requested_id > MAX_TX) {
     sendAssignNack(req.fingerprint, ASSIGN_ERR_MALFORM);
     return;
   }
 
-  for (int i = 0; i < MAX_TX; i++) {
-    if (nodeTable[i].assigned && nodeTable[i].nodeId == req.requested_id) {
-      sendAssignNack(req.fingerprint, ASSIGN_ERR_INUSE);
-      return;
-    }
+  const Peer *existing = peers.find(req.requested_id);
+  if (existing && existing->assigned) {
+    sendAssignNack(req.fingerprint, ASSIGN_ERR_INUSE);
+    return;
   }
 
   if (!allowAutoNaming && strlen(req.node_name) == 0) {
@@ -228,120 +527,654 @@ void Radio::handleAssignRequest(const AssignRequest &req) {
     return;
   }
 
-  String assignedName = strlen(req.node_name) > 0
-    ? String(req.node_name)
-    : String("TX") + String(req.requested_id);
+  char assignedName[sizeof(req.node_name)];
+  if (req.node_name[0])
+    snprintf(assignedName, sizeof(assignedName), "%.*s", (int)sizeof(req.node_name), req.node_name);
+  else
+    snprintf(assignedName, sizeof(assignedName), "TX%u", req.requested_id);
 
-  bool saveOK = Storage::saveConfigForNode(req.requested_id, assignedName);
-  if (!saveOK) {
-    sendAssignNack(req.fingerprint, ASSIGN_ERR_SAVE);
-    return;
+  // A repeat of a request being saved is answered when the save completes;
+  // with the queue full the TX simply asks again
+  uint32_t bit = 1UL << (req.requested_id - 1);
+  if (assignPending & bit) return;
+  AssignSave save = { req.fingerprint, req.requested_id, false, {} };
+  memcpy(save.name, assignedName, sizeof(save.name));
+  if (!assignSaves.push(save)) return;
+  assignPending |= bit;
+}
+
+// Core 0: LittleFS writes wait on Storage's lock (and on flushLog holding
+// it), so they stay off the radio core. Leaves a save queued while the way
+// back is full, so none is lost.
+void Radio::serviceAssignSaves() {
+  AssignSave s;
+  while (assignSaved.size() < assignSaved.capacity() && assignSaves.pop(s)) {
+    s.saved = Storage::saveConfigForNode(s.nodeId, s.name);
+    assignSaved.push(s);
   }
+}
 
-  nodeTable[req.requested_id - 1] = {
-    .fingerprint = req.fingerprint,
-    .nodeId = req.requested_id,
-    .nodeName = assignedName,
-    .lastRssi = 0,
-    .lastSeen = millis(),
-    .assigned = true
-  };
+// Radio core: answer the assignments core 0 has saved (or failed to)
+void Radio::finishAssignments() {
+  AssignSave s;
+  while (assignSaved.pop(s)) {
+    assignPending &= ~(1UL << (s.nodeId - 1));
+    if (!s.saved) {
+      sendAssignNack(s.fingerprint, ASSIGN_ERR_SAVE);
+      continue;
+    }
 
-  AssignAck ack = {};
-  ack.fingerprint = req.fingerprint;
-  ack.assigned_id = req.requested_id;
-  strncpy(ack.node_name, assignedName.c_str(), sizeof(ack.node_name) - 1);
-  rf69.send((uint8_t*)&ack, sizeof(ack));
+    Peer *peer = peers.acquire(s.nodeId);
+    peer->fingerprint = s.fingerprint;
+    peer->lastSeen = millis();
+    peer->assigned = true;
+    peer->publish();
+    tdma.allocate(peer->addr);
 
-  if (DEBUG_LEVEL & RADIO_DEBUG)
-    Serial.printf("[RX] Assigned TX#%d (%s)\n", req.requested_id, ack.node_name);
+    // The fingerprint is no longer ephemeral
+    for (NodeEntry &e : ephemeralTable) {
+      if (e.fingerprint == s.fingerprint) e = {};
+    }
+
+    AssignAck ack = {};
+    ack.from = PeerConfig::getNodeAddr();
+    ack.type = PT_ASSIGN_ACK;
+    ack.fingerprint = s.fingerprint;
+    ack.assigned_id = s.nodeId;
+    memcpy(ack.node_name, s.name, sizeof(ack.node_name) - 1);  // ack is zeroed: stays terminated
+    sendRaw(&ack, sizeof(ack), PT_ASSIGN_ACK);
+
+    if (DEBUG_LEVEL & RADIO_DEBUG)
+      DebugSerial.printf("[RX] Assigned TX#%d (%s)\n", s.nodeId, ack.node_name);
+  }
+}
+
+void Radio::sendPinAck(const Peer &peer) {
+  PinAck ack = {};
+  ack.from = PeerConfig::getNodeAddr();
+  ack.to = peer.addr;
+  ack.type = PT_PIN_ACK;
+  ack.formats = (1 << PIN_FORMAT_LEGACY) | (PIN_COMPACT ? 1 << PIN_FORMAT_COMPACT : 0);
+  ack.seq = peer.pinSeq;
+  ack.window = peer.pinWindow;
+  sendRaw(&ack, sizeof(ack), PT_PIN_ACK);
 }
 
 void Radio::sendAssignNack(uint16_t fingerprint, uint8_t reason) {
-  AssignNack nack = { .fingerprint = fingerprint, .reason = reason };
-  rf69.send((uint8_t*)&nack, sizeof(nack));
+  AssignNack nack = {};
+  nack.from = PeerConfig::getNodeAddr();
+  nack.type = PT_ASSIGN_NACK;
+  nack.fingerprint = fingerprint;
+  nack.reason = reason;
+  sendRaw(&nack, sizeof(nack), PT_ASSIGN_NACK);
   if (DEBUG_LEVEL & RADIO_DEBUG)
-    Serial.printf("[RX] NACK sent (fp=0x%04X reason=%d)\n", fingerprint, reason);
+    DebugSerial.printf("[RX] NACK sent (fp=0x%04X reason=%d)\n", fingerprint, reason);
 }
 
 // ────────────────────────────────
 // Ephemeral table update (RX)
 // ────────────────────────────────
 void Radio::updateEphemeralTable(uint16_t fingerprint, int8_t rssi) {
-  bool found = false;
-  for (int i = 0; i < MAX_TX; i++) {
-    if (nodeTable[i].fingerprint == fingerprint) {
-      nodeTable[i].lastSeen = millis();
-      nodeTable[i].lastRssi = rssi;
-      found = true;
-      break;
+  // Reuse the matching slot, else a free one, else evict the stalest
+  // (by age, so the order survives millis() wrapping)
+  uint32_t now = millis();
+  NodeEntry *slot = nullptr;
+  for (NodeEntry &e : ephemeralTable) {
+    if (e.fingerprint == fingerprint) { slot = &e; break; }
+    if (!slot || (slot->fingerprint != 0 &&
+                  (e.fingerprint == 0 || now - e.lastSeen > now - slot->lastSeen)))
+      slot = &e;
+  }
+  if (slot->fingerprint != fingerprint)
+    *slot = { fingerprint, 0, "Unassigned", rssi, now, false };
+  slot->lastSeen = now;
+  slot->lastRssi = rssi;
+}
+
+// Link bookkeeping for every frame from a known node
+void Radio::notePeerRx(Peer &peer) {
+  int8_t rssi = rf69.lastRssi();
+  peer.lastRssi = rssi;
+  // Rounded, so the average settles within 1 dB instead of stalling up to 3 dB short
+  int16_t d = rssi - peer.rssiAvg;
+  peer.rssiAvg = peer.rssiAvg ? peer.rssiAvg + (d + (d > 0 ? 2 : -2)) / 4 : rssi;
+  peer.sfRssi = rssi;
+  peer.lastSeen = millis();
+  peer.fsm.notePacket();
+  peer.publish();
+}
+
+// ────────────────────────────────
+// TDMA superframe
+// ────────────────────────────────
+// RX: closes each superframe once its contention period is over. A full TX
+// queue would drop the beacon and leave the TXs, which hop on time, a channel
+// ahead of its retry; it waits for the queue to drain a frame instead.
+void Radio::serviceBeacon() {
+  if (!TDMA_ENABLE || txInFlight || !tdma.beaconDue(micros())) return;
+  if (txQueue.size() == txQueue.capacity()) return;
+
+  if (HOP_ENABLE) hop.nextSuperframe(tdma.seq() + 1);
+
+  Beacon b = {};
+  b.from = PeerConfig::getNodeAddr();
+  b.to = 0xFF;
+  b.type = PT_BEACON;
+  b.formats = (1 << PIN_FORMAT_LEGACY) | (PIN_COMPACT ? 1 << PIN_FORMAT_COMPACT : 0);
+  b.seq = tdma.seq() + 1;
+  b.hopMask = HOP_ENABLE ? hop.mask() : 0;
+  b.prevInterval_us = tdma.prevInterval_us();
+  tdma.releaseSilent();
+  b.slotMap = tdma.granted();
+  uint8_t n = 0;
+  int8_t rssi[MAX_TX];
+  bool robustLive = false;
+  // Size the beacon's power first: the links' rates are judged at it
+  if (TPC_ENABLE) {
+    int16_t need = TPC_MIN_DBM;
+    bool sized = false;  // some live link to size it to
+    for (uint32_t m = b.slotMap; m; m &= m - 1) {
+      Peer *peer = peers.find(__builtin_ctz(m) + 1);
+      if (!peer || !PowerCtl::live(*peer)) continue;
+      need = max(need, PowerCtl::beaconNeed(*peer));
+      sized = true;
+    }
+    if (sized)
+      powerCtl.reach(need);
+    else
+      powerCtl.toMax();  // whoever joins next must hear the beacon
+  }
+  for (uint8_t addr = 1; addr <= MAX_TX; addr++) {
+    if (!((b.slotMap >> (addr - 1)) & 1)) continue;
+    Peer *peer = peers.find(addr);
+    b.acks[n] = peer ? (uint8_t)peer->pinAckSeq : 0;
+    rssi[n++] = peer ? peer->sfRssi : 0;
+    if (!peer) continue;
+    peer->sfRssi = 0;
+    if (RATE_ADAPT) {
+      robustLive |= rateCtl.adapt(*peer, b.seq, powerCtl.wanted());
+      if (peer->rate == RATE_ROBUST) b.robustMap |= 1u << (addr - 1);
     }
   }
-  if (!found) {
-    for (int i = 0; i < MAX_TX; i++) {
-      if (!nodeTable[i].assigned) {
-        nodeTable[i] = { fingerprint, 0, "Unassigned", rssi, millis(), false };
-        break;
+  rateCtl.announce(b, robustLive);
+  tdma.open(b.robustMap, rateCtl.basic(), micros() + TX_TIMEOUT_US);
+
+  // The RSSI reports trail the ACKs, and only fit up to 19 owners
+  uint8_t len = BEACON_HEADER_LEN + n;
+  if (TPC_ENABLE && len + n <= RH_RF69_MAX_MESSAGE_LEN) {
+    memcpy(b.acks + n, rssi, n);
+    len += n;
+  }
+  sendRaw(&b, len, PT_BEACON);
+}
+
+// TX: re-anchor on the beacon's PayloadReady and take the slot ACK
+void Radio::handleBeacon(const Beacon &b, uint8_t len) {
+  uint32_t at = rf69.lastRxAt_us();
+  if (RATE_ADAPT) rateCtl.follow(b);
+  tdma.follow(b, at, RATE_ADAPT ? b.robustMap : 0, rateCtl.basic(),
+              frameAirtime_us(len, rateCtl.basicFor(b.seq + 1)), PeerConfig::getNodeAddr());
+  if (HOP_ENABLE && b.hopMask) hop.follow(b.hopMask);
+  noteRxFormats(b.formats);
+  if (TPC_ENABLE) powerCtl.noteBeacon(rf69.lastRssi());
+
+  int8_t slot = tdma.slot();
+  uint8_t owners = __builtin_popcount(b.slotMap);
+  if (slot >= 0 && slot < len - BEACON_HEADER_LEN) {
+    PinAck ack = {};
+    ack.formats = b.formats;
+    ack.seq = b.acks[slot];
+    ack.window = 0xFFFFFFFFu;  // no loss bitmap in the beacon
+    handlePinAck(ack);
+    if (TPC_ENABLE && len >= BEACON_HEADER_LEN + 2 * owners) powerCtl.noteReport(b.seq, (int8_t)b.acks[owners + slot]);
+  }
+}
+
+// TX: once synced, frames wait for their part of the superframe
+bool Radio::txWindowOpen(const TxFrame &f) const {
+  if (role != Role::TX || !tdma.synced()) return true;
+  uint32_t now = micros();
+  uint32_t need = frameAirtime_us(f.len, frameRate(f)) + TDMA_GUARD_US;
+  return tdma.windowOpen(slotFrame(f) ? Tdma::WIN_SLOT : Tdma::WIN_CONTENTION, need, rateCtl.basic(), now);
+}
+
+// TX: one frame per superframe in our slot: the newest pin state while it is
+// unACKed, else a deferred heartbeat
+void Radio::serviceSlot() {
+  if (!tdma.slotted() || txInFlight || !(pinUnacked || hbDeferred)) return;
+  if (!tdma.slotOpen(micros())) return;
+
+  if (pinUnacked) {
+    // A re-send: the beacon that opened this superframe carried no ACK for the last copy
+    if (!pinDeferred) {
+      if (pinRetries >= PIN_RETRY_MAX) {
+        pinUnacked = false;
+        pinGiveUps++;
+        if (DEBUG_LEVEL & RADIO_DEBUG) DebugSerial.println(F("[RADIO] PT_PIN unacknowledged, giving up"));
+        takeHeldPins();
+        return;
       }
+      pinRetries++;
+      pinRetransmits++;
     }
+    tdma.useSlot();
+    Packet pkt = pinLatest;
+    pkt.rsv = pinLatencyRsv(micros() - pinEdgeAt_us);
+    emitPacket(pkt, role);
+    takeHeldPins();
+  } else {
+    tdma.useSlot();
+    hbDeferred = false;
+    Packet pkt = {};
+    pkt.type = PT_HB;
+    emitPacket(pkt, role);
   }
 }
 
+// TX: the state held back behind a deferred tap takes the next slot
+void Radio::takeHeldPins() {
+  if (!pinHeld) return;
+  pinHeld = false;
+  pinLatest.pins = pinHeldPins;
+  pinUnacked = true;
+  pinDeferred = true;
+  pinRetryAt = millis();
+}
+
+void Radio::serviceHello(Role role) {
+  if (!tdma.helloDue()) return;
+  Packet pkt = {};
+  pkt.type = PT_HELLO;
+  sendPacket(pkt, role);
+  tdma.helloSent();
+}
+
+// TX: synced, retune ahead of every expected beacon; otherwise park on one
+// channel at a time until the RX's hop visits it
+void Radio::serviceHop() {
+  if (!HOP_ENABLE || txInFlight) return;
+  if (tdma.synced())
+    hop.track(tdma.ahead(micros()));
+  else
+    hop.park();
+}
+
+// Our own slot frames go out at the slot's rate, everything else at the basic rate
+uint8_t Radio::frameRate(const TxFrame &f) const {
+  if (!RATE_ADAPT) return RATE_FAST;
+  if (slotFrame(f)) return tdma.slotRate();
+  if (role == Role::TX && !tdma.synced()) return rateCtl.searching();
+  return rateCtl.basic();
+}
+
+// Listen at the rate of whatever is due next; a TX without a beacon searches
+void Radio::serviceRate() {
+  if (!RATE_ADAPT) return;
+  if (role == Role::RX)
+    rateCtl.set(rxRateAt(micros()));
+  else if (tdma.synced())
+    rateCtl.set(rateCtl.basicFor(tdma.ahead(micros())));
+  else
+    rateCtl.set(rateCtl.search(pinUnacked, tdma.lastBeaconMs()));
+}
+
+// Applies the wanted power between frames. Unslotted, a TX gets no reports, so
+// a PT_PIN that needed a retry is taken as a sign the RX can't hear it.
+void Radio::servicePower() {
+  if (!TPC_ENABLE) return;
+  if (role == Role::TX && !tdma.slotted() && pinUnacked && pinRetries) powerCtl.noteRetry();
+  powerCtl.service(tdma.seq(), role);
+}
+
 // ────────────────────────────────
 // Common helpers
 // ────────────────────────────────
-void Radio::sendPacket(Packet &pkt, Role role) {
+// The timeline rides on the first copy of a compact frame only; re-sends and
+// legacy frames carry just the final snapshot.
+bool Radio::sendPinBatch(Packet &pkt, const PinStep *steps, uint8_t n) {
+  // Two batches coalesced in one slot frame can't keep their order: send the snapshot alone
+  if (pinDeferred) n = 0;
+  pinStepCount = min<uint8_t>(n, CF_BATCH_MAX);
+  memcpy(pinSteps, steps, pinStepCount * sizeof(PinStep));
+  return sendPacket(pkt, Role::TX);
+}
+
+bool Radio::sendPacket(Packet &pkt, Role role) {
+  if (pkt.type == PT_PIN) {
+    // A new edge supersedes whatever state was still awaiting an ACK
+    // A delta is only safe on top of a state the RX has confirmed
+    pinBase = pinLatest.pins;
+    pinFirstSend = !pinUnacked;
+    if (pinFirstSend) rateCtl.restartSearch();  // the rate search times the first unanswered state
+    pinEpoch++;
+    pinRetries = 0;
+    pinRefreshLeft = PIN_REFRESH_BURST;
+    pinRefreshAt = millis() + PIN_REFRESH_DELTA_MS;
+    pinEdgeAt_us = micros() - pinLatencyFromRsv(pkt.rsv) * 100u;
+    rateCtl.noteEdge();
+  }
+
+  float last_ms, avg_ms, duty_pct;
+  computeAirtime(last_ms, avg_ms, duty_pct);
+
+  if (!governor.admit(pkt.type, duty_pct, millis())) {
+    governor.defer(pkt, role, millis());
+    if (DEBUG_LEVEL & RADIO_DEBUG)
+      DebugSerial.printf("[GOV] deferred type=%d duty=%.2f%%\n", pkt.type, duty_pct);
+    return true;
+  }
+  return transmitPacket(pkt, role);
+}
+
+// Slotted TX: PT_PIN / PT_HB wait for the node's slot, where serviceSlot emits
+// the newest state, so edges between two slots cost one frame
+bool Radio::transmitPacket(Packet &pkt, Role role) {
+  if (role == Role::TX && tdma.slotted() && (pkt.type == PT_PIN || pkt.type == PT_HB)) {
+    if (pkt.type == PT_PIN) {
+      // A tap shorter than the wait for our slot would vanish in the newest
+      // state: whatever undoes a still-deferred change waits one more superframe
+      if (!pinDeferred) pinSlotBase = pinLatest.pins;
+      if (pinHeld || (pinDeferred && ((pkt.pins ^ pinLatest.pins) & (pinLatest.pins ^ pinSlotBase)))) {
+        pinHeld = true;
+        pinHeldPins = pkt.pins;
+        return true;
+      }
+      pinLatest.pins = pkt.pins;
+      pinUnacked = true;
+      pinDeferred = true;
+      pinRetryAt = millis();  // goes out unslotted right away if sync is lost first
+    } else {
+      hbDeferred = true;
+    }
+    return true;
+  }
+  return emitPacket(pkt, role);
+}
+
+// Stamps header/telemetry fields at the moment the frame is actually queued
+bool Radio::emitPacket(Packet &pkt, Role role) {
   pkt.from = PeerConfig::getNodeAddr();
   pkt.to = peerAddress(role);
-  pkt.seq = seq++;
+  pkt.seq = pkt.type == PT_PIN ? pinSeq++ : seq++;
+  // Heartbeats snapshot the pin state when they are queued, not when the governor deferred them
+  if (pkt.type == PT_HB) {
+    pkt.pins = pinLatest.pins;
+    pkt.rsv = hbPowerRsv(powerCtl.dbm());
+  }
+  if (pkt.type == PT_PIN || pkt.type == PT_HB) pkt.epoch = pinEpoch;
 
   float last_ms, avg_ms, duty_pct;
   computeAirtime(last_ms, avg_ms, duty_pct);
   pkt.air20 = (uint16_t)(last_ms * 10.0f);
   pkt.airtot = (uint16_t)(rollingSum_us / 1000);
 
-  uint32_t start_us = micros();
-  rf69.send((uint8_t*)&pkt, sizeof(pkt));
-  rf69.waitPacketSent();
-  uint32_t dur_us = micros() - start_us;
+  if (pkt.type == PT_PIN) {
+    // Randomised exponential backoff, so TXs that lost frames together don't retry together
+    uint32_t backoff = (uint32_t)PIN_ACK_TIMEOUT_MS << min<uint8_t>(pinRetries, PIN_BACKOFF_MAX_SHIFT);
+    pinLatest = pkt;
+    pinUnacked = true;
+    pinDeferred = false;
+    pinRetryAt = millis() + backoff + random(backoff);
+    bool sent = pinFormat == PIN_FORMAT_COMPACT ? sendCompactPin(pkt) : sendRaw(&pkt, sizeof(pkt), pkt.type);
+    pinStepCount = 0;
+    return sent;
+  }
+  return sendRaw(&pkt, sizeof(pkt), pkt.type);
+}
 
-  lastTxTime = dur_us / 1000.0f;
-  recordAirtime(dur_us);
+// The first copy of a single-pin edge goes out as a 1-byte delta, that of a
+// batch whose edges are spread in time with its steps; re-sends and other
+// changes carry the full snapshot alone so they never depend on a base.
+bool Radio::sendCompactPin(const Packet &pkt) {
+  CompactPin f;
+  f.typeFlags = CF_FAMILY | CF_VERSION_1 | CF_KIND_PIN;
+  f.from = pkt.from;
+  f.seq = (uint8_t)pkt.seq;
+  f.epoch = (uint8_t)pkt.epoch;
+  f.rsv = pkt.rsv;
+
+  uint8_t len = CPIN_HEADER_LEN;
+  uint16_t changed = pkt.pins ^ pinBase;
+  if (pinStepCount >= 2 && pinSteps[pinStepCount - 1].at > 0) {
+    f.typeFlags = CF_FAMILY | CF_VERSION_1 | CF_KIND_PIN_BATCH;
+    memcpy(f.data, &pkt.pins, sizeof(pkt.pins));
+    memcpy(f.data + sizeof(pkt.pins), pinSteps, pinStepCount * sizeof(PinStep));
+    len += sizeof(pkt.pins) + pinStepCount * sizeof(PinStep);
+  } else if (pinFirstSend && __builtin_popcount(changed) == 1) {
+    uint8_t pin = __builtin_ctz(changed);
+    f.typeFlags |= CF_DELTA;
+    f.data[0] = (pkt.pins & changed ? CF_DELTA_LEVEL : 0) | pin;
+    len += 1;
+  } else {
+    memcpy(f.data, &pkt.pins, sizeof(pkt.pins));
+    len += sizeof(pkt.pins);
+  }
+  pinFirstSend = false;
+  return sendRaw(&f, len, PT_PIN);
 }
 
-void Radio::recordAirtime(uint32_t dur_us) {
-  uint32_t now = millis();
-  airBuf[head] = { now, dur_us };
-  head = (head + 1) % BUF_SIZE;
-  if (count < BUF_SIZE) count++;
+// TXs powered up together would otherwise heartbeat in lockstep and collide every time
+bool Radio::queueHeartbeat() {
+  if (txMode != TX_MODE_ASSIGNED) return false;
+  hbPending = true;
+  hbDueAt = millis() + random(HB_JITTER_MS);
+  return true;
+}
 
-  rollingSum_us += dur_us;
-  uint32_t cutoff = now - 20000;
-  int valid = 0;
-  uint32_t newSum = 0;
+// Sends deferred HB / ADVERTISE frames once the governor allows it
+void Radio::serviceGovernor() {
+  float last_ms, avg_ms, duty_pct;
+  computeAirtime(last_ms, avg_ms, duty_pct);
+
+  Packet pkt;
+  Role role;
+  while (governor.release(duty_pct, millis(), pkt, role)) {
+    transmitPacket(pkt, role);
+  }
+}
+
+bool Radio::sendRaw(const void *data, uint8_t len, uint8_t type) {
+  if (len > RH_RF69_MAX_MESSAGE_LEN) return false;
+
+  TxFrame f;
+  f.type = type;
+  f.len = len;
+  memcpy(f.data, data, len);
+  if (!txQueue.push(f)) {
+    if (DEBUG_LEVEL & RADIO_DEBUG) DebugSerial.println(F("[RADIO] TX queue full, frame dropped"));
+    return false;
+  }
+  serviceTx();  // start right away when the transmitter is idle
+  return true;
+}
+
+// ────────────────────────────────
+// Asynchronous TX: reap completion, start next frame
+// ────────────────────────────────
+void Radio::serviceTx() {
+  if (txInFlight) {
+    uint32_t doneAt;
+    if (rf69.takeTxDone(doneAt)) {
+      txInFlight = false;
+      txComplete(txInFlightType, doneAt - txStartAt, doneAt);
+      // Listen straight away: ACKs (TX) and the next frames (RX) follow within a few ms
+      if (txQueue.empty()) rf69.setModeRx();
+    } else if (micros() - txStartAt > TX_TIMEOUT_US) {
+      txInFlight = false;
+      txTimeouts++;
+      rf69.setModeIdle();
+      if (DEBUG_LEVEL & RADIO_DEBUG) DebugSerial.println(F("[RADIO] PacketSent timeout"));
+    } else {
+      return;
+    }
+  }
+
+  if (role == Role::RX) {
+    serviceBeacon();
+  } else {
+    if (tdma.synced()) receiveTx();
+    serviceHop();
+    serviceSlot();
+  }
+  if (txInFlight) return;  // one of them just started a frame
+  servicePower();
+  serviceRate();
+
+  const TxFrame *head = txQueue.peek();
+  if (!head || !txWindowOpen(*head) || !channelClear(*head)) return;
+  TxFrame f;
+  txQueue.pop(f);
+  rateCtl.startFrame(frameRate(f));
+  if (slotFrame(f)) powerCtl.noteSlotFrame(tdma.seq());
+  txStartAt = micros();
+  txInFlightType = f.type;
+  txInFlight = rf69.startSend(f.data, f.len);
+}
+
+// The IRQ has already moved the frame out of the FIFO, so this only routes it:
+// from the main loop and between scheduler tasks rather than on radioRx's tick
+void Radio::serviceRx() {
+  if (!rf69.rxPending()) return;
+  if (role == Role::RX)
+    taskRx();
+  else
+    receiveTx();
+}
+
+// How long loop() may sleep before serviceTx() has something to do that no
+// IRQ announces: a slot or superframe edge, the contention period for a
+// queued frame, or a PacketSent timeout. The RX never sleeps: its modem rate
+// follows every slot (RATE_ADAPT), and it is USB-powered anyway.
+uint32_t Radio::idleBudget_us(uint32_t now) const {
+  if (role == Role::RX || rf69.rxPending()) return 0;
+  if (txInFlight) {
+    uint32_t on = now - txStartAt;
+    return on >= TX_TIMEOUT_US ? 0 : TX_TIMEOUT_US - on;
+  }
+  if (!tdma.synced()) return txQueue.empty() ? 1000 : 0;  // hop park and rate search run on millis()
+
+  const TxFrame *head = txQueue.peek();
+  Tdma::Window w = !head ? Tdma::WIN_NONE : slotFrame(*head) ? Tdma::WIN_SLOT : Tdma::WIN_CONTENTION;
+  return tdma.idleBudget_us(now, pinUnacked || hbDeferred, w, rateCtl.basic());
+}
+
+// Listen before talk. The beacon and our own TDMA slot are exclusive and go
+// out unchecked; everything else waits while RssiValue reads busy.
+bool Radio::channelClear(const TxFrame &f) {
+  if (!CSMA_ENABLE || f.type == PT_BEACON || slotFrame(f)) return true;
+
+  uint32_t now = micros();
+  if ((int32_t)(now - csmaWaitUntil) < 0) return false;
+  if (!rf69.rxActive()) {
+    rf69.setModeRx();
+    csmaWaitUntil = now + CSMA_LISTEN_US;
+    return false;
+  }
 
-  for (int i = 0; i < count; i++) {
-    int idx = (head - 1 - i + BUF_SIZE) % BUF_SIZE;
-    if (airBuf[idx].ts >= cutoff) {
-      valid++;
-      newSum += airBuf[idx].dur;
-    } else break;
+  if (rf69.rssiRead() < CSMA_BUSY_DBM || csmaTries >= CSMA_MAX_TRIES) {
+    if (csmaTries >= CSMA_MAX_TRIES) csmaForced++;
+    csmaTries = 0;
+    return true;
   }
-  count = valid;
-  rollingSum_us = newSum;
+  // Bounded exponential backoff with full jitter, so deferred TXs spread out
+  uint32_t backoff = CSMA_LISTEN_US + random(CSMA_BACKOFF_US << min<uint8_t>(csmaTries, CSMA_BACKOFF_MAX_SHIFT));
+  csmaTries++;
+  csmaBusy++;
+  csmaBackoff_us += backoff;
+  csmaWaitUntil = now + backoff;
+  return false;
+}
+
+void Radio::txComplete(uint8_t type, uint32_t airtime_us, uint32_t doneAt_us) {
+  lastTxTime = airtime_us / 1000.0f;
+  recordAirtime(airtime_us);
+  if (role == Role::TX) rateCtl.noteTx(airtime_us);
+  powerCtl.noteSent();
+  if (type == PT_PIN) {
+    rateCtl.noteEdgeOnAir(doneAt_us - pinEdgeAt_us);
+    Trace::markAt(TP_TX_SENT, doneAt_us);
+  }
+  if (type == PT_BEACON) tdma.beaconSent(doneAt_us);
+  if (txDoneCb) txDoneCb(type, airtime_us);
+}
+
+void Radio::reportPinStats(Print &out) const {
+  out.printf("[RADIO] PT_PIN %s retx=%lu refresh=%lu lost=%lu giveup=%lu dup=%lu stale=%lu resync=%lu dmiss=%lu runt=%lu\n",
+             pinFormat == PIN_FORMAT_COMPACT ? "compact" : "legacy",
+             (unsigned long)pinRetransmits, (unsigned long)pinRefreshes, (unsigned long)pinLost,
+             (unsigned long)pinGiveUps, (unsigned long)pinDuplicates, (unsigned long)pinStale,
+             (unsigned long)pinResyncs, (unsigned long)pinDeltaMisses, (unsigned long)rxRunts);
+}
+
+void Radio::report(Print &out) const {
+  governor.report(out);
+  reportPinStats(out);
+  tdma.report(out, role);
+  reportCsma(out);
+  hop.report(out, role);
+  rateCtl.report(out, role, tdma.slotRate());
+  powerCtl.report(out, role);
+  reportRx(out);
+}
+
+void Radio::reportRx(Print &out) const {
+  out.printf("[RADIO] rx irq>dispatch n=%lu p50=%luus p90=%luus p99=%luus max=%luus\n",
+             (unsigned long)rxLatency.count(), (unsigned long)rxLatency.percentile(50),
+             (unsigned long)rxLatency.percentile(90), (unsigned long)rxLatency.percentile(99),
+             (unsigned long)rxLatency.maxUs());
+}
+
+void Radio::reportCsma(Print &out) const {
+  out.printf("[CSMA] busy=%lu backoff=%lums forced=%lu\n", (unsigned long)csmaBusy,
+             (unsigned long)(csmaBackoff_us / 1000), (unsigned long)csmaForced);
+}
+
+// Preamble + sync + length + (RH header + payload, AES-padded) + CRC at the rate's bit rate
+uint32_t Radio::frameAirtime_us(uint8_t payloadLen, uint8_t rate) {
+  uint32_t body = (RH_RF69_HEADER_LEN + payloadLen + 15) & ~15u;
+  uint32_t bits = (4 + 2 + 1 + body + 2) * 8;
+  return rate == RATE_ROBUST ? bits * 1000000u / RATE_ROBUST_BPS : bits * 1000u / RF69_BITRATE_KBPS;
+}
+
+// ────────────────────────────────
+// Rolling 20 s airtime window (O(1) per packet)
+// ────────────────────────────────
+void Radio::advanceAirWindow(uint32_t now) {
+  uint32_t epoch = now / AIR_BUCKET_MS;
+  uint32_t steps = epoch - airEpoch;
+  if (steps == 0) return;
+  if (steps > AIR_BUCKETS) steps = AIR_BUCKETS;
+
+  // Evict every bucket that fell out of the window
+  for (uint32_t i = 1; i <= steps; i++) {
+    uint8_t idx = (airEpoch + i) % AIR_BUCKETS;
+    rollingSum_us -= airSum_us[idx];
+    rollingCount -= airCount[idx];
+    airSum_us[idx] = 0;
+    airCount[idx] = 0;
+  }
+  airEpoch = epoch;
+}
+
+void Radio::recordAirtime(uint32_t dur_us) {
+  advanceAirWindow(millis());
+  uint8_t idx = airEpoch % AIR_BUCKETS;
+  airSum_us[idx] += dur_us;
+  if (airCount[idx] < 0xFFFF) {
+    airCount[idx]++;
+    rollingCount++;
+  }
+  rollingSum_us += dur_us;
+  lastAir_us = dur_us;
 }
 
 void Radio::computeAirtime(float &last_ms, float &avg_ms, float &duty_pct) {
-  if (count == 0) {
+  advanceAirWindow(millis());
+  if (rollingCount == 0) {
     last_ms = avg_ms = duty_pct = 0;
     return;
   }
-  uint32_t sum_us = 0;
-  for (int i = 0; i < count; i++) {
-    int idx = (head - 1 - i + BUF_SIZE) % BUF_SIZE;
-    sum_us += airBuf[idx].dur;
-  }
-  last_ms = airBuf[(head - 1 + BUF_SIZE) % BUF_SIZE].dur / 1000.0f;
-  avg_ms = (sum_us / count) / 1000.0f;
-  duty_pct = (sum_us / 20000.0f) * 100.0f;
+  last_ms = lastAir_us / 1000.0f;
+  avg_ms = (rollingSum_us / rollingCount) / 1000.0f;
+  duty_pct = rollingSum_us * 100.0f / (AIR_WINDOW_MS * 1000.0f);
 }
@@ -1,15 +1,52 @@
 #pragma once
-#include <RH_RF69.h>
+#include "RadioDriver.h"
 #include "Config.h"
 #include "Packet.h"
 #include "Peers.h"
+#include "SpscRing.h"
+#include "TxGovernor.h"
+#include "Tdma.h"
+#include "HopSet.h"
+#include "RateCtl.h"
+#include "PowerCtl.h"
+#include "Trace.h"
 
 // ────────────────────────────────
-// Airtime tracking structure
+// Queued outgoing frame
 // ────────────────────────────────
-struct AirEntry {
-  uint32_t ts;   // millis timestamp
-  uint32_t dur;  // µs duration
+struct TxFrame {
+  uint8_t type;  // PacketType, for completion accounting
+  uint8_t len;
+  uint8_t data[RH_RF69_MAX_MESSAGE_LEN];
+};
+
+// Fired once a frame has left the antenna (PacketSent IRQ)
+typedef void (*TxDoneCallback)(uint8_t type, uint32_t airtime_us);
+
+// ────────────────────────────────
+// Decoded PT_PIN change (radio core → HID core)
+// ────────────────────────────────
+struct PinEvent {
+  uint32_t t_us;      // micros() due at HID: decode time + the step's batch offset
+  uint16_t prev;      // previous pin snapshot for this node
+  uint16_t pins;      // new pin snapshot
+  uint16_t upstream;  // TX-side latency carried in the frame (100 µs units)
+  uint8_t node;       // peer index (0-based)
+};
+
+// PinEvent::upstream for snapshots repaired from a heartbeat (edge time unknown, not traced)
+static const uint16_t PIN_UPSTREAM_UNKNOWN = 0xFFFF;
+// PinEvent::upstream past the top of the rsv scale (traced, left out of e2e)
+static const uint16_t PIN_UPSTREAM_SATURATED = TRACE_UPSTREAM_SATURATED;
+
+// ────────────────────────────────
+// Node assignment awaiting its flash save (radio core ↔ core 0)
+// ────────────────────────────────
+struct AssignSave {
+  uint16_t fingerprint;
+  uint8_t nodeId;
+  bool saved;     // set by core 0
+  char name[16];  // NUL-terminated
 };
 
 // ────────────────────────────────
@@ -22,12 +59,13 @@ enum TxMode {
 };
 
 // ────────────────────────────────
-// RX node registry entry
+// RX registry entry for unassigned (advertising) fingerprints
 // ────────────────────────────────
+// Assigned nodes live in the peer table; only ephemeral TXs are tracked here.
 struct NodeEntry {
   uint16_t fingerprint;
   uint8_t nodeId;
-  String nodeName;
+  char nodeName[16];
   int8_t lastRssi;
   uint32_t lastSeen;
   bool assigned;
@@ -35,19 +73,88 @@ struct NodeEntry {
 
 class Radio {
 public:
-  RH_RF69 rf69 = RH_RF69(RFM69_CS, RFM69_INT);
+  RadioDriver rf69 = RadioDriver(RFM69_CS, RFM69_INT);
 
   // ───── Runtime state ─────
+  Role role = Role::TX;
   uint32_t seq = 0;
   long lastRssi = 0;
   float lastTxTime = 0.0f;
 
-  // Airtime tracking
-  static const int BUF_SIZE = 64;
-  AirEntry airBuf[BUF_SIZE];
-  int head = 0;
-  int count = 0;
+  // Asynchronous transmit
+  static const uint32_t TX_TIMEOUT_US = 100000;  // PacketSent IRQ never arrived
+  SpscRing<TxFrame, 4> txQueue;
+  bool txInFlight = false;
+  uint8_t txInFlightType = 0;
+  uint32_t txStartAt = 0;  // micros() when the in-flight frame was started
+  uint32_t txTimeouts = 0;
+  TxDoneCallback txDoneCb = nullptr;
+
+  // Listen before talk, for the frame at the head of txQueue
+  uint8_t csmaTries = 0;       // busy samples so far
+  uint32_t csmaWaitUntil = 0;  // micros() of the next RSSI sample
+  uint32_t csmaBusy = 0;       // busy-channel deferrals
+  uint32_t csmaBackoff_us = 0; // total backoff drawn
+  uint32_t csmaForced = 0;     // sent busy after CSMA_MAX_TRIES
+
+  // Duty-cycle / token-bucket pacing of HB and ADVERTISE
+  TxGovernor governor;
+
+  // ───── PT_PIN reliability ─────
+  // TX: newest pin state, re-sent until a PT_PIN_ACK covers it
+  uint32_t pinSeq = 0;        // own sequence space, randomised at boot
+  uint16_t pinEpoch = 0;      // bumps with every new pin state, randomised at boot
+  Packet pinLatest = {};
+  bool pinUnacked = false;
+  uint8_t pinRetries = 0;
+  uint32_t pinRetryAt = 0;    // millis() deadline for the covering ACK
+  uint32_t pinEdgeAt_us = 0;  // edge behind pinLatest, for rsv on re-sends
+  uint32_t pinAckedSeq = 0;   // newest seq covered by an ACK
+  uint8_t pinFormat = PIN_FORMAT_LEGACY;  // picked from the formats the RX's ACKs offer
+  bool pinLegacyAcked = false;            // the RX has ACKed a full-width seq/epoch from this boot
+  uint16_t pinBase = 0xFFFF;  // state at pinEpoch - 1 (compact delta base)
+  bool pinFirstSend = false;  // next PT_PIN is the first copy of a state whose base was ACKed
+  PinStep pinSteps[CF_BATCH_MAX];  // edge batch behind the newest state, first copy only
+  uint8_t pinStepCount = 0;
+  uint8_t pinRefreshLeft = 0; // redundant copies still due after the last edge
+  uint32_t pinRefreshAt = 0;
+  bool hbPending = false;
+  uint32_t hbDueAt = 0;
+  uint32_t pinRetransmits = 0;
+  uint32_t pinLost = 0;       // frames the RX reported missing
+  uint32_t pinGiveUps = 0;
+  uint32_t pinRefreshes = 0;
+  // RX
+  uint32_t pinDuplicates = 0;
+  uint32_t pinStale = 0;
+  uint32_t pinResyncs = 0;    // snapshots repaired from a heartbeat
+  uint32_t pinDeltaMisses = 0;  // compact deltas without their base state
+  uint32_t rxRunts = 0;       // frames shorter than their type's WireSize
+  LatencyHist rxLatency{ 4 }; // PayloadReady IRQ → frame dispatched, 16 µs buckets
+
+  // ───── TDMA slot deferral (TX) ─────
+  bool pinDeferred = false;   // new pin state waiting for our slot
+  uint16_t pinSlotBase = 0;   // pins before the deferred change
+  bool pinHeld = false;       // a later state that would undo a deferred tap
+  uint16_t pinHeldPins = 0;
+  bool hbDeferred = false;
+
+  // ───── Superframe, hopping, per-link rate, transmit power ─────
+  Tdma tdma;
+  HopSet hop{ rf69 };
+  RateCtl rateCtl{ rf69 };
+  PowerCtl powerCtl{ rf69 };
+
+  // Airtime tracking: 20 × 1 s buckets, evicted as the window slides
+  static const uint8_t AIR_BUCKETS = 20;
+  static const uint32_t AIR_BUCKET_MS = 1000;
+  static const uint32_t AIR_WINDOW_MS = AIR_BUCKETS * AIR_BUCKET_MS;
+  uint32_t airSum_us[AIR_BUCKETS] = {};
+  uint16_t airCount[AIR_BUCKETS] = {};
+  uint32_t airEpoch = 0;  // millis() / AIR_BUCKET_MS of the newest bucket
   uint32_t rollingSum_us = 0;
+  uint32_t rollingCount = 0;
+  uint32_t lastAir_us = 0;
 
   // ───── TX assignment state ─────
   TxMode txMode = TX_MODE_EPHEMERAL;
@@ -58,25 +165,105 @@ public:
   bool awaitingAssignResponse = false;
 
   // ───── RX management ─────
-  NodeEntry nodeTable[MAX_TX];
+  static const uint8_t EPHEMERAL_SLOTS = 8;
+  NodeEntry ephemeralTable[EPHEMERAL_SLOTS] = {};
   bool allowAutoNaming = true;
+  SpscRing<PinEvent, 32> pinEvents;  // producer: taskRx, consumer: dispatchPinEvents
+  // Assignments are checked on the radio core, written to flash on core 0 (so
+  // the radio never waits on the LittleFS lock), then answered on the radio core
+  SpscRing<AssignSave, 4> assignSaves;  // producer: handleAssignRequest, consumer: serviceAssignSaves
+  SpscRing<AssignSave, 4> assignSaved;  // producer: serviceAssignSaves, consumer: finishAssignments
+  uint32_t assignPending = 0;           // bit addr - 1: save in progress (radio core only)
 
   // ───── Public API ─────
   void begin(Role role);
   void task(Role role);
-  void sendPacket(Packet &pkt, Role role);
+  bool sendPacket(Packet &pkt, Role role);  // governed; queues and returns immediately
+  bool sendPinBatch(Packet &pkt, const PinStep *steps, uint8_t n);  // PT_PIN + its edge timeline
+  bool sendRaw(const void *data, uint8_t len, uint8_t type);
+  bool queueHeartbeat();  // TX: liveness + full pin snapshot, sent after a random delay
+  void serviceTx();  // completion + next queued frame; call every loop
+  void serviceRx();  // dispatch a frame the PayloadReady IRQ posted; call every loop
+  uint32_t idleBudget_us(uint32_t now) const;  // until serviceTx() has timed work
+  void onTxDone(TxDoneCallback cb) { txDoneCb = cb; }
+  void dispatchPinEvents();  // HID side: apply queued PT_PIN changes
+  void serviceAssignSaves();  // core 0: write queued node assignments to flash
+  void report(Print &out) const;  // all of the below, plus the governor and the TDMA modules
+  void reportPinStats(Print &out) const;
+  void reportCsma(Print &out) const;
+  void reportRx(Print &out) const;
 
   // Airtime helpers
   void recordAirtime(uint32_t dur_us);
   void computeAirtime(float &last_ms, float &avg_ms, float &duty_pct);
+  static uint32_t frameAirtime_us(uint8_t payloadLen, uint8_t rate = RATE_FAST);
 
 private:
   // Internal role logic
   void taskTx(Role role);
-  void taskRx(Role role);
+  void receiveTx();
+  void taskRx();
+
+  // Receive dispatch: frames are read in place from the driver's buffer, as
+  // the wire struct of their PacketType, once they hold at least its minimum
+  struct RxRoute {
+    uint8_t type;
+    uint8_t minLen;
+    void (*handle)(Radio &radio, const RxView &frame);
+  };
+  template <typename T, void (Radio::*H)(const T &, uint8_t)>
+  static void routeThunk(Radio &radio, const RxView &frame) { (radio.*H)(frame.as<T>(), frame.len); }
+  template <typename T, void (Radio::*H)(const T &, uint8_t)>
+  static constexpr RxRoute route(uint8_t type) {
+    static_assert(alignof(T) == 1, "wire structs must be packed");
+    static_assert(WireSize<T>::max <= RH_RF69_MAX_MESSAGE_LEN, "frame does not fit the RFM69 FIFO");
+    return { type, WireSize<T>::min, &routeThunk<T, H> };
+  }
+  template <size_t N>
+  void dispatch(const RxRoute (&routes)[N], const RxView &frame);
+  void onPin(const Packet &pkt, uint8_t len);
+  void onHeartbeat(const Packet &pkt, uint8_t len);
+  void onHello(const Packet &pkt, uint8_t len);
+  void onAdvertise(const Packet &pkt, uint8_t len);
+  void onAssignAck(const AssignAck &ack, uint8_t len);
+  void onAssignNack(const AssignNack &nack, uint8_t len);
+  void onPinAck(const PinAck &ack, uint8_t len);
 
   // RX-specific helpers
-  void handleAssignRequest(const AssignRequest &req);
+  void handleAssignRequest(const AssignRequest &req, uint8_t len);
+  void finishAssignments();
   void sendAssignNack(uint16_t fingerprint, uint8_t reason);
   void updateEphemeralTable(uint16_t fingerprint, int8_t rssi);
+  void notePeerRx(Peer &peer);
+  void sendPinAck(const Peer &peer);
+  void serviceBeacon();
+  uint8_t rxRateAt(uint32_t at) const { return tdma.slotRateAt(at, rateCtl.basic()); }
+  void handleCompactPin(const CompactPin &f, uint8_t len);
+  void receivePin(Peer &peer, uint32_t seq, uint16_t epoch, uint16_t mask, uint16_t pins, uint16_t upstream,
+                  const PinStep *steps = nullptr, uint8_t n = 0);
+  bool applyPinState(Peer &peer, uint16_t pins, uint16_t upstream, const PinStep *steps = nullptr, uint8_t n = 0);
+  void reconcilePinState(Peer &peer, const Packet &pkt);
+
+  // TX-specific helpers
+  void servicePinRetransmit(Role role);
+  void handlePinAck(const PinAck &ack);
+  void noteRxFormats(uint8_t formats);
+  bool sendCompactPin(const Packet &pkt);
+  void handleBeacon(const Beacon &b, uint8_t len);
+  bool slotFrame(const TxFrame &f) const { return tdma.slotted() && (f.type == PT_PIN || f.type == PT_HB); }
+  bool txWindowOpen(const TxFrame &f) const;
+  void serviceSlot();
+  void takeHeldPins();
+  void serviceHello(Role role);
+
+  bool channelClear(const TxFrame &f);
+  void serviceHop();
+  uint8_t frameRate(const TxFrame &f) const;
+  void serviceRate();
+  void servicePower();
+  bool transmitPacket(Packet &pkt, Role role);
+  bool emitPacket(Packet &pkt, Role role);
+  void serviceGovernor();
+  void txComplete(uint8_t type, uint32_t airtime_us, uint32_t doneAt_us);
+  void advanceAirWindow(uint32_t now);
 };
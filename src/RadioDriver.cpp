@@ -0,0 +1,65 @@
+#include "RadioDriver.h"
+
+RadioDriver *RadioDriver::instance = nullptr;
+
+bool RadioDriver::init() {
+  if (!RH_RF69::init()) return false;
+
+  instance = this;
+  int irq = digitalPinToInterrupt(_interruptPin);
+  detachInterrupt(irq);
+  attachInterrupt(irq, isr, RISING);
+  return true;
+}
+
+void RadioDriver::isr() {
+  RadioDriver *d = instance;
+  if (!d) return;
+
+  RHMode was = d->mode();
+  d->handleInterrupt();
+  if (was == RHModeTx && d->mode() != RHModeTx) {
+    d->txDoneAt_us = micros();
+    d->txDone = true;
+  } else if (was == RHModeRx && d->mode() != RHModeRx) {
+    d->rxAt_us = micros();
+  }
+}
+
+bool RadioDriver::startSend(const uint8_t *data, uint8_t len) {
+  if (txActive()) return false;  // RH_RF69::send() would block in waitPacketSent()
+  txDone = false;
+  return send(data, len);
+}
+
+bool RadioDriver::peekRx(RxView &frame) {
+  if (txActive()) return false;
+  if (!_rxBufValid) {
+    setModeRx();
+    return false;
+  }
+  frame.data = _buf;
+  frame.len = _bufLen;
+  return true;
+}
+
+void RadioDriver::releaseRx() {
+  _rxBufValid = false;
+  if (!txActive()) setModeRx();
+}
+
+bool RadioDriver::takeTxDone(uint32_t &doneAt_us) {
+  if (!txDone) return false;
+  noInterrupts();
+  doneAt_us = txDoneAt_us;
+  txDone = false;
+  interrupts();
+  return true;
+}
+
+// The synthesizer relocks on the way back to Rx or Tx, so go through idle
+void RadioDriver::setFrf(uint32_t frf) {
+  uint8_t regs[3] = { (uint8_t)(frf >> 16), (uint8_t)(frf >> 8), (uint8_t)frf };
+  setModeIdle();
+  spiBurstWrite(RH_RF69_REG_07_FRFMSB, regs, sizeof(regs));
+}
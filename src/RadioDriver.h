@@ -0,0 +1,62 @@
+#pragma once
+#include <RH_RF69.h>
+
+// A received frame, borrowed in place from RH_RF69's buffer
+struct RxView {
+  const uint8_t *data;
+  uint8_t len;
+
+  // Wire structs are packed (alignment 1): the compiler reads their fields
+  // byte by byte, so a struct can sit at any address without a copy
+  template <typename T>
+  const T &as() const {
+    static_assert(alignof(T) == 1, "wire structs must be packed");
+    return *reinterpret_cast<const T *>(data);
+  }
+};
+
+// ────────────────────────────────
+// RH_RF69 with a non-blocking transmit path
+// ────────────────────────────────
+// RH_RF69::handleInterrupt() is not virtual, so after init() this class
+// re-attaches DIO0 to its own ISR, which runs the stock handler and then
+// timestamps the PacketSent → idle transition.
+class RadioDriver : public RH_RF69 {
+public:
+  RadioDriver(uint8_t slaveSelectPin, uint8_t interruptPin)
+    : RH_RF69(slaveSelectPin, interruptPin) {}
+
+  bool init();
+
+  // Loads the FIFO and starts TX without waiting; false if a frame is still on air
+  bool startSend(const uint8_t *data, uint8_t len);
+  bool txActive() { return mode() == RHModeTx; }
+  bool rxActive() { return mode() == RHModeRx; }  // RssiValue is only measured while receiving
+
+  // Consumes the PacketSent completion; doneAt_us is the ISR micros() stamp
+  bool takeTxDone(uint32_t &doneAt_us);
+
+  // recv() without the copy: the frame stays in RH_RF69::_buf, and the radio
+  // stays idle (PayloadReady left it there) so the ISR can't overwrite it,
+  // until releaseRx(). Like available(), listens again when nothing is pending.
+  bool peekRx(RxView &frame);
+  void releaseRx();
+  // Posted by the PayloadReady IRQ: a frame is waiting for peekRx()
+  bool rxPending() const { return _rxBufValid; }
+
+  // ISR micros() stamp of the last PayloadReady (end of the received frame)
+  uint32_t lastRxAt_us() const { return rxAt_us; }
+
+  // Channel changes from a precomputed RegFrf value: one 3-byte SPI burst
+  // instead of setFrequency()'s float maths and three single writes
+  static uint32_t frfFor(float mhz) { return (uint32_t)((mhz * 1000000.0) / RH_RF69_FSTEP); }  // as setFrequency()
+  void setFrf(uint32_t frf);
+
+private:
+  static RadioDriver *instance;
+  static void isr();
+
+  volatile bool txDone = false;
+  volatile uint32_t txDoneAt_us = 0;
+  volatile uint32_t rxAt_us = 0;
+};
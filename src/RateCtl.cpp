@@ -0,0 +1,167 @@
+#include "RateCtl.h"
+#include "DebugSerial.h"
+
+static_assert(!RATE_ADAPT || TDMA_ENABLE, "slot rates are announced in the TDMA beacon");
+
+uint8_t RateCtl::basicFor(uint16_t sf) const {
+  if (!RATE_ADAPT) return RATE_FAST;
+  return (int16_t)(sf - basicAt) >= 0 ? basicNext : sfBasic;
+}
+
+// Like a retune: the modem registers change from idle, then the receiver restarts
+void RateCtl::set(uint8_t rate) {
+  if (rate == modemRate) return;
+  bool listening = rf.rxActive();
+  rf.setModeIdle();
+  rf.setModemConfig(rate == RATE_ROBUST ? RATE_ROBUST_CONFIG : RF69_MODEM_CONFIG);
+  if (listening) rf.setModeRx();
+  modemRate = rate;
+  rateSwitches++;
+}
+
+void RateCtl::startFrame(uint8_t rate) {
+  txRate = rate;
+  set(rate);
+}
+
+// ────────────────────────────────
+// RX
+// ────────────────────────────────
+void RateCtl::noteRx(uint8_t rate, uint32_t air_us) {
+  rateStats[rate].frames++;
+  rateStats[rate].air_us += air_us;
+}
+
+void RateCtl::noteFrame(Peer &peer, uint32_t gap) {
+  uint8_t lost = min<uint32_t>(gap, 8);  // a TX reboot jumps the seq
+  peer.rateFrames++;
+  peer.rateLost += lost;
+  rateStats[peer.rate].lost += lost;
+}
+
+// Runs while the beacon is built, so the beacon that announces a change also
+// opens the first superframe using it. Down on weak RSSI, PT_PIN loss, or
+// silence (fast frames that never arrive leave no RSSI behind); back up only
+// on a strong, loss-free link after RATE_HOLD_MS. With TPC the two directions
+// differ: our beacons reach it at about its RSSI less the difference between
+// its power and ours, by reciprocity.
+bool RateCtl::adapt(Peer &peer, uint16_t sf, int8_t ourDbm) {
+  int16_t down = peer.rssiAvg - peer.txPower + ourDbm;
+  if (peer.rssiAvg && down < RATE_DOWN_DBM) peer.downRobust = true;
+  if (down >= RATE_UP_DBM) peer.downRobust = false;
+
+  uint32_t now = millis();
+  uint32_t frames = peer.rateFrames + peer.rateLost;
+  bool judged = frames >= RATE_WINDOW;
+  bool lossy = judged && peer.rateLost * 100u > frames * RATE_LOSS_PCT;
+  bool silent = now - peer.lastSeen > RATE_SILENT_MS;
+  uint16_t lost = peer.rateLost;
+  if (judged) peer.rateFrames = peer.rateLost = 0;
+
+  uint8_t rate = peer.rate;
+  if (peer.rate == RATE_FAST && (lossy || silent || (peer.rssiAvg && peer.rssiAvg < RATE_DOWN_DBM)))
+    rate = RATE_ROBUST;
+  else if (peer.rate == RATE_ROBUST && !lossy && !silent && peer.rssiAvg >= RATE_UP_DBM &&
+           now - peer.rateAt >= RATE_HOLD_MS)
+    rate = RATE_FAST;
+  if (rate != peer.rate) {
+    if (DEBUG_LEVEL & RADIO_DEBUG)
+      DebugSerial.printf("[RATE] node %d %s at sf %u: rssi=%d lost=%u/%lu%s\n", peer.addr,
+                         rate == RATE_ROBUST ? "robust" : "fast", sf, peer.rssiAvg, lost,
+                         (unsigned long)frames, silent ? " silent" : "");
+    peer.rate = rate;
+    peer.rateAt = now;
+    peer.rateFrames = peer.rateLost = 0;
+    peer.publish();
+    rateSteps++;
+  }
+  return (peer.rate == RATE_ROBUST || peer.downRobust) && millis() - max(peer.lastSeen, peer.rateAt) < RATE_KEEP_MS;
+}
+
+// The basic rate follows the weakest live link, announced ahead so TXs listen for it
+void RateCtl::announce(Beacon &b, bool robustLive) {
+  sfBasic = basicFor(b.seq);
+  uint8_t want = robustLive ? RATE_ROBUST : RATE_FAST;
+  if (RATE_ADAPT && (int16_t)(b.seq - basicAt) >= 0 && want != sfBasic) {
+    basicNext = want;
+    basicAt = b.seq + RATE_ANNOUNCE_SF;
+    basicSwitches++;
+    if (DEBUG_LEVEL & RADIO_DEBUG)
+      DebugSerial.printf("[RATE] basic %s from sf %u\n", want == RATE_ROBUST ? "robust" : "fast", basicAt);
+  }
+  b.basic = sfBasic | basicNext << 4;
+  b.basicAt = (uint8_t)basicAt;
+}
+
+// ────────────────────────────────
+// TX
+// ────────────────────────────────
+void RateCtl::follow(const Beacon &b) {
+  sfBasic = b.basic & 0x0F;
+  basicNext = b.basic >> 4;
+  uint16_t next = b.seq + (int8_t)(b.basicAt - (uint8_t)b.seq);
+  if (next != basicAt && basicNext != sfBasic) basicSwitches++;
+  basicAt = next;
+}
+
+void RateCtl::startSearch(uint16_t sf) {
+  searchRate = basicFor(sf);  // the search starts at the rate we knew
+  searchAt = millis();
+}
+
+// Anything decoded proves the rate; the search holds
+void RateCtl::holdSearch() {
+  searchRate = modemRate;
+  searchAt = millis();
+}
+
+// A TX without a beacon can't know the basic rate: it alternates between the
+// two while a state goes unanswered, and once the beacon has been gone for
+// RATE_SILENT_MS, idle or not: by then the RX has moved our link, and maybe
+// its basic rate, to RATE_ROBUST.
+uint8_t RateCtl::search(bool unanswered, uint32_t lastBeaconMs) {
+  bool silent = lastBeaconMs && millis() - lastBeaconMs >= RATE_SILENT_MS;
+  if ((unanswered || silent) && millis() - searchAt >= RATE_SEARCH_MS) {
+    searchRate ^= 1;
+    searchAt = millis();
+  }
+  return searchRate;
+}
+
+void RateCtl::noteTx(uint32_t air_us) {
+  rateStats[txRate].frames++;
+  rateStats[txRate].air_us += air_us;
+}
+
+void RateCtl::noteEdgeOnAir(uint32_t latency_us) {
+  if (!edgePending) return;
+  rateStats[txRate].latency.add(latency_us);
+  edgePending = false;
+}
+
+void RateCtl::report(Print &out, Role role, uint8_t slotRate) const {
+  if (!RATE_ADAPT) return;
+  uint8_t links[2] = {};
+  if (role == Role::RX) {
+    for (uint8_t i = 0; i < peers.activeCount(); i++) links[peers.active(i)->status.read().rate == RATE_ROBUST]++;
+  }
+  for (uint8_t r = RATE_FAST; r <= RATE_ROBUST; r++) {
+    const RateStats &st = rateStats[r];
+    out.printf("[RATE] %-6s %lubps", r == RATE_ROBUST ? "robust" : "fast",
+               (unsigned long)(r == RATE_ROBUST ? RATE_ROBUST_BPS : RF69_BITRATE_KBPS * 1000ul));
+    if (role == Role::RX) out.printf(" links=%u", links[r]);
+    out.printf(" frames=%lu air=%luus avg", (unsigned long)st.frames,
+               (unsigned long)(st.frames ? st.air_us / st.frames : 0));
+    if (role == Role::RX) out.printf(" lost=%lu", (unsigned long)st.lost);
+    if (st.latency.count())
+      out.printf(" edge>air p50=%luus p99=%luus", (unsigned long)st.latency.percentile(50),
+                 (unsigned long)st.latency.percentile(99));
+    out.println();
+  }
+  out.printf("[RATE] basic=%s", sfBasic == RATE_ROBUST ? "robust" : "fast");
+  if (basicNext != sfBasic) out.printf(" (%s from sf %u)", basicNext == RATE_ROBUST ? "robust" : "fast", basicAt);
+  if (role == Role::TX) out.printf(" slot=%s", slotRate == RATE_ROBUST ? "robust" : "fast");
+  out.printf(" switches=%lu basic=%lu", (unsigned long)rateSwitches, (unsigned long)basicSwitches);
+  if (role == Role::RX) out.printf(" steps=%lu", (unsigned long)rateSteps);
+  out.println();
+}
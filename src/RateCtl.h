@@ -0,0 +1,66 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "Packet.h"
+#include "Peers.h"
+#include "RadioDriver.h"
+#include "Trace.h"
+
+// ────────────────────────────────
+// Per-link rate
+// ────────────────────────────────
+// The modem's LinkRate, and the rates it switches between: per slot from
+// the beacon (each owner's link), and a basic rate for beacons and
+// contention that the RX announces RATE_ANNOUNCE_SF superframes ahead.
+class RateCtl {
+public:
+  explicit RateCtl(RadioDriver &rf) : rf(rf) {}
+
+  uint8_t basic() const { return sfBasic; }    // of the current superframe
+  uint8_t basicFor(uint16_t sf) const;         // of superframe sf, as last announced
+  void set(uint8_t rate);                      // the modem's
+  void startFrame(uint8_t rate);               // the frame about to be sent goes out at rate
+
+  // ───── RX ─────
+  void noteRx(uint8_t rate, uint32_t air_us);  // a frame received at rate
+  void noteFrame(Peer &peer, uint32_t gap);    // a PT_PIN from peer after gap missing seqs
+  // Steps peer's slot rate for the beacon of superframe sf; true while the
+  // link keeps the basic rate robust
+  bool adapt(Peer &peer, uint16_t sf, int8_t ourDbm);
+  void announce(Beacon &b, bool robustLive);   // basic rate of the beacon's superframe and the next change
+
+  // ───── TX ─────
+  void follow(const Beacon &b);
+  void startSearch(uint16_t sf);  // beacon lost: listen from sf's basic rate
+  void holdSearch();              // a frame was decoded at the modem's rate
+  void restartSearch() { searchAt = millis(); }  // a first unanswered state
+  uint8_t search(bool unanswered, uint32_t lastBeaconMs);  // the rate to listen at without a beacon
+  uint8_t searching() const { return searchRate; }
+  void noteEdge() { edgePending = true; }
+  void noteTx(uint32_t air_us);
+  void noteEdgeOnAir(uint32_t latency_us);  // a PT_PIN left; latency from the edge behind it
+
+  void report(Print &out, Role role, uint8_t slotRate) const;
+
+private:
+  struct RateStats {
+    uint32_t frames = 0;  // TX: sent at this rate; RX: received
+    uint32_t air_us = 0;
+    uint32_t lost = 0;    // RX: PT_PIN seqs missed on links at this rate
+    LatencyHist latency;  // TX: PCF edge → first copy of the state on air
+  };
+
+  RadioDriver &rf;
+  uint8_t modemRate = RATE_FAST;  // LinkRate the modem is set to
+  uint8_t txRate = RATE_FAST;     // of the in-flight frame
+  uint8_t sfBasic = RATE_FAST;    // beacon and contention rate of the current superframe
+  uint8_t basicNext = RATE_FAST;  // the same from superframe basicAt on
+  uint16_t basicAt = 0;
+  uint8_t searchRate = RATE_FAST; // TX without a beacon: listen rate, alternating
+  uint32_t searchAt = 0;
+  bool edgePending = false;       // TX: the newest edge's first copy not yet sent
+  RateStats rateStats[2];         // by LinkRate
+  uint32_t rateSwitches = 0;      // modem reconfigurations
+  uint32_t rateSteps = 0;         // RX: links stepped down or up
+  uint32_t basicSwitches = 0;     // RX: announced, TX: followed
+};
@@ -2,33 +2,29 @@
 #include "Packet.h"
 #include "Radio.h"
 #include "Config.h"
+#include "DebugSerial.h"
 
 // Called periodically to evaluate link state
 void RejoinFSM::taskRun(Radio& radio, Role role) {
   if ((millis() - lastPacketTime) > LINK_DOWN_MS) {
     if (link != LinkState::DOWN) {
       link = LinkState::DOWN;
-      if (DEBUG_LEVEL & FSM_DEBUG) Serial.println(F("[FSM] link DOWN"));
+      if (DEBUG_LEVEL & FSM_DEBUG) DebugSerial.println(F("[FSM] link DOWN"));
     }
   } else {
     if (link != LinkState::UP) {
       link = LinkState::UP;
-      if (DEBUG_LEVEL & FSM_DEBUG) Serial.println(F("[FSM] link UP"));
+      if (DEBUG_LEVEL & FSM_DEBUG) DebugSerial.println(F("[FSM] link UP"));
     }
   }
 }
 
-// Called periodically by TX nodes to send heartbeats
+// Called periodically by TX nodes to send heartbeats. The heartbeat carries the
+// pin snapshot that repairs lost edges on the RX, so it goes out whether or not
+// this side has seen the link come up.
 void RejoinFSM::taskHeartbeat(Radio& radio, Role role) {
-  if (link == LinkState::UP) {
-    Packet pkt = {};
-    pkt.type = PT_HB;
-    pkt.from = 0;       // TODO: fill with this node's address
-    pkt.to   = 0xFF;    // broadcast, or specific RX
-    radio.sendPacket(pkt, role);
-
-    if (DEBUG_LEVEL & FSM_DEBUG) Serial.println(F("[FSM] heartbeat sent"));
-  }
+  if (role == Role::TX && radio.queueHeartbeat() && (DEBUG_LEVEL & FSM_DEBUG))
+    DebugSerial.println(F("[FSM] heartbeat queued"));
 }
 
 // ======================================================
@@ -39,7 +35,7 @@ void RejoinFSM::taskHeartbeat(Radio& radio, Role role) {
 void RejoinFSM::notePacket() {
   lastPacketTime = millis();
   link = LinkState::UP;
-  if (DEBUG_LEVEL & FSM_DEBUG) Serial.println(F("[FSM] packet noted, link UP"));
+  if (DEBUG_LEVEL & FSM_DEBUG) DebugSerial.println(F("[FSM] packet noted, link UP"));
 }
 
 // Query current state in a simple way
@@ -1,16 +1,138 @@
+#include <pico/time.h>
 #include "Scheduler.h"
 #include "Config.h"
+#include "Utils.h"
 
+bool Scheduler::addTask(const char* name, uint32_t interval_ms, TaskFn fn,
+                        TaskPriority prio, TaskTiming timing, TaskCatchUp catchUp) {
+  if (count >= capacity) {
+    if (DEBUG_LEVEL & SCHED_DEBUG) Serial.printf("[SCHED] table full, %s not added\n", name);
+    return false;
+  }
+  uint32_t interval_us = interval_ms * 1000;
+  tasks[count++] = { name, interval_us, micros() + interval_us, fn, true, prio, timing, catchUp, {} };
+  return true;
+}
+
+// Every due task runs once per tick, in priority order, then earliest due first
 void Scheduler::tick() {
-  uint32_t now = millis();
+  uint16_t ran = 0;
+  int8_t i;
+  while ((i = nextDue(micros(), ran)) >= 0) {
+    if (urgent) urgent();
+    ran |= 1u << i;
+    run(tasks[i]);
+  }
+}
+
+int8_t Scheduler::nextDue(uint32_t now, uint16_t ran) const {
+  int8_t best = -1;
   for (uint8_t i = 0; i < count; i++) {
-    if (tasks[i].enabled && (int32_t)(now - tasks[i].nextDue) >= 0) {
-      if (DEBUG_LEVEL & SCHED_DEBUG) {
-        Serial.print(F("[SCHED] Running task: "));
-        Serial.println(tasks[i].name);
-      }
-      tasks[i].fn();
-      tasks[i].nextDue = now + tasks[i].interval;
-    }
+    const Task &t = tasks[i];
+    if (!t.enabled || ((ran >> i) & 1) || (int32_t)(now - t.nextDue_us) < 0) continue;
+    if (best < 0 || t.prio < tasks[best].prio ||
+        (t.prio == tasks[best].prio && (int32_t)(t.nextDue_us - tasks[best].nextDue_us) < 0))
+      best = i;
   }
+  return best;
+}
+
+void Scheduler::run(Task &t) {
+  if (DEBUG_LEVEL & SCHED_DEBUG) {
+    Serial.print(F("[SCHED] Running task: "));
+    Serial.println(t.name);
+  }
+  bool heapCheck = DEBUG_LEVEL & SCHED_DEBUG;
+  size_t heapBefore = heapCheck ? heapUsed() : 0;
+  uint32_t start = micros();
+  uint32_t late = start - t.nextDue_us;
+  t.fn();
+  uint32_t end = micros();
+
+  TaskStats &s = t.stats;
+  size_t heapAfter = heapCheck ? heapUsed() : 0;
+  if (heapAfter > heapBefore) {
+    s.heapKept += heapAfter - heapBefore;
+    Serial.printf("[SCHED] %s kept %u heap bytes\n", t.name, (unsigned)(heapAfter - heapBefore));
+  }
+  uint32_t took = end - start;
+  s.runs++;
+  s.runSum_us += took;
+  s.runMax_us = max(s.runMax_us, took);
+  s.lateSum_us += late;
+  s.lateMax_us = max(s.lateMax_us, late);
+  if (late >= t.interval_us) s.misses++;
+
+  if (t.timing == TASK_FIXED_DELAY) {
+    t.nextDue_us = end + t.interval_us;
+    return;
+  }
+  // Fixed rate: the next grid point, unless it has already passed
+  t.nextDue_us += t.interval_us;
+  uint32_t behind = end - t.nextDue_us;
+  if ((int32_t)behind < 0) return;
+  if (t.catchUp == CATCHUP_BURST && behind < SCHED_BURST_MAX * t.interval_us) return;
+  t.nextDue_us += (behind / t.interval_us + 1) * t.interval_us;
+}
+
+uint32_t Scheduler::idleBudget_us(uint32_t now) const {
+  uint32_t budget = IDLE_FOREVER;
+  for (uint8_t i = 0; i < count; i++) {
+    if (!tasks[i].enabled) continue;
+    int32_t left = tasks[i].nextDue_us - now;
+    budget = min<uint32_t>(budget, left > 0 ? left : 0);
+  }
+  return budget;
+}
+
+// WFE also wakes on every exception return, so an IRQ that lands between the
+// caller's last look at its flags and the WFE ends the wait at once
+void Scheduler::idle(uint32_t budget_us) {
+  if (!IDLE_ENABLE || budget_us < IDLE_MIN_US) return;
+  uint32_t start = micros();
+  uint32_t wait = min<uint32_t>(budget_us, 1000000) - IDLE_EARLY_US;
+  bool timedOut = best_effort_wfe_or_timeout(delayed_by_us(get_absolute_time(), wait));
+  uint32_t end = micros();
+  asleep_us += end - start;
+  sleeps++;
+  if (timedOut) {
+    int32_t late = end - (start + wait);
+    wakeLate.add(late > 0 ? late : 0);
+  }
+}
+
+void Scheduler::report(Print &out) const {
+  out.println(F("[SCHED] task          prio  runs    avg/max us    late avg/max us  miss  heap"));
+  for (uint8_t i = 0; i < count; i++) {
+    const Task &t = tasks[i];
+    const TaskStats &s = t.stats;
+    uint32_t n = max<uint32_t>(s.runs, 1);
+    out.printf("[SCHED] %-12s  %u%c  %6lu  %6lu/%-7lu %6lu/%-7lu  %4lu  %lu%s\n", t.name, t.prio,
+               t.timing == TASK_FIXED_RATE ? (t.catchUp == CATCHUP_BURST ? 'B' : 'R') : 'D',
+               (unsigned long)s.runs, (unsigned long)(s.runSum_us / n), (unsigned long)s.runMax_us,
+               (unsigned long)(s.lateSum_us / n), (unsigned long)s.lateMax_us, (unsigned long)s.misses,
+               (unsigned long)s.heapKept, t.enabled ? "" : " (off)");
+  }
+  long grown = (long)heapUsed() - (long)heapSealed;
+  out.printf("[SCHED] heap %+ld bytes since setup()%s\n", grown, grown > 0 ? " ALLOCATING" : "");
+  if (IDLE_ENABLE) {
+    uint32_t span = max<uint32_t>(micros() - statsSince_us, 1);
+    out.printf("[SCHED] idle %lu.%lu%% sleeps=%lu wake late p50=%luus p99=%luus max=%luus\n",
+               (unsigned long)(asleep_us * 100 / span), (unsigned long)(asleep_us * 1000 / span % 10),
+               (unsigned long)sleeps, (unsigned long)wakeLate.percentile(50),
+               (unsigned long)wakeLate.percentile(99), (unsigned long)wakeLate.maxUs());
+  }
+}
+
+void Scheduler::resetStats() {
+  for (uint8_t i = 0; i < count; i++) tasks[i].stats = {};
+  wakeLate.reset();
+  asleep_us = 0;
+  sleeps = 0;
+  statsSince_us = micros();
+}
+
+void Scheduler::sealHeap() {
+  heapSealed = heapUsed();
+  statsSince_us = micros();
 }
@@ -1,27 +1,109 @@
 #pragma once
 #include <Arduino.h>
-#include <functional>
+#include "InplaceFunction.h"
+#include "Trace.h"
+
+static const uint32_t IDLE_FOREVER = 0xFFFFFFFFu;  // idleBudget_us(): no deadline pending
+
+// Due tasks run highest priority first; the urgent hook (radio dispatch) runs
+// before each, so a low-priority task only ever delays other low-priority work
+enum TaskPriority : uint8_t {
+  PRIO_HIGH = 0,    // input and radio timers
+  PRIO_NORMAL = 1,  // link state, heartbeats
+  PRIO_LOW = 2      // OLED, storage, reports
+};
+
+enum TaskTiming : uint8_t {
+  TASK_FIXED_RATE = 0,  // due on a fixed grid from the first due time (no drift)
+  TASK_FIXED_DELAY = 1  // due interval after the previous run ended
+};
+
+// Fixed rate only: what an overrun does to the periods it ran over
+enum TaskCatchUp : uint8_t {
+  CATCHUP_SKIP = 0,  // drop them and resume on the grid
+  CATCHUP_BURST = 1  // run them back to back, one per tick, up to SCHED_BURST_MAX
+};
+
+struct TaskStats {
+  uint32_t runs;
+  uint64_t runSum_us;    // execution time
+  uint32_t runMax_us;
+  uint64_t lateSum_us;   // start jitter: start - due
+  uint32_t lateMax_us;
+  uint32_t misses;       // runs that started a whole interval or more late
+  uint32_t heapKept;     // bytes a run left allocated (SCHED_DEBUG)
+};
+
+typedef InplaceFunction<void()> TaskFn;
 
 struct Task {
-  String name;
-  uint32_t interval;
-  uint32_t nextDue;
-  std::function<void()> fn;
+  const char *name;  // static string
+  uint32_t interval_us;
+  uint32_t nextDue_us;
+  TaskFn fn;
   bool enabled;
+  TaskPriority prio;
+  TaskTiming timing;
+  TaskCatchUp catchUp;
+  TaskStats stats;
 };
 
+// Nothing here allocates: the task table is StaticScheduler's array, and
+// callables live inline in their Task. Code that only runs or reports the
+// tasks takes a Scheduler &, whatever the table size.
 class Scheduler {
 public:
-  static const uint8_t MAX_TASKS = 10;
-  Task tasks[MAX_TASKS];
+  static const uint8_t SCHED_BURST_MAX = 4;  // periods a CATCHUP_BURST task replays before it skips
+  Task *const tasks;
+  const uint8_t capacity;
   uint8_t count = 0;
 
-  void addTask(const char* name, uint32_t interval, std::function<void()> fn, bool enabled = true) {
-    if (count < MAX_TASKS) {
-      tasks[count] = { String(name), interval, millis() + interval, fn, enabled };
-      count++;
-    }
-  }
+  // false when the table is full
+  bool addTask(const char* name, uint32_t interval_ms, TaskFn fn,
+               TaskPriority prio = PRIO_NORMAL, TaskTiming timing = TASK_FIXED_RATE,
+               TaskCatchUp catchUp = CATCHUP_SKIP);
+
+  // Event work that must not wait behind a slow task (OLED, storage):
+  // runs before each due task
+  void setUrgent(void (*fn)()) { urgent = fn; }
 
   void tick();  // ⬅️ Only declaration now
+  void report(Print &out) const;
+  void resetStats();
+
+  // Time until the earliest enabled task is due (0 = overdue)
+  uint32_t idleBudget_us(uint32_t now) const;
+  // WFE until budget_us has passed or an interrupt fires. Wake-up lateness
+  // against the deadline and the time spent asleep go into report().
+  void idle(uint32_t budget_us);
+
+  // Call at the end of setup(): from then on the heap must not grow.
+  // With SCHED_DEBUG every task run is checked, and report() shows the total.
+  void sealHeap();
+
+protected:
+  Scheduler(Task *table, uint8_t n) : tasks(table), capacity(n) {}
+
+private:
+  void (*urgent)() = nullptr;
+  size_t heapSealed = 0;
+
+  LatencyHist wakeLate{ 4 };  // timed wake-ups: micros() past the deadline
+  uint64_t asleep_us = 0;
+  uint32_t sleeps = 0;
+  uint32_t statsSince_us = 0;
+
+  int8_t nextDue(uint32_t now, uint16_t ran) const;
+  void run(Task &t);
+};
+
+template <uint8_t N>
+class StaticScheduler : public Scheduler {
+  static_assert(N <= 16, "Scheduler::tick tracks the tasks it ran in a 16-bit mask");
+
+public:
+  StaticScheduler() : Scheduler(table, N) {}
+
+private:
+  Task table[N];
 };
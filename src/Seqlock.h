@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+// ────────────────────────────────
+// Single-writer sequence lock
+// ────────────────────────────────
+// One context write()s a small value; any other context read()s a consistent
+// copy without ever blocking the writer, retrying while a write is under way
+// (odd sequence) or landed during the copy. The value is kept in atomic words
+// and the sequence is bumped by load/store, never read-modify-write, so it
+// needs nothing the Cortex-M0+ lacks.
+template <typename T>
+class Seqlock {
+  static_assert(std::is_trivially_copyable<T>::value, "Seqlock copies T word by word");
+  static constexpr size_t WORDS = (sizeof(T) + 3) / 4;
+
+public:
+  Seqlock() { write(T()); }
+
+  void write(const T &v) {
+    uint32_t w[WORDS] = {};
+    memcpy(w, &v, sizeof(T));
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);  // odd before any word changes
+    for (size_t i = 0; i < WORDS; i++) data[i].store(w[i], std::memory_order_relaxed);
+    seq.store(s + 2, std::memory_order_release);
+  }
+
+  T read() const {
+    uint32_t w[WORDS];
+    uint32_t s;
+    do {
+      s = seq.load(std::memory_order_acquire);
+      for (size_t i = 0; i < WORDS; i++) w[i] = data[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);  // words before the re-check
+    } while ((s & 1) || seq.load(std::memory_order_relaxed) != s);
+    T v;
+    memcpy(&v, w, sizeof(T));
+    return v;
+  }
+
+private:
+  std::atomic<uint32_t> data[WORDS] = {};
+  std::atomic<uint32_t> seq{ 0 };
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// ────────────────────────────────
+// Lock-free single-producer / single-consumer ring
+// ────────────────────────────────
+// One context may push() (ISR, loop, or the other core) and exactly one
+// other context may pop(). N must be a power of two; one index pair of
+// 16-bit counters keeps every access a plain load/store on Cortex-M0+.
+template <typename T, uint16_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+  bool push(const T &item) {
+    uint16_t h = head.load(std::memory_order_relaxed);
+    uint16_t t = tail.load(std::memory_order_acquire);
+    if ((uint16_t)(h - t) >= N) {
+      dropped++;
+      return false;
+    }
+    buf[h & (N - 1)] = item;
+    head.store((uint16_t)(h + 1), std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T &out) {
+    uint16_t t = tail.load(std::memory_order_relaxed);
+    uint16_t h = head.load(std::memory_order_acquire);
+    if (h == t) return false;
+    out = buf[t & (N - 1)];
+    tail.store((uint16_t)(t + 1), std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only: oldest item, left in place (nullptr when empty)
+  const T *peek() const {
+    uint16_t t = tail.load(std::memory_order_relaxed);
+    uint16_t h = head.load(std::memory_order_acquire);
+    return h == t ? nullptr : &buf[t & (N - 1)];
+  }
+
+  uint16_t size() const {
+    return (uint16_t)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+  }
+  bool empty() const { return size() == 0; }
+  static constexpr uint16_t capacity() { return N; }
+
+  uint32_t dropped = 0;  // producer-side overflow count
+
+private:
+  T buf[N];
+  std::atomic<uint16_t> head{ 0 };
+  std::atomic<uint16_t> tail{ 0 };
+};
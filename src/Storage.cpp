@@ -1,28 +1,56 @@
 #include "Storage.h"
 #include "Config.h"
+#include "DebugSerial.h"
 #include <LittleFS.h>
 #include <ArduinoJson.h>
-
-// Local forward declaration
-static void rotateErrorLog(JsonArray &errors, int code, const char *msg, bool sticky);
+#include <stddef.h>
+
+// LittleFS is not re-entrant, so every entry point takes this lock. The radio
+// core never waits on it: RX node assignments are saved on core 0
+// (Radio::serviceAssignSaves), and errors it logs only queue a record.
+// The error log's RAM queue has its own lock, held only to copy one record.
+#if RADIO_ON_CORE1
+#include <pico/mutex.h>
+auto_init_recursive_mutex(fsMutex);
+auto_init_mutex(logMutex);
+struct FsLock {
+  FsLock() { recursive_mutex_enter_blocking(&fsMutex); }
+  ~FsLock() { recursive_mutex_exit(&fsMutex); }
+};
+struct LogLock {
+  LogLock() { mutex_enter_blocking(&logMutex); }
+  ~LogLock() { mutex_exit(&logMutex); }
+};
+#else
+struct FsLock {
+  FsLock() {}
+};
+struct LogLock {
+  LogLock() {}
+};
+#endif
+
+static void openLog();
 
 // ---------------------------------------------------------------------------
 // Initialize LittleFS
 // ---------------------------------------------------------------------------
 bool Storage::begin() {
+  FsLock lock;
   if (!LittleFS.begin()) {
-    if (DEBUG_LEVEL & FS_DEBUG) Serial.println(F("[FS] mount failed, formatting..."));
+    if (DEBUG_LEVEL & FS_DEBUG) DebugSerial.println(F("[FS] mount failed, formatting..."));
 
     LittleFS.format();
     if (!LittleFS.begin()) {
-      if (DEBUG_LEVEL & FS_DEBUG) Serial.println(F("[FS] re-mount failed"));
+      if (DEBUG_LEVEL & FS_DEBUG) DebugSerial.println(F("[FS] re-mount failed"));
       Storage::logError(ERR_FS_MOUNT_FAIL);
       return false;
     }
-    if (DEBUG_LEVEL & FS_DEBUG) Serial.println(F("[FS] re-mount succeeded after format"));
+    if (DEBUG_LEVEL & FS_DEBUG) DebugSerial.println(F("[FS] re-mount succeeded after format"));
   } else {
-    if (DEBUG_LEVEL & FS_DEBUG) Serial.println(F("[FS] mount OK"));
+    if (DEBUG_LEVEL & FS_DEBUG) DebugSerial.println(F("[FS] mount OK"));
   }
+  openLog();
   return true;
 }
 
@@ -30,9 +58,10 @@ bool Storage::begin() {
 // Load config.json → NodeConfig struct
 // ---------------------------------------------------------------------------
 bool Storage::loadConfig(NodeConfig &cfg) {
+  FsLock lock;
   File f = LittleFS.open("/config.json", "r");
   if (!f) {
-    if (DEBUG_LEVEL & FS_DEBUG) Serial.println(F("[FS] config.json missing"));
+    if (DEBUG_LEVEL & FS_DEBUG) DebugSerial.println(F("[FS] config.json missing"));
     Storage::logError(ERR_CONFIG_MISSING);
     cfg.node_addr = DEFAULT_NODE_ADDR;
     cfg.node_name = DEFAULT_NODE_NAME;
@@ -45,8 +74,8 @@ bool Storage::loadConfig(NodeConfig &cfg) {
 
   if (err) {
     if (DEBUG_LEVEL & FS_DEBUG) {
-      Serial.print(F("[FS] JSON parse error: "));
-      Serial.println(err.f_str());
+      DebugSerial.print(F("[FS] JSON parse error: "));
+      DebugSerial.println(err.f_str());
     }
     Storage::logError(ERR_JSON_PARSE);
     return false;
@@ -56,7 +85,7 @@ bool Storage::loadConfig(NodeConfig &cfg) {
   cfg.node_name = String(doc["node_name"] | DEFAULT_NODE_NAME);
 
   if (DEBUG_LEVEL & FS_DEBUG) {
-    Serial.printf("[FS] Loaded node addr=%d name=%s\n", cfg.node_addr, cfg.node_name.c_str());
+    DebugSerial.printf("[FS] Loaded node addr=%d name=%s\n", cfg.node_addr, cfg.node_name.c_str());
   }
   return true;
 }
@@ -65,9 +94,10 @@ bool Storage::loadConfig(NodeConfig &cfg) {
 // Save config.json ← NodeConfig struct
 // ---------------------------------------------------------------------------
 bool Storage::saveConfig(const NodeConfig &cfg) {
+  FsLock lock;
   File f = LittleFS.open("/config.json", "w");
   if (!f) {
-    if (DEBUG_LEVEL & FS_DEBUG) Serial.println(F("[FS] save open failed"));
+    if (DEBUG_LEVEL & FS_DEBUG) DebugSerial.println(F("[FS] save open failed"));
     Storage::logError(ERR_SAVE_FAIL);
     return false;
   }
@@ -77,7 +107,7 @@ bool Storage::saveConfig(const NodeConfig &cfg) {
   doc["node_name"] = cfg.node_name;
 
   if (serializeJson(doc, f) == 0) {
-    if (DEBUG_LEVEL & FS_DEBUG) Serial.println(F("[FS] save write fail"));
+    if (DEBUG_LEVEL & FS_DEBUG) DebugSerial.println(F("[FS] save write fail"));
     Storage::logError(ERR_SAVE_FAIL);
     f.close();
     return false;
@@ -85,7 +115,7 @@ bool Storage::saveConfig(const NodeConfig &cfg) {
 
   f.close();
   if (DEBUG_LEVEL & FS_DEBUG)
-    Serial.printf("[FS] Saved node %d -> %s\n", cfg.node_addr, cfg.node_name.c_str());
+    DebugSerial.printf("[FS] Saved node %d -> %s\n", cfg.node_addr, cfg.node_name.c_str());
   return true;
 }
 
@@ -96,6 +126,7 @@ bool Storage::saveConfig(const NodeConfig &cfg) {
 // Example path: /nodes/TX3.json
 // ---------------------------------------------------------------------------
 bool Storage::saveConfigForNode(uint8_t nodeId, const String &name) {
+  FsLock lock;
   if (nodeId == 0 || nodeId > MAX_TX) return false;
 
   // Ensure directory exists
@@ -107,7 +138,7 @@ bool Storage::saveConfigForNode(uint8_t nodeId, const String &name) {
   File f = LittleFS.open(path, "w");
   if (!f) {
     if (DEBUG_LEVEL & FS_DEBUG)
-      Serial.printf("[FS] saveConfigForNode: open fail (%s)\n", path.c_str());
+      DebugSerial.printf("[FS] saveConfigForNode: open fail (%s)\n", path.c_str());
     Storage::logError(ERR_SAVE_FAIL);
     return false;
   }
@@ -118,7 +149,7 @@ bool Storage::saveConfigForNode(uint8_t nodeId, const String &name) {
 
   if (serializeJson(doc, f) == 0) {
     if (DEBUG_LEVEL & FS_DEBUG)
-      Serial.printf("[FS] saveConfigForNode: write fail (%s)\n", path.c_str());
+      DebugSerial.printf("[FS] saveConfigForNode: write fail (%s)\n", path.c_str());
     f.close();
     Storage::logError(ERR_SAVE_FAIL);
     return false;
@@ -126,7 +157,7 @@ bool Storage::saveConfigForNode(uint8_t nodeId, const String &name) {
 
   f.close();
   if (DEBUG_LEVEL & FS_DEBUG)
-    Serial.printf("[FS] Saved TX#%d -> %s\n", nodeId, name.c_str());
+    DebugSerial.printf("[FS] Saved TX#%d -> %s\n", nodeId, name.c_str());
   return true;
 }
 
@@ -134,13 +165,14 @@ bool Storage::saveConfigForNode(uint8_t nodeId, const String &name) {
 // RX-ONLY: Load a TX node configuration (used on RX boot)
 // ---------------------------------------------------------------------------
 bool Storage::loadConfigForNode(uint8_t nodeId, NodeConfig &cfg) {
+  FsLock lock;
   if (nodeId == 0 || nodeId > MAX_TX) return false;
 
   String path = String("/nodes/TX") + String(nodeId) + ".json";
   File f = LittleFS.open(path, "r");
   if (!f) {
     if (DEBUG_LEVEL & FS_DEBUG)
-      Serial.printf("[FS] loadConfigForNode: missing %s\n", path.c_str());
+      DebugSerial.printf("[FS] loadConfigForNode: missing %s\n", path.c_str());
     return false;
   }
 
@@ -149,7 +181,7 @@ bool Storage::loadConfigForNode(uint8_t nodeId, NodeConfig &cfg) {
   f.close();
   if (err) {
     if (DEBUG_LEVEL & FS_DEBUG)
-      Serial.printf("[FS] loadConfigForNode: parse error (%s)\n", path.c_str());
+      DebugSerial.printf("[FS] loadConfigForNode: parse error (%s)\n", path.c_str());
     return false;
   }
 
@@ -158,17 +190,114 @@ bool Storage::loadConfigForNode(uint8_t nodeId, NodeConfig &cfg) {
   cfg.node_name = String(doc["node_name"] | defaultName.c_str());
 
   if (DEBUG_LEVEL & FS_DEBUG)
-    Serial.printf("[FS] Loaded TX#%d -> %s\n", cfg.node_addr, cfg.node_name.c_str());
+    DebugSerial.printf("[FS] Loaded TX#%d -> %s\n", cfg.node_addr, cfg.node_name.c_str());
   return true;
 }
 
 // ---------------------------------------------------------------------------
-// Append to /errorlog.json with sticky retention policy
+// Error log: fixed records in /errorlog.bin
 // ---------------------------------------------------------------------------
-void Storage::logError(int code) {
-  const char *msg = lookupErrorMsg(code);
-  bool sticky = false;
+// The file is sized to every slot once: sticky codes ring through the first
+// ERRLOG_STICKY_RECORDS slots, the rest through the others, so transient
+// errors never evict a mount or save failure. A flush overwrites one slot
+// per record in place; nothing is ever read back on the logging path. A slot
+// whose CRC does not match (never written, torn by a reset) is ignored.
+enum : uint8_t { LOG_STICKY = 0x01 };
+
+struct __attribute__((packed)) LogRecord {
+  uint32_t seq;      // 1, 2, ... across both rings and reboots; 0 = empty slot
+  uint32_t ts;       // millis() when logged
+  uint16_t code;
+  uint16_t arg;
+  uint8_t flags;     // LOG_STICKY
+  uint8_t reserved;
+  uint16_t crc;      // CRC-16/CCITT over the bytes above
+};
+static_assert(sizeof(LogRecord) == 16, "LogRecord is the on-flash format");
+
+static const char *LOG_PATH = "/errorlog.bin";
+static const uint16_t LOG_SLOTS = ERRLOG_STICKY_RECORDS + ERRLOG_RECORDS;
+
+static bool logReady = false;    // file opened and scanned
+static uint32_t nextSeq = 1;
+static uint16_t nextSlot[2];     // per ring: slot the next record overwrites
+
+// Producers: logError() on either core. Consumer: flushLog() on core 0.
+static LogRecord pending[ERRLOG_PENDING];
+static uint8_t pendHead = 0;
+static volatile uint8_t pendCount = 0;
+
+static uint32_t logQueued = 0, logDropped = 0, logWritten = 0, logBadCrc = 0;
+static uint32_t flushes = 0, flushMax_us = 0;
+
+static uint16_t crc16(const uint8_t *p, size_t n) {
+  uint16_t crc = 0xFFFF;
+  while (n--) {
+    crc ^= (uint16_t)*p++ << 8;
+    for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+static bool recordValid(const LogRecord &r) {
+  return r.seq != 0 && r.crc == crc16((const uint8_t *)&r, offsetof(LogRecord, crc));
+}
 
+static uint8_t ringOf(const LogRecord &r) { return (r.flags & LOG_STICKY) ? 0 : 1; }
+static uint16_t ringBase(uint8_t ring) { return ring == 0 ? 0 : ERRLOG_STICKY_RECORDS; }
+static uint16_t ringSize(uint8_t ring) { return ring == 0 ? ERRLOG_STICKY_RECORDS : ERRLOG_RECORDS; }
+
+// Called from begin() once mounted: find where each ring left off. A file of
+// the wrong size (first boot, ring sizes changed) is replaced by an empty one,
+// and the JSON log it supersedes goes with it. begin() runs more than once at
+// boot; the scan only runs the first time.
+static void openLog() {
+  if (logReady) return;
+  File f = LittleFS.open(LOG_PATH, "r");
+  if (f && f.size() == LOG_SLOTS * sizeof(LogRecord)) {
+    uint32_t newest[2] = { 0, 0 };
+    LogRecord r;
+    for (uint16_t slot = 0; slot < LOG_SLOTS; slot++) {
+      if (f.read((uint8_t *)&r, sizeof(r)) != sizeof(r)) break;
+      if (!recordValid(r)) {
+        if (r.seq) logBadCrc++;
+        continue;
+      }
+      uint8_t ring = slot < ERRLOG_STICKY_RECORDS ? 0 : 1;
+      if (r.seq > newest[ring]) {
+        newest[ring] = r.seq;
+        nextSlot[ring] = (slot - ringBase(ring) + 1) % ringSize(ring);
+      }
+      if (r.seq >= nextSeq) nextSeq = r.seq + 1;
+    }
+    f.close();
+  } else {
+    if (f) f.close();
+    if (LittleFS.exists("/errorlog.json")) LittleFS.remove("/errorlog.json");
+    f = LittleFS.open(LOG_PATH, "w");
+    if (!f) return;
+    LogRecord empty = {};
+    for (uint16_t slot = 0; slot < LOG_SLOTS; slot++) f.write((const uint8_t *)&empty, sizeof(empty));
+    f.close();
+    if (DEBUG_LEVEL & FS_DEBUG) DebugSerial.printf("[FS] created %s (%u slots)\n", LOG_PATH, LOG_SLOTS);
+  }
+  logReady = true;
+}
+
+static bool takePending(LogRecord &r) {
+  LogLock lock;
+  if (!pendCount) return false;
+  r = pending[pendHead];
+  pendHead = (pendHead + 1) % ERRLOG_PENDING;
+  pendCount--;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Queue one record; the storageFlush task writes it out
+// ---------------------------------------------------------------------------
+void Storage::logError(int code, uint16_t arg) {
+  bool sticky = false;
   for (int i = 0; i < ERROR_DEF_COUNT; i++) {
     if (ERROR_DEFS[i].code == code) {
       sticky = ERROR_DEFS[i].sticky;
@@ -176,49 +305,97 @@ void Storage::logError(int code) {
     }
   }
 
-  File f = LittleFS.open("/errorlog.json", "r");
-  JsonDocument doc;
-  if (f) {
-    deserializeJson(doc, f);
-    f.close();
+  uint32_t now = millis();
+  {
+    LogLock lock;
+    if (pendCount == ERRLOG_PENDING) {
+      logDropped++;  // keep the first errors of a burst: they name the cause
+    } else {
+      LogRecord &r = pending[(pendHead + pendCount) % ERRLOG_PENDING];
+      r = {};
+      r.ts = now;
+      r.code = code;
+      r.arg = arg;
+      r.flags = sticky ? LOG_STICKY : 0;
+      pendCount++;
+      logQueued++;
+    }
   }
 
-  JsonArray errors = doc.to<JsonArray>();
-  rotateErrorLog(errors, code, msg, sticky);
+  if (DEBUG_LEVEL & FS_DEBUG) {
+    DebugSerial.printf("[ERROR %d] %s\n", code, lookupErrorMsg(code));
+  }
+}
 
-  f = LittleFS.open("/errorlog.json", "w");
-  if (f) {
-    serializeJson(errors, f);
-    f.close();
+// ---------------------------------------------------------------------------
+// Write queued records, one slot each (storageFlush task, core 0)
+// ---------------------------------------------------------------------------
+void Storage::flushLog() {
+  if (!pendCount || !logReady) return;  // unmounted: stay queued
+  FsLock lock;
+  uint32_t start = micros();
+  File f = LittleFS.open(LOG_PATH, "r+");
+  if (!f) return;
+
+  LogRecord r;
+  while (takePending(r)) {
+    uint8_t ring = ringOf(r);
+    r.seq = nextSeq++;
+    r.crc = crc16((const uint8_t *)&r, offsetof(LogRecord, crc));
+    f.seek((ringBase(ring) + nextSlot[ring]) * sizeof(LogRecord));
+    if (f.write((const uint8_t *)&r, sizeof(r)) == sizeof(r)) logWritten++;
+    nextSlot[ring] = (nextSlot[ring] + 1) % ringSize(ring);
   }
+  f.close();
 
-  if (DEBUG_LEVEL & FS_DEBUG) {
-    Serial.printf("[ERROR %d] %s\n", code, msg);
+  uint32_t took = micros() - start;
+  flushes++;
+  flushMax_us = max(flushMax_us, took);
+}
+
+// Next valid record of a ring, walking it oldest first from nextSlot;
+// left counts the slots still to visit
+static bool nextInRing(File &f, uint8_t ring, uint16_t &left, LogRecord &r) {
+  while (left) {
+    uint16_t slot = ringBase(ring) + (nextSlot[ring] + ringSize(ring) - left) % ringSize(ring);
+    left--;
+    f.seek(slot * sizeof(LogRecord));
+    if (f.read((uint8_t *)&r, sizeof(r)) == sizeof(r) && recordValid(r)) return true;
   }
+  return false;
 }
 
 // ---------------------------------------------------------------------------
-// Helper: rotate error log according to sticky policy
+// Dump the log as a JSON array, oldest first (console "errors")
 // ---------------------------------------------------------------------------
-static void rotateErrorLog(JsonArray &errors, int code, const char *msg, bool sticky) {
-  const size_t MAX_ERRORS = 10;
-
-  if (errors.size() >= MAX_ERRORS) {
-    bool evicted = false;
-    for (size_t i = 0; i < errors.size(); i++) {
-      if (!errors[i]["sticky"].as<bool>()) {
-        errors.remove(i);
-        evicted = true;
-        break;
-      }
-    }
-    if (!evicted && sticky) errors.remove(0);
-    else if (!evicted) return;
+// Each ring is already in seq order from its nextSlot on, so merging the two
+// streams the log with one record per ring in RAM.
+void Storage::exportLog(Print &out) {
+  flushLog();
+  FsLock lock;
+  File f = LittleFS.open(LOG_PATH, "r");
+  uint16_t left[2] = { ringSize(0), ringSize(1) };
+  LogRecord head[2];
+  bool have[2] = { false, false };
+  for (uint8_t ring = 0; f && ring < 2; ring++) have[ring] = nextInRing(f, ring, left[ring], head[ring]);
+
+  out.println('[');
+  while (have[0] || have[1]) {
+    uint8_t ring = have[0] && (!have[1] || head[0].seq < head[1].seq) ? 0 : 1;
+    LogRecord r = head[ring];
+    have[ring] = nextInRing(f, ring, left[ring], head[ring]);
+    out.printf("{\"seq\":%lu,\"code\":%u,\"msg\":\"%s\",\"sticky\":%s,\"ts\":%lu,\"arg\":%u}%s\n",
+               (unsigned long)r.seq, r.code, lookupErrorMsg(r.code),
+               (r.flags & LOG_STICKY) ? "true" : "false", (unsigned long)r.ts, r.arg,
+               have[0] || have[1] ? "," : "");
   }
+  out.println(']');
+  if (f) f.close();
+}
 
-  JsonObject e = errors.add<JsonObject>();
-  e["code"] = code;
-  e["msg"] = msg;
-  e["sticky"] = sticky;
-  e["ts"] = millis();
+void Storage::reportLog(Print &out) {
+  out.printf("[FS] errorlog next seq=%lu queued=%lu written=%lu dropped=%lu bad crc=%lu flushes=%lu max=%luus%s\n",
+             (unsigned long)nextSeq, (unsigned long)logQueued, (unsigned long)logWritten,
+             (unsigned long)logDropped, (unsigned long)logBadCrc, (unsigned long)flushes,
+             (unsigned long)flushMax_us, logReady ? "" : " (not mounted)");
 }
@@ -22,6 +22,11 @@ namespace Storage {
   bool saveConfigForNode(uint8_t nodeId, const String &name);
   bool loadConfigForNode(uint8_t nodeId, NodeConfig &cfg);
 
-  // Error logging
-  void logError(int code);
+  // Error log (/errorlog.bin). logError() touches only RAM, so it is safe on
+  // the radio path and from either core; arg is code-specific (the requested
+  // TX# for ERR_ASSIGN_DENIED).
+  void logError(int code, uint16_t arg = 0);
+  void flushLog();                 // storageFlush task: write queued records
+  void exportLog(Print &out);      // flushes, then the log as JSON, oldest first
+  void reportLog(Print &out);      // record count, drops, flush cost
 }
@@ -0,0 +1,215 @@
+#include "Tdma.h"
+#include "Peers.h"
+#include "Scheduler.h"
+#include "DebugSerial.h"
+
+// Slots follow in node address order, so a node's slot is its rank in the map
+static uint8_t slotRank(uint32_t map, uint8_t addr) {
+  return __builtin_popcount(map & ((1u << (addr - 1)) - 1));
+}
+
+// Robust slots are longer, so a slot starts after the sum of those before it
+static uint32_t slotsLength(uint32_t map, uint32_t robust) {
+  return __builtin_popcount(map & ~robust) * TDMA_SLOT_US + __builtin_popcount(map & robust) * TDMA_SLOT_ROBUST_US;
+}
+
+static uint32_t slotStart(uint32_t map, uint32_t robust, uint8_t addr) {
+  return slotsLength(map & ((1u << (addr - 1)) - 1), robust);
+}
+
+static uint32_t contentionLength(uint8_t basic) {
+  return basic == RATE_ROBUST ? TDMA_CONTENTION_ROBUST_US : TDMA_CONTENTION_US;
+}
+
+// ────────────────────────────────
+// RX: the schedule
+// ────────────────────────────────
+// A node keeps its slot from the first beacon after assignment or first contact
+void Tdma::allocate(uint8_t addr) {
+  uint32_t bit = 1u << (addr - 1);
+  if (!TDMA_ENABLE || (slotMap & bit)) return;
+  slotMap |= bit;
+  if (DEBUG_LEVEL & RADIO_DEBUG)
+    DebugSerial.printf("[TDMA] node %d gets slot %d\n", addr, slotRank(slotMap, addr));
+}
+
+// A dead node's slot would otherwise stretch every superframe for good
+// (at the robust length once it is silent); the next beacon leaves it out
+void Tdma::releaseSilent() {
+  for (uint32_t m = slotMap; m; m &= m - 1) {
+    uint8_t addr = __builtin_ctz(m) + 1;
+    Peer *peer = peers.find(addr);
+    if (peer && millis() - peer->lastSeen < TDMA_RELEASE_MS) continue;
+    slotMap &= ~(1u << (addr - 1));
+    slotReleases++;
+    if (DEBUG_LEVEL & RADIO_DEBUG) DebugSerial.printf("[TDMA] node %d silent, slot released\n", addr);
+  }
+}
+
+void Tdma::open(uint32_t robustMap, uint8_t basic, uint32_t retryAt_us) {
+  sfMap = slotMap;
+  sfRobustMap = robustMap;
+  sfSlots_us = slotsLength(sfMap, sfRobustMap);
+  sfLength_us = sfSlots_us + contentionLength(basic);
+  nextBeaconAt_us = retryAt_us;  // re-armed from PacketSent
+}
+
+// The superframe starts where the TXs see the beacon end
+void Tdma::beaconSent(uint32_t doneAt_us) {
+  sfPrevInterval_us = beacons ? doneAt_us - sfAnchor_us : 0;
+  sfAnchor_us = doneAt_us;
+  sfSeq++;
+  nextBeaconAt_us = doneAt_us + sfLength_us;
+  beacons++;
+}
+
+bool Tdma::inOwnSlot(uint8_t addr, uint32_t at) const {
+  uint32_t bit = 1u << (addr - 1);
+  if (!TDMA_ENABLE || !(sfMap & bit)) return false;
+  uint32_t pos = at - sfAnchor_us;
+  uint32_t start = slotStart(sfMap, sfRobustMap, addr);
+  return pos >= start && pos < start + (sfRobustMap & bit ? TDMA_SLOT_ROBUST_US : TDMA_SLOT_US);
+}
+
+// The rate to listen at, at micros() `at`
+uint8_t Tdma::slotRateAt(uint32_t at, uint8_t basic) const {
+  uint32_t pos = at - sfAnchor_us;
+  if (!RATE_ADAPT || pos >= sfSlots_us) return basic;
+  uint32_t end = 0;
+  for (uint32_t m = sfMap; m; m &= m - 1) {
+    bool robust = (sfRobustMap >> __builtin_ctz(m)) & 1;
+    end += robust ? TDMA_SLOT_ROBUST_US : TDMA_SLOT_US;
+    if (pos < end) return robust ? RATE_ROBUST : RATE_FAST;
+  }
+  return basic;
+}
+
+// ────────────────────────────────
+// TX: following the beacon
+// ────────────────────────────────
+bool Tdma::syncLost() {
+  if (!tdmaSynced || millis() - lastBeacon <= BEACON_BASE_MS) return false;
+  tdmaSynced = false;
+  mySlot = -1;
+  syncLosses++;
+  if (DEBUG_LEVEL & RADIO_DEBUG) DebugSerial.println(F("[TDMA] beacon lost, sending unslotted"));
+  return true;
+}
+
+// Re-anchors on the beacon's PayloadReady (`at`) and finds our slot in it
+void Tdma::follow(const Beacon &b, uint32_t at, uint32_t robustMap, uint8_t basic,
+                  uint32_t nextBeaconAir_us, uint8_t addr) {
+  // Drift: our interval between the two previous beacons against the RX's own
+  if (b.prevInterval_us && beacons >= 2 && beaconSeq[0] == (uint16_t)(b.seq - 1) &&
+      beaconSeq[1] == (uint16_t)(b.seq - 2)) {
+    int32_t local = (int32_t)(beaconAt_us[0] - beaconAt_us[1]);
+    int32_t ppm = (int32_t)((int64_t)(local - (int32_t)b.prevInterval_us) * 1000000 / b.prevInterval_us);
+    ppm = constrain(ppm, -1000, 1000);
+    sfDriftPpm += (ppm - sfDriftPpm) / 4;
+  }
+  beaconAt_us[1] = beaconAt_us[0];
+  beaconSeq[1] = beaconSeq[0];
+  beaconAt_us[0] = at;
+  beaconSeq[0] = b.seq;
+  beacons++;
+
+  sfAnchor_us = at;
+  sfSeq = b.seq;
+  sfMap = b.slotMap;
+  sfRobustMap = robustMap;
+  sfSlots_us = slotsLength(sfMap, sfRobustMap);
+  // The next beacon is about as long as this one
+  sfBeaconAir_us = nextBeaconAir_us;
+  sfLength_us = sfSlots_us + contentionLength(basic) + sfBeaconAir_us;
+  lastBeacon = millis();
+  contentionJitter_us = random(TDMA_CONTENTION_US / 2);
+  if (!tdmaSynced && (DEBUG_LEVEL & RADIO_DEBUG)) DebugSerial.println(F("[TDMA] synced to beacon"));
+  tdmaSynced = true;
+
+  bool listed = addr >= 1 && addr <= MAX_TX && ((b.slotMap >> (addr - 1)) & 1);
+  mySlot = listed ? slotRank(b.slotMap, addr) : -1;
+  if (listed) {
+    myRate = (sfRobustMap >> (addr - 1)) & 1 ? RATE_ROBUST : RATE_FAST;
+    mySlotAt_us = slotStart(sfMap, sfRobustMap, addr);
+    mySlotLen_us = myRate == RATE_ROBUST ? TDMA_SLOT_ROBUST_US : TDMA_SLOT_US;
+  }
+}
+
+// Superframe the TX should be listening for: the current one, or the next once
+// its beacon is due within HOP_LEAD_US (missed beacons included)
+uint16_t Tdma::ahead(uint32_t now) const {
+  return sfSeq + (now - sfAnchor_us + HOP_LEAD_US + sfBeaconAir_us) / sfLength_us;
+}
+
+// Offset into the superframe the last beacon opened, on the RX clock. Past
+// its end the layout is whatever the missed beacon announced, so stay quiet.
+bool Tdma::position(uint32_t now, uint32_t &pos) const {
+  if (!tdmaSynced) return false;
+  uint32_t local = now - sfAnchor_us;
+  pos = local - (int32_t)((int64_t)local * sfDriftPpm / 1000000);
+  return pos < sfLength_us;
+}
+
+// Slot frames wait for our slot, everything else for the contention period
+bool Tdma::windowOpen(Window w, uint32_t need_us, uint8_t basic, uint32_t now) const {
+  uint32_t pos;
+  if (!position(now, pos)) return false;
+  if (w == WIN_SLOT) return pos >= mySlotAt_us + TDMA_GUARD_US && pos + need_us <= mySlotAt_us + mySlotLen_us;
+  return pos >= sfSlots_us + TDMA_GUARD_US + contentionJitter_us && pos + need_us <= sfSlots_us + contentionLength(basic);
+}
+
+// One frame per superframe in our slot
+bool Tdma::slotOpen(uint32_t now) const {
+  uint32_t pos;
+  if (!position(now, pos) || sfSeq == slotUsedSf) return false;
+  return pos >= mySlotAt_us + TDMA_GUARD_US && pos < mySlotAt_us + mySlotLen_us - TDMA_GUARD_US;
+}
+
+// A synced node the beacon does not list asks for a slot in bursts
+bool Tdma::helloDue() {
+  if (!tdmaSynced || mySlot >= 0) {
+    helloLeft = 0;
+    return false;
+  }
+  if ((int32_t)(millis() - helloAt) < 0) return false;
+  if (helloLeft == 0) helloLeft = HELLO_BURST_K;
+  return true;
+}
+
+void Tdma::helloSent() {
+  helloLeft--;
+  helloAt = millis() + (helloLeft ? HELLO_DELTA_MS : BEACON_BASE_MS);
+}
+
+// Until the next superframe edge (ahead() moves on), a window opens for
+// pending slot work or the queued frame, or now while one is open
+uint32_t Tdma::idleBudget_us(uint32_t now, bool slotWork, Window head, uint8_t basic) const {
+  uint32_t budget = IDLE_FOREVER;
+  if (TDMA_ENABLE) {
+    uint32_t ahead = now - sfAnchor_us + HOP_LEAD_US + sfBeaconAir_us;
+    budget = sfLength_us - ahead % sfLength_us;
+  }
+  uint32_t pos;
+  if (!position(now, pos)) return budget;  // past the superframe: the next beacon IRQ re-anchors
+  // A closed window waits for the next superframe
+  auto window = [&](uint32_t openAt, uint32_t closeAt) {
+    if (pos < openAt) budget = min(budget, openAt - pos);
+    else if (pos < closeAt) budget = 0;
+  };
+  uint32_t slotEnd = mySlotAt_us + mySlotLen_us;
+  if (slotted() && slotWork && sfSeq != slotUsedSf) window(mySlotAt_us + TDMA_GUARD_US, slotEnd);
+  if (head == WIN_SLOT)
+    window(mySlotAt_us + TDMA_GUARD_US, slotEnd);
+  else if (head == WIN_CONTENTION)
+    window(sfSlots_us + TDMA_GUARD_US + contentionJitter_us, sfSlots_us + contentionLength(basic));
+  return budget;
+}
+
+void Tdma::report(Print &out, Role role) const {
+  if (role == Role::RX)
+    out.printf("[TDMA] sf=%u slots=%d length=%luus beacons=%lu released=%lu\n", sfSeq, __builtin_popcount(sfMap),
+               (unsigned long)sfLength_us, (unsigned long)beacons, (unsigned long)slotReleases);
+  else
+    out.printf("[TDMA] %s slot=%d drift=%ldppm beacons=%lu losses=%lu\n", tdmaSynced ? "synced" : "unsynced",
+               mySlot, (long)sfDriftPpm, (unsigned long)beacons, (unsigned long)syncLosses);
+}
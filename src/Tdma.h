@@ -0,0 +1,84 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "Packet.h"
+
+// ────────────────────────────────
+// TDMA superframe
+// ────────────────────────────────
+// RX: owns the schedule and beacons it; TX: follows the last beacon heard.
+// Radio builds and parses the beacons and picks what goes out in a slot;
+// this keeps the slot layout and the superframe clock.
+class Tdma {
+public:
+  // Part of the superframe a frame waits for
+  enum Window : uint8_t {
+    WIN_NONE,
+    WIN_SLOT,        // our own slot
+    WIN_CONTENTION   // after the slots
+  };
+
+  void begin(uint32_t now) { nextBeaconAt_us = now; }  // RX: the first superframe starts right away
+
+  // ───── RX ─────
+  bool beaconDue(uint32_t now) const { return (int32_t)(now - nextBeaconAt_us) >= 0; }
+  void allocate(uint8_t addr);  // granted from the next beacon on
+  void releaseSilent();         // frees slots unheard for TDMA_RELEASE_MS
+  uint32_t granted() const { return slotMap; }
+  uint32_t prevInterval_us() const { return sfPrevInterval_us; }
+  // The beacon opening the next superframe is queued; retryAt_us re-arms it if PacketSent never comes
+  void open(uint32_t robustMap, uint8_t basic, uint32_t retryAt_us);
+  void beaconSent(uint32_t doneAt_us);
+  bool inOwnSlot(uint8_t addr, uint32_t at) const;
+  uint8_t slotRateAt(uint32_t at, uint8_t basic) const;  // the owner's inside a slot, else basic
+
+  // ───── TX ─────
+  bool syncLost();  // true once, when BEACON_BASE_MS pass without a beacon
+  void follow(const Beacon &b, uint32_t at, uint32_t robustMap, uint8_t basic,
+              uint32_t nextBeaconAir_us, uint8_t addr);
+  bool synced() const { return tdmaSynced; }
+  bool slotted() const { return tdmaSynced && mySlot >= 0; }
+  int8_t slot() const { return mySlot; }
+  uint8_t slotRate() const { return myRate; }
+  uint32_t lastBeaconMs() const { return lastBeacon; }
+  uint16_t ahead(uint32_t now) const;  // superframe to listen for: the next once its beacon is near
+  bool position(uint32_t now, uint32_t &pos) const;
+  bool windowOpen(Window w, uint32_t need_us, uint8_t basic, uint32_t now) const;
+  bool slotOpen(uint32_t now) const;  // inside our slot, not yet used this superframe
+  void useSlot() { slotUsedSf = sfSeq; }
+  bool helloDue();   // a slot request should go out now
+  void helloSent();
+  uint32_t idleBudget_us(uint32_t now, bool slotWork, Window head, uint8_t basic) const;
+
+  uint16_t seq() const { return sfSeq; }
+  uint32_t anchor_us() const { return sfAnchor_us; }
+  void report(Print &out, Role role) const;
+
+private:
+  uint32_t sfAnchor_us = 0;   // end of the last beacon (RX: PacketSent, TX: PayloadReady)
+  uint16_t sfSeq = 0;         // its superframe number
+  uint32_t sfMap = 0;         // slot owners it announced
+  uint32_t sfRobustMap = 0;   // its slots at RATE_ROBUST
+  uint32_t sfSlots_us = 0;    // slot part of the superframe; contention follows
+  uint32_t sfLength_us = 0;   // anchor to next anchor, RX clock
+  uint32_t slotMap = 0;       // RX: nodes granted a slot (announced from the next beacon)
+  uint32_t sfPrevInterval_us = 0;  // RX: between the last two beacons
+  uint32_t nextBeaconAt_us = 0;    // RX
+  bool tdmaSynced = false;    // TX: a beacon arrived within BEACON_BASE_MS
+  int8_t mySlot = -1;         // TX: index of our slot in that superframe
+  uint8_t myRate = RATE_FAST; // TX: our slot's, from the last beacon listing it
+  uint32_t mySlotAt_us = 0;   // TX: our slot's offset and length in it
+  uint32_t mySlotLen_us = 0;
+  int32_t sfDriftPpm = 0;     // TX: local clock rate against the RX's, smoothed
+  uint32_t beaconAt_us[2] = {};  // TX: PayloadReady of the two previous beacons
+  uint16_t beaconSeq[2] = {};
+  uint32_t sfBeaconAir_us = 0;   // TX: the next beacon's airtime (it starts that long before the anchor)
+  uint32_t lastBeacon = 0;       // TX: millis()
+  uint32_t contentionJitter_us = 0;
+  uint16_t slotUsedSf = 0xFFFF;  // TX: superframe whose slot we last sent in
+  uint8_t helloLeft = 0;
+  uint32_t helloAt = 0;
+  uint32_t beacons = 0;       // RX: sent, TX: heard
+  uint32_t syncLosses = 0;
+  uint32_t slotReleases = 0;  // RX: slots freed after TDMA_RELEASE_MS of silence
+};
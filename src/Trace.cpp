@@ -0,0 +1,163 @@
+#include "Trace.h"
+#include "SpscRing.h"
+
+// Events are pushed from the loop context and drained by Trace::task().
+static SpscRing<TraceEvent, 128> ring;
+static LatencyHist hists[LS_COUNT] = { LatencyHist(), LatencyHist(), LatencyHist(), LatencyHist(4) };
+
+// Open intervals waiting for their closing trace point
+static const uint32_t PAIR_TIMEOUT_US = 100000;  // discard starts older than 100 ms
+static uint32_t edgeStart = 0;
+static bool edgeOpen = false;
+static uint32_t rxStart[MAX_TX + 1];
+static uint16_t rxUpstream[MAX_TX + 1];
+static bool rxOpen[MAX_TX + 1];
+static uint32_t e2eSaturatedCount = 0;
+
+static uint32_t lastReport = 0;
+
+// ────────────────────────────────
+// Histogram
+// ────────────────────────────────
+uint8_t LatencyHist::bucketOf(uint32_t us) {
+  if (us < 10000) return us / 250;  // 0..39
+  uint32_t b = 40 + (us - 10000) / 2500;
+  return b < BUCKETS ? b : BUCKETS - 1;
+}
+
+uint32_t LatencyHist::bucketUpper(uint8_t b) {
+  if (b < 40) return (b + 1) * 250;
+  return 10000 + (b - 39) * 2500;
+}
+
+void LatencyHist::add(uint32_t us) {
+  uint8_t b = bucketOf(us < (0xFFFFFFFFu >> shift) ? us << shift : 0xFFFFFFFFu);
+  bins[b]++;
+  n++;
+  if (us > max_us) max_us = us;
+}
+
+void LatencyHist::reset() {
+  memset(bins, 0, sizeof(bins));
+  n = 0;
+  max_us = 0;
+}
+
+uint32_t LatencyHist::percentile(uint8_t pct) const {
+  if (n == 0) return 0;
+  uint32_t target = (n * pct + 99) / 100;  // rank, rounded up
+  uint32_t seen = 0;
+  for (uint8_t b = 0; b < BUCKETS; b++) {
+    seen += bins[b];
+    if (seen >= target) return min(bucketUpper(b) >> shift, max_us);
+  }
+  return max_us;
+}
+
+// ────────────────────────────────
+// Trace points
+// ────────────────────────────────
+void Trace::mark(TracePoint p, uint8_t node, uint16_t tag) {
+  markAt(p, micros(), node, tag);
+}
+
+void Trace::markAt(TracePoint p, uint32_t t_us, uint8_t node, uint16_t tag) {
+  if (!LATENCY_TRACE) return;
+  ring.push({ t_us, (uint8_t)p, node, tag });
+}
+
+static void closeRx(uint8_t i, uint32_t t_us) {
+  uint32_t local = t_us - rxStart[i];
+  rxOpen[i] = false;
+  if (local > PAIR_TIMEOUT_US) return;
+  hists[LS_RX_TO_HID].add(local);
+  // A clipped upstream would put the sample below its own TX stage
+  if (rxUpstream[i] == TRACE_UPSTREAM_SATURATED) e2eSaturatedCount++;
+  else hists[LS_END_TO_END].add(local + (uint32_t)rxUpstream[i] * 100);
+}
+
+static void consume(const TraceEvent &e) {
+  switch (e.point) {
+    case TP_PCF_EDGE:
+      edgeStart = e.t_us;
+      edgeOpen = true;
+      break;
+
+    case TP_TX_SENT:
+      if (edgeOpen && (e.t_us - edgeStart) <= PAIR_TIMEOUT_US)
+        hists[LS_TX_EDGE_TO_AIR].add(e.t_us - edgeStart);
+      edgeOpen = false;
+      break;
+
+    case TP_RX_PIN:
+      if (e.node > MAX_TX) break;
+      rxStart[e.node] = e.t_us;
+      rxUpstream[e.node] = e.tag;
+      rxOpen[e.node] = true;
+      break;
+
+    case TP_PCF_IRQ:
+      hists[LS_PCF_IRQ].add(e.tag);
+      break;
+
+    case TP_HID_REPORT:
+      // One report carries the merged state of every node, so it closes all open intervals
+      for (uint8_t i = 0; i <= MAX_TX; i++) {
+        if (rxOpen[i]) closeRx(i, e.t_us);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+void Trace::task() {
+  TraceEvent e;
+  while (ring.pop(e)) {
+    if (TRACE_DUMP) {
+      Serial.printf("TRACE,%lu,%u,%u,%u\n", (unsigned long)e.t_us, e.point, e.node, e.tag);
+    }
+    consume(e);
+  }
+
+  if (millis() - lastReport >= TRACE_REPORT_MS) {
+    lastReport = millis();
+    report(Serial);
+  }
+}
+
+void Trace::report(Print &out) {
+  for (uint8_t s = 0; s < LS_COUNT; s++) {
+    const LatencyHist &h = hists[s];
+    if (h.count() == 0) continue;
+    out.printf("[TRACE] %-9s n=%lu p50=%luus p99=%luus max=%luus\n",
+               stageName((LatencyStage)s),
+               (unsigned long)h.count(),
+               (unsigned long)h.percentile(50),
+               (unsigned long)h.percentile(99),
+               (unsigned long)h.maxUs());
+  }
+  if (e2eSaturatedCount)
+    out.printf("[TRACE] e2e       %lu samples past the frame's latency scale, not counted\n",
+               (unsigned long)e2eSaturatedCount);
+  if (ring.dropped) out.printf("[TRACE] ring overflow, %lu events dropped\n", (unsigned long)ring.dropped);
+}
+
+const LatencyHist &Trace::hist(LatencyStage s) {
+  return hists[s < LS_COUNT ? s : 0];
+}
+
+uint32_t Trace::e2eSaturated() {
+  return e2eSaturatedCount;
+}
+
+const char *Trace::stageName(LatencyStage s) {
+  switch (s) {
+    case LS_TX_EDGE_TO_AIR: return "edge>air";
+    case LS_RX_TO_HID: return "rx>hid";
+    case LS_END_TO_END: return "e2e";
+    case LS_PCF_IRQ: return "irq>svc";
+    default: return "?";
+  }
+}
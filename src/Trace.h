@@ -0,0 +1,73 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+// ────────────────────────────────
+// Trace points along the input path
+// ────────────────────────────────
+enum TracePoint : uint8_t {
+  TP_PCF_EDGE = 1,   // TX: PCF8575 change observed (ISR time when /INT is wired)
+  TP_TX_SENT = 2,    // TX: PT_PIN fully on air (its PacketSent completion fired)
+  TP_RX_PIN = 3,     // RX: PT_PIN event applied in Radio::dispatchPinEvents (core 0) and changed the HID outputs (tag = TX-side latency, 100 µs units, or TRACE_UPSTREAM_SATURATED)
+  TP_HID_REPORT = 4, // RX: HID report handed to TinyUSB
+  TP_PCF_IRQ = 5     // TX: PCFInput::service took a /INT (tag = µs since the ISR)
+};
+
+// TP_RX_PIN tag: the TX-side latency was past what the frame can carry
+static const uint16_t TRACE_UPSTREAM_SATURATED = 0xFFFE;
+
+struct TraceEvent {
+  uint32_t t_us;  // micros() timestamp
+  uint8_t point;  // TracePoint
+  uint8_t node;   // TX node address (0xFF = all nodes)
+  uint16_t tag;   // point-specific payload
+};
+
+// ────────────────────────────────
+// Fixed-bucket latency histogram
+// ────────────────────────────────
+// 250 µs buckets up to 10 ms, then 2.5 ms buckets up to ~67 ms.
+// tools/latency_replay.py uses the same bucket layout.
+// A shift makes the buckets 2^shift times finer over a 2^shift times shorter
+// range, for stages measured in tens of µs.
+class LatencyHist {
+public:
+  static const uint8_t BUCKETS = 64;
+
+  explicit LatencyHist(uint8_t shift = 0) : shift(shift) {}
+
+  void add(uint32_t us);
+  void reset();
+  uint32_t percentile(uint8_t pct) const;  // upper edge of the bucket, µs
+  uint32_t maxUs() const { return max_us; }
+  uint32_t count() const { return n; }
+
+  static uint8_t bucketOf(uint32_t us);
+  static uint32_t bucketUpper(uint8_t b);
+
+private:
+  uint32_t bins[BUCKETS] = {};  // as wide as n, so every bin can reach a percentile's rank
+  uint32_t n = 0;
+  uint32_t max_us = 0;
+  uint8_t shift;
+};
+
+enum LatencyStage : uint8_t {
+  LS_TX_EDGE_TO_AIR,  // TX: PCF edge → frame sent
+  LS_RX_TO_HID,       // RX: frame decoded → HID report
+  LS_END_TO_END,      // RX: TX-side latency carried in the frame + RX_TO_HID; leaves out time
+                      // queued on the TX (CSMA, slot wait, retries) and the host's USB poll
+  LS_PCF_IRQ,         // TX: /INT ISR → PCFInput::service (includes any WFE wake-up)
+  LS_COUNT
+};
+
+namespace Trace {
+  void mark(TracePoint p, uint8_t node = 0, uint16_t tag = 0);
+  void markAt(TracePoint p, uint32_t t_us, uint8_t node = 0, uint16_t tag = 0);
+
+  void task();               // drain ring → pair events → histograms
+  void report(Print &out);   // p50/p99/max per stage
+  const LatencyHist &hist(LatencyStage s);
+  uint32_t e2eSaturated();   // e2e samples left out: TX-side latency past the frame's scale
+  const char *stageName(LatencyStage s);
+}
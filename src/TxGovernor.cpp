@@ -0,0 +1,99 @@
+#include "TxGovernor.h"
+
+static const char *const CLASS_NAMES[TXC_COUNT] = { "PIN", "HB", "ADV" };
+
+TxGovernor::TxGovernor() {
+  memset(counters, 0, sizeof(counters));
+  memset(pending, 0, sizeof(pending));
+
+  buckets[TXC_PIN] = { 0, 0, 0, 0 };
+  buckets[TXC_HB] = { GOV_HB_BURST * 1000UL, GOV_HB_BURST * 1000UL, GOV_HB_REFILL_MS, 0 };
+  buckets[TXC_ADVERTISE] = { GOV_ADV_BURST * 1000UL, GOV_ADV_BURST * 1000UL, GOV_ADV_REFILL_MS, 0 };
+}
+
+TxClass TxGovernor::classOf(uint8_t type) {
+  switch (type) {
+    case PT_PIN: return TXC_PIN;
+    case PT_HB: return TXC_HB;
+    case PT_ADVERTISE: return TXC_ADVERTISE;
+    default: return TXC_COUNT;  // not governed
+  }
+}
+
+// A milli-token must be a whole number of ms or the other way round, so the
+// time refill() credits converts back exactly
+static_assert(GOV_HB_REFILL_MS % 1000 == 0 || 1000 % GOV_HB_REFILL_MS == 0, "GOV_HB_REFILL_MS");
+static_assert(GOV_ADV_REFILL_MS % 1000 == 0 || 1000 % GOV_ADV_REFILL_MS == 0, "GOV_ADV_REFILL_MS");
+
+// The clock moves on only by the time turned into tokens: the remainder of a
+// call too soon for a whole milli-token counts toward the next one
+void TxGovernor::refill(Bucket &b, uint32_t now) {
+  uint32_t elapsed = now - b.lastRefill;
+  if (b.milliTokens >= b.capacity || elapsed >= b.refillMs * (b.capacity / 1000)) {
+    b.milliTokens = b.capacity;
+    b.lastRefill = now;
+    return;
+  }
+  uint32_t add = elapsed * 1000UL / b.refillMs;
+  b.lastRefill += add * b.refillMs / 1000UL;
+  b.milliTokens = min(b.capacity, b.milliTokens + add);
+}
+
+bool TxGovernor::tryTake(TxClass c, float duty_pct, uint32_t now) {
+  Bucket &b = buckets[c];
+  if (b.refillMs == 0) return true;  // unlimited class
+  refill(b, now);
+  if (duty_pct >= GOV_DUTY_SOFT_PCT || b.milliTokens < 1000) return false;
+  b.milliTokens -= 1000;
+  return true;
+}
+
+bool TxGovernor::admit(uint8_t type, float duty_pct, uint32_t now) {
+  TxClass c = classOf(type);
+  if (c == TXC_COUNT) return true;
+
+  // A newer frame of a class that is already waiting must queue behind it
+  if (!pending[c].valid && tryTake(c, duty_pct, now)) {
+    counters[c].sent++;
+    return true;
+  }
+  return false;
+}
+
+void TxGovernor::defer(const Packet &pkt, Role role, uint32_t now) {
+  (void)now;
+  TxClass c = classOf(pkt.type);
+  if (c == TXC_COUNT) return;
+
+  if (pending[c].valid) {
+    counters[c].coalesced++;  // only the newest HB/advert is worth sending
+  } else {
+    counters[c].deferred++;
+  }
+  pending[c] = { pkt, role, true };
+}
+
+bool TxGovernor::release(float duty_pct, uint32_t now, Packet &pkt, Role &role) {
+  for (uint8_t c = 0; c < TXC_COUNT; c++) {
+    if (!pending[c].valid) continue;
+    if (!tryTake((TxClass)c, duty_pct, now)) continue;
+
+    pkt = pending[c].pkt;
+    role = pending[c].role;
+    pending[c].valid = false;
+    counters[c].sent++;
+    return true;
+  }
+  return false;
+}
+
+void TxGovernor::report(Print &out) const {
+  for (uint8_t c = 0; c < TXC_COUNT; c++) {
+    out.printf("[GOV] %-3s sent=%lu deferred=%lu coalesced=%lu%s\n",
+               CLASS_NAMES[c],
+               (unsigned long)counters[c].sent,
+               (unsigned long)counters[c].deferred,
+               (unsigned long)counters[c].coalesced,
+               pending[c].valid ? " (waiting)" : "");
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "Packet.h"
+
+// ────────────────────────────────
+// Packet classes managed by the governor
+// ────────────────────────────────
+enum TxClass : uint8_t {
+  TXC_PIN,        // PT_PIN: always sent immediately
+  TXC_HB,         // PT_HB
+  TXC_ADVERTISE,  // PT_ADVERTISE
+  TXC_COUNT
+};
+
+struct TxClassStats {
+  uint32_t sent;       // admitted (immediately or after deferral)
+  uint32_t deferred;   // frames that had to wait
+  uint32_t coalesced;  // waiting frames replaced by a newer one
+};
+
+// ────────────────────────────────
+// Duty-cycle-aware token-bucket governor
+// ────────────────────────────────
+class TxGovernor {
+public:
+  TxGovernor();
+
+  // true → transmit now; false → caller must defer() the frame
+  bool admit(uint8_t type, float duty_pct, uint32_t now);
+  void defer(const Packet &pkt, Role role, uint32_t now);
+
+  // Hands back one deferred frame once its class may transmit again
+  bool release(float duty_pct, uint32_t now, Packet &pkt, Role &role);
+
+  const TxClassStats &stats(TxClass c) const { return counters[c]; }
+  void report(Print &out) const;
+
+  static TxClass classOf(uint8_t type);
+
+private:
+  struct Bucket {
+    uint32_t milliTokens;  // 1000 = one frame
+    uint32_t capacity;     // in milliTokens
+    uint32_t refillMs;     // ms per whole token (0 = unlimited)
+    uint32_t lastRefill;
+  };
+
+  struct Pending {
+    Packet pkt;
+    Role role;
+    bool valid;
+  };
+
+  Bucket buckets[TXC_COUNT];
+  Pending pending[TXC_COUNT];
+  TxClassStats counters[TXC_COUNT];
+
+  void refill(Bucket &b, uint32_t now);
+  bool tryTake(TxClass c, float duty_pct, uint32_t now);
+};
@@ -1,23 +1,32 @@
 #include <Wire.h>
+#include <malloc.h>
 #include "Utils.h"
 #include "Config.h"
 
+size_t heapUsed() {
+#ifdef __GLIBC__
+  return mallinfo2().uordblks;  // host simulation
+#else
+  return mallinfo().uordblks;
+#endif
+}
+
 bool i2cScanDevice(uint8_t addr) {
   Wire.beginTransmission(addr);
   return (Wire.endTransmission() == 0);
 }
 
-String formatPinDelta(uint16_t prev, uint16_t curr) {
-  String s = "";
+size_t formatPinDelta(uint16_t prev, uint16_t curr, char *out, size_t len) {
+  size_t n = 0;
+  out[0] = 0;
   uint16_t mask = prev ^ curr;  // bits that changed
-  for (int i = 0; i < 16; i++) {
+  for (int i = 0; i < 16 && n < len; i++) {
     if (mask & (1 << i)) {
-      s += PIN_NAMES[i];
       bool pressed = ((curr >> i) & 1) == PRESSED_LEVEL;
-      s += pressed ? "V " : "^ ";
+      n += snprintf(out + n, len - n, "%s%s", PIN_NAMES[i], pressed ? "V " : "^ ");
     }
   }
-  return s;
+  return min(n, len - 1);
 }
 
 // testI2CDevice must appear before detectRole
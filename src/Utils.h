@@ -2,4 +2,7 @@
 #include <Arduino.h>
 
 bool i2cScanDevice(uint8_t addr);
-String formatPinDelta(uint16_t prev, uint16_t curr);
+// "P3V P4^ " for the pins that changed, into out (always terminated); its length
+size_t formatPinDelta(uint16_t prev, uint16_t curr, char *out, size_t len);
+static const size_t PIN_DELTA_LEN = 16 * 6 + 1;  // every pin changed, longest names
+size_t heapUsed();  // bytes allocated from the heap right now
@@ -5,21 +5,26 @@
 // ────────────────────────────────
 // General build configuration constants
 // ────────────────────────────────
-#define MAX_TX 4
+#define MAX_TX 32           // highest TX node address one RX serves (sizes the static peer pool)
 #define BTN_COUNT 16
+#define HID_LAYOUT_COUNT 4  // binding layouts in Config.cpp
 
 #include "Hid.h"
 
 
-extern HidBinding hidMap[MAX_TX][BTN_COUNT];
+// Nodes share layouts by reference: node n uses hidLayouts[(n - 1) % HID_LAYOUT_COUNT]
+extern HidBinding hidLayouts[HID_LAYOUT_COUNT][BTN_COUNT];
+inline const HidBinding *hidMapFor(uint8_t addr) {
+  return hidLayouts[addr ? (addr - 1) % HID_LAYOUT_COUNT : 0];
+}
 
 
 // ────────────────────────────────
 // Radio bitrate configuration
 // ────────────────────────────────
 // Options: RH_RF69::GFSK_Rb2Fd5, RH_RF69::GFSK_Rb55Fd50, RH_RF69::GFSK_Rb250Fd250
-#define RF69_MODEM_CONFIG RH_RF69::GFSK_Rb250Fd250
-#define RF69_BITRATE_KBPS 250  // Informational only, matches config above
+#define RF69_MODEM_CONFIG RH_RF69::GFSK_Rb250Fd250  // with RATE_ADAPT: the fast rate of TDMA slots
+#define RF69_BITRATE_KBPS 250  // matches config above; frame airtime estimates use it
 
 
 // ────────────────────────────────
@@ -34,6 +39,7 @@ extern HidBinding hidMap[MAX_TX][BTN_COUNT];
 
 
 #define SCOPE_PIN -1  // optional scope pin (-1 disables)
+#define PCF_INT_PIN 24  // PCF8575 /INT (open-drain, active low); -1 disables (poll only)
 
 // ────────────────────────────────
 // Debug system
@@ -86,14 +92,32 @@ inline const char* lookupErrorMsg(int code) {
   return "UNKNOWN";
 }
 
+// ────────────────────────────────
+// Error log (Storage.cpp)
+// ────────────────────────────────
+// Fixed 16-byte CRC-checked records in /errorlog.bin, one ring for sticky
+// codes and one for the rest. Storage::logError() only queues in RAM; the
+// storageFlush task writes the queue out. Changing the ring sizes starts a
+// new, empty log.
+#define ERRLOG_RECORDS 48         // ring slots for non-sticky codes
+#define ERRLOG_STICKY_RECORDS 16  // a flood of transient errors never evicts these
+#define ERRLOG_PENDING 8          // RAM queue; further errors before the next flush are counted, not kept
+#define ERRLOG_FLUSH_MS 5000      // storageFlush task period
+
 
 // ────────────────────────────────
 // Radio configuration
 // ────────────────────────────────
 static const float RF69_FREQ_MHZ = 915.0f;
-static const int8_t RF69_TX_POWER = 2;
+static const int8_t RF69_TX_POWER = 2;  // dBm; with TPC_ENABLE TPC starts from TPC_MAX_DBM instead
 static const bool RF69_IS_HCW = true;
 
+// RX only: run RH_RF69 and the receive path on RP2040 core 1; decoded pin
+// events reach hidTask on core 0 through Radio::pinEvents (SPSC ring).
+#ifndef RADIO_ON_CORE1
+#define RADIO_ON_CORE1 1
+#endif
+
 extern uint8_t ENCRYPTKEY[16];  // defined in Config.cpp
 // ────────────────────────────────
 // Roles & addresses
@@ -123,12 +147,165 @@ extern uint16_t PCF_INVERT_MASK;   // defined in Config.cpp
 // Task intervals (system tuning knobs)
 // ────────────────────────────────
 #define OLED_INTERVAL 150
-#define PCF_POLL_MS 50
-#define HEARTBEAT_MS 10000
-#define BEACON_BASE_MS 1000
-#define JITTER_MAX_MS 25
-#define HELLO_BURST_K 2
-#define HELLO_DELTA_MS 40
+#define PCF_POLL_MS 50  // fallback poll; edges normally arrive via PCF_INT_PIN
+#define PCF_BATCH_US 0  // 0-3000: edges this soon after the first share one PT_PIN, replayed with their spacing (0 = off)
+#define SCHED_TASKS 9  // scheduler table size (main.cpp registers up to 9)
+#define CONSOLE_POLL_MS 50  // serial console (Console.cpp) line reader
+#define IDLE_ENABLE 1       // loop() sleeps (WFE) until the next deadline or interrupt (Scheduler.cpp)
+#define IDLE_MIN_US 100     // shorter gaps are spun through
+#define IDLE_EARLY_US 30    // wake this much before the deadline, for the wake-up itself
+#define HEARTBEAT_MS 2000  // with HB_JITTER_MS, bounds a stuck input once PT_PIN retries are exhausted
+#define HB_JITTER_MS 500   // random delay per heartbeat so TXs drift apart
 #define ACK_WINDOW_MS 300
 #define LINK_DOWN_MS 5000
 
+// ────────────────────────────────
+// Transmit governor (TxGovernor.cpp)
+// ────────────────────────────────
+// PT_PIN is never delayed. PT_HB / PT_ADVERTISE spend one token per frame and
+// are held (newest frame wins) while their bucket is empty or the 20 s duty
+// cycle is above GOV_DUTY_SOFT_PCT.
+#define GOV_DUTY_SOFT_PCT 5.0f
+#define GOV_HB_REFILL_MS 2000   // one heartbeat token per HEARTBEAT_MS
+#define GOV_HB_BURST 2
+#define GOV_ADV_REFILL_MS 1000  // one advertise token per 1 s
+#define GOV_ADV_BURST 2
+
+// ────────────────────────────────
+// PT_PIN reliability (Radio.cpp)
+// ────────────────────────────────
+// Every PT_PIN carries the full pin snapshot, so the TX only ever re-sends the
+// newest state (with a fresh seq) until an ACK covers it; older states are
+// never replayed. The ACK wait (plus up to 100% random jitter) doubles on every retry.
+#define PIN_ACK_TIMEOUT_MS 20
+#define PIN_BACKOFF_MAX_SHIFT 4  // 20 → 320 ms base wait
+#define PIN_RETRY_MAX 12         // then the next heartbeat snapshot repairs the RX
+#define PIN_REFRESH_BURST 0      // early copies of each new state ahead of the ACK timeout (0 = off)
+#define PIN_REFRESH_DELTA_MS 10
+#define PIN_COMPACT 1            // RX offers the compact PT_PIN format in its ACKs (0 = legacy only)
+
+// ────────────────────────────────
+// TDMA superframe (Radio.cpp)
+// ────────────────────────────────
+// The RX beacons a superframe: one uplink slot per TX holding one (granted at
+// assignment or first contact, in node address order), then a contention
+// period for adverts, assignment and slot requests. A synced TX sends its
+// PT_PIN / PT_HB only in its slot and gets the ACK in the next beacon; after
+// BEACON_BASE_MS without a beacon it falls back to unslotted sending. A slot
+// unheard for TDMA_RELEASE_MS is left out of the next beacon; its TX asks
+// again with PT_HELLO (or its next heartbeat) once it is back.
+//
+// Off by default: waiting for the slot costs every PT_PIN half a superframe
+// (N × TDMA_SLOT_US + TDMA_CONTENTION_US) on average. In rfsim, p50 edge → USB
+// goes from 2 ms to 14 ms at 4 TX and to 48 ms at 16 TX, while unslotted
+// sending with CSMA stays at 2 ms up to 16 TX. What TDMA buys is a bound:
+// slot frames never collide and edge → air stays within one superframe
+// however busy the channel gets, where unslotted retries back off up to
+// PIN_BACKOFF_MAX_SHIFT. Turn it on for many TXs on a busy or hostile
+// channel; hopping, rate adaptation and power control ride on it.
+#ifndef TDMA_ENABLE
+#define TDMA_ENABLE 0
+#endif
+#define TDMA_SLOT_US 5000         // one frame + guards; keep ≥ the RX radio poll period (5 ms without RADIO_ON_CORE1)
+#define TDMA_GUARD_US 300         // margin at each slot edge for IRQ latency and drift
+#define TDMA_CONTENTION_US 10000  // unslotted traffic, each TX starts at a random point in its first half
+#define BEACON_BASE_MS 1000       // TX: beacon silence before falling back to unslotted sending
+#define HELLO_BURST_K 2           // PT_HELLO slot requests per burst from a synced TX without a slot
+#define HELLO_DELTA_MS 40
+#define TDMA_RELEASE_MS 30000     // ≥ RATE_KEEP_MS, so a fading link gets its robust-rate slot first
+
+
+// ────────────────────────────────
+// Frequency hopping (Radio.cpp)
+// ────────────────────────────────
+// One channel per TDMA superframe, in an order derived from ENCRYPTKEY, so
+// nodes sharing a key share the sequence. Channel i is RF69_FREQ_MHZ +
+// i × HOP_SPACING_KHZ. The RX scores each channel (PT_PIN seq gaps, RSSI of
+// the quiet gap before its beacon) and drops bad ones from the hop set it
+// announces in the beacon; they are probed again after HOP_BLACKLIST_MS.
+// On with TDMA_ENABLE (it needs it), and the same setting on every node.
+#define HOP_ENABLE TDMA_ENABLE
+#define HOP_CHANNELS 8            // ≤ 16 (Beacon::hopMask)
+#define HOP_SPACING_KHZ 1000      // 250 kbps / 250 kHz deviation occupies about 750 kHz
+#define HOP_LEAD_US 400           // TX: retune this long before the next beacon is due
+#define HOP_PARK_MS 1500          // TX without a beacon: dwell per channel while searching
+#define HOP_SCORE_VISITS 16       // RX: superframes on a channel per verdict
+#define HOP_BAD_PCT 25            // frame loss or busy samples above this → blacklist
+#define HOP_MIN_CHANNELS 3        // never hop over fewer
+#define HOP_BLACKLIST_MS 30000
+
+
+// ────────────────────────────────
+// Per-link rate adaptation (Radio.cpp)
+// ────────────────────────────────
+// Each TDMA slot runs at the rate its link carries: RF69_MODEM_CONFIG, or
+// RATE_ROBUST_CONFIG once the RX sees that node's RSSI or PT_PIN loss degrade
+// (or hears nothing from it). The RX decides while building each beacon and
+// lists the robust slots in it, so both ends switch with the superframe that
+// beacon opens. Beacons and contention traffic use the basic rate: robust
+// while any robust link is alive, else fast. The RX announces a basic-rate
+// change RATE_ANNOUNCE_SF superframes ahead, and a TX that missed it finds
+// the beacons again by alternating its listen rate.
+// On with TDMA_ENABLE (it needs it), and the same setting on every node.
+#define RATE_ADAPT TDMA_ENABLE
+#define RATE_ROBUST_CONFIG RH_RF69::GFSK_Rb55555Fd50
+#define RATE_ROBUST_BPS 55555
+#define TDMA_SLOT_ROBUST_US 7000          // a 20-byte Packet is on air for about 5.9 ms at 55.5 kbps
+#define TDMA_CONTENTION_ROBUST_US 15000   // TDMA_CONTENTION_US with room for the longer frames
+#define RATE_DOWN_DBM -90                 // smoothed RSSI below this → robust (about -97 dBm sensitivity at 250 kbps)
+#define RATE_UP_DBM -82                   // above this for RATE_HOLD_MS → fast again
+#define RATE_LOSS_PCT 20                  // PT_PIN seq gaps over a RATE_WINDOW-frame window → robust
+#define RATE_WINDOW 16
+#define RATE_HOLD_MS 10000
+#define RATE_SILENT_MS (2 * (HEARTBEAT_MS + HB_JITTER_MS))  // two heartbeats missed → robust
+#define RATE_KEEP_MS 30000                // a robust link unheard this long no longer holds the basic rate
+#define RATE_ANNOUNCE_SF 4
+#define RATE_SEARCH_MS 750                // TX without a beacon: listen at each rate in turn (≤ HOP_PARK_MS / 2)
+
+
+// ────────────────────────────────
+// Transmit power control (Radio.cpp)
+// ────────────────────────────────
+// Each beacon reports the RSSI of every slot owner's newest frame of the
+// superframe before. A TX steers its power toward TPC_TARGET_DBM at the RX,
+// ignoring reports within ±TPC_HYST_DB, on frames sent before its last
+// change, or sooner than TPC_STEP_MS after it. Slot frames the RX never
+// heard, a retried PT_PIN while unslotted and a lost beacon all raise power.
+// TXs report their power in heartbeats; the RX derives each link's path loss
+// from it and sends beacons loud enough to reach the weakest at the target.
+// Both ends boot at TPC_MAX_DBM, and the RX returns there with no live link,
+// so a node joining from afar hears the beacon before anything is sized; a TX
+// then sizes itself on the beacon's RSSI until its first report.
+// On with TDMA_ENABLE (it needs it).
+#define TPC_ENABLE TDMA_ENABLE
+#define TPC_TARGET_DBM -75
+#define TPC_HYST_DB 4
+#define TPC_STEP_UP_DB 6              // weak links recover fast…
+#define TPC_STEP_DOWN_DB 2            // …strong ones back off gently
+#define TPC_STEP_MS 500
+#define TPC_MISSES 2                  // slot frames in a row the RX didn't hear → step up
+#define TPC_MIN_DBM (RF69_IS_HCW ? -2 : -18)  // RH_RF69::setTxPower() range
+#define TPC_MAX_DBM (RF69_IS_HCW ? 20 : 13)
+
+
+// ────────────────────────────────
+// Listen before talk (Radio.cpp)
+// ────────────────────────────────
+// Frames outside the node's own TDMA slot sample RssiValue (reg 0x24) before
+// they start; while it reads busy the frame waits a random backoff whose
+// ceiling doubles per busy sample, and goes out anyway after CSMA_MAX_TRIES.
+#define CSMA_ENABLE 1
+#define CSMA_BUSY_DBM -90          // at or above: someone is on air (sensitivity is about -97 dBm at 250 kbps)
+#define CSMA_LISTEN_US 150         // receiver start-up before the first valid RSSI sample
+#define CSMA_BACKOFF_US 500        // first backoff ceiling
+#define CSMA_BACKOFF_MAX_SHIFT 3   // 500 us → 4 ms
+#define CSMA_MAX_TRIES 6
+
+
+// ────────────────────────────────
+// Latency tracing (Trace.cpp)
+// ────────────────────────────────
+#define LATENCY_TRACE 1        // 0 turns every trace point into a no-op
+#define TRACE_DUMP 0           // 1 prints raw TRACE,... lines for tools/latency_replay.py
+#define TRACE_DRAIN_MS 100     // ring drain / histogram update period
+#define TRACE_REPORT_MS 10000  // serial p50/p99/max summary period
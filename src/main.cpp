@@ -9,14 +9,43 @@
 #include "Hid.h"
 #include "Storage.h"  // NEW
 #include "Peers.h"    // NEW
+#include "Trace.h"
+#include "Console.h"
+#include "DebugSerial.h"
 
 Role role;
-Scheduler scheduler;
+StaticScheduler<SCHED_TASKS> scheduler;
 Radio radio;
 RejoinFSM rejoinFSM;
 OledUI oledUI;
 PCFInput pcfInput;
 
+// RX dual-core mode: core 1 owns RH_RF69 once setup() has finished
+static volatile bool radioCoreStart = false;
+
+static bool radioOnCore1() {
+  return RADIO_ON_CORE1 && role == Role::RX;
+}
+
+// Received frames are dispatched as soon as the PayloadReady IRQ posts them
+static void serviceRadioRx() {
+  if (radioOnCore1()) return;  // core 1 polls its own
+  radio.serviceRx();
+  if (role == Role::RX) radio.dispatchPinEvents();
+}
+
+
+// TX: sleep until the next task, radio or batch deadline. The radio, PCF /INT
+// and USB IRQs end it early. The RX stays awake: it is USB-powered, and core 1
+// hands it pin events without an interrupt.
+static void idleUntilDue() {
+  if (role != Role::TX) return;
+  uint32_t now = micros();
+  uint32_t budget = scheduler.idleBudget_us(now);
+  budget = min(budget, pcfInput.idleBudget_us(now));
+  budget = min(budget, radio.idleBudget_us(now));
+  scheduler.idle(budget);
+}
 
 void setup() {
   hidBegin();
@@ -60,32 +89,39 @@ void setup() {
   // Init OLED
   oledUI.begin(role);
 
-  // Init radio
-  radio.begin(role);
+  // Init radio (RX dual-core: deferred to setup1 so its IRQ lands on core 1)
+  if (!radioOnCore1()) {
+    radio.begin(role);
+  }
 
   // Init PCF if TX
   if (role == Role::TX) {
     pcfInput.begin();
   }
 
-  // Setup tasks
-  scheduler.addTask("radioRx", 5, [&] {
-    radio.task(role);
-  });
+  // Setup tasks (frames are dispatched from the loop; radioRx keeps the timers).
+  // Input and radio come first; display, logging and reports only fill the gaps.
+  scheduler.setUrgent(serviceRadioRx);
+  if (!radioOnCore1()) {
+    scheduler.addTask("radioRx", 5, [&] {
+      radio.task(role);
+      radio.dispatchPinEvents();
+    }, PRIO_HIGH);
+  }
 
   scheduler.addTask("rejoin", 30, [&] {
     rejoinFSM.taskRun(radio, role);
   });
 
   if (role == Role::TX) {
-    scheduler.addTask("pcfPoll", 50, [&] {
+    scheduler.addTask("pcfPoll", PCF_POLL_MS, [&] {
       pcfInput.taskPoll(radio);
-    });
+    }, PRIO_HIGH);
   } else {
-    // placeholder for something like
+    // Repeats only; reports are pushed on press/release and by hidService()
     scheduler.addTask("hidTask", 10, [&] {
       hidTask();
-    });
+    }, PRIO_HIGH);
   }
   scheduler.addTask("heartbeat", HEARTBEAT_MS, [&] {
     rejoinFSM.taskHeartbeat(radio, role);
@@ -93,7 +129,7 @@ void setup() {
 
   scheduler.addTask("oled", OLED_INTERVAL, [&] {
     oledUI.taskUpdate(radio, pcfInput, role);
-  });
+  }, PRIO_LOW, TASK_FIXED_DELAY);
 
   // --- NEW: periodic background tasks ---
   scheduler.addTask("peerMonitor", 10000, [&] {
@@ -106,14 +142,66 @@ void setup() {
       Serial.print(PeerConfig::getNodeAddr());
       Serial.println(F(") OK"));
     }
-  });
+    if (DEBUG_LEVEL & RADIO_DEBUG) {
+      radio.report(Serial);
+    }
+    if (DEBUG_LEVEL & SCHED_DEBUG) {
+      scheduler.report(Serial);
+    }
+  }, PRIO_LOW);
 
-  scheduler.addTask("storageFlush", 5000, [&] {
-    // Reserved for future log/error persistence
-    // (e.g., write queued error data, clean old logs)
-  });
+  scheduler.addTask("trace", TRACE_DRAIN_MS, [&] {
+    Trace::task();
+  }, PRIO_LOW, TASK_FIXED_DELAY);
+
+  scheduler.addTask("storageFlush", ERRLOG_FLUSH_MS, [&] {
+    Storage::flushLog();  // errors queued by Storage::logError()
+  }, PRIO_LOW, TASK_FIXED_DELAY);
+
+  scheduler.addTask("console", CONSOLE_POLL_MS, [&] {
+    Console::task(scheduler, radio);
+  }, PRIO_LOW, TASK_FIXED_DELAY);
+
+  scheduler.sealHeap();
+  radioCoreStart = true;
 }
 
 void loop() {
+  // Edge-triggered input path: read + send within this iteration
+  if (role == Role::TX) {
+    pcfInput.service(radio);
+  }
+  if (role == Role::RX) radio.serviceAssignSaves();  // flash writes stay on core 0
+  if (radioOnCore1()) {
+    radio.dispatchPinEvents();
+  } else {
+    radio.serviceTx();  // reap PacketSent, start next queued frame
+  }
+  serviceRadioRx();
+  hidService();
+  DebugSerial.drain();  // core 1's lines go out from here
   scheduler.tick();
+  idleUntilDue();
+}
+
+#if RADIO_ON_CORE1
+// ────────────────────────────────
+// Core 1: radio receive path (RX role only)
+// ────────────────────────────────
+void setup1() {
+  while (!radioCoreStart) {
+    delay(1);
+  }
+  if (radioOnCore1()) {
+    radio.begin(role);  // attaches the RFM69 IRQ on this core
+  }
+}
+
+void loop1() {
+  if (radioOnCore1()) {
+    radio.task(role);
+  } else {
+    delay(100);  // TX keeps the radio on core 0
+  }
 }
+#endif
@@ -0,0 +1,60 @@
+// ────────────────────────────────
+// Rolling airtime window: cost per packet against packets per window
+// ────────────────────────────────
+// recordAirtime()/computeAirtime() run for every frame sent. With 20 one-
+// second buckets their cost must not depend on how many frames the 20 s
+// window holds, and the duty cycle must stay right well past the 64 frames
+// the old per-frame buffer could hold.
+#include <unity.h>
+#include <stdio.h>
+#include "Firmware.h"
+
+typedef uint64_t (*BenchAirtimeFn)(uint32_t packets, uint32_t gap_us, uint32_t air_us, float *duty_pct);
+
+static const uint32_t WINDOW_US = 20000000;
+static const uint32_t AIR_US = 1000;
+static const uint32_t PACKETS = 50000;
+static const int REPEATS = 5;
+
+static Medium medium;
+static BenchAirtimeFn bench = nullptr;
+
+void setUp() {}
+void tearDown() {}
+
+// Best of REPEATS, in ns per packet
+static double costPerPacket(uint32_t perWindow, float &duty) {
+  uint64_t best = UINT64_MAX;
+  for (int r = 0; r < REPEATS; r++) {
+    uint64_t ns = bench(PACKETS, WINDOW_US / perWindow, AIR_US, &duty);
+    if (ns < best) best = ns;
+  }
+  return (double)best / PACKETS;
+}
+
+static void test_cost_flat_and_duty_correct() {
+  static const uint32_t perWindow[] = { 50, 1000, 5000 };
+  double cost[3];
+  for (int i = 0; i < 3; i++) {
+    float duty = 0;
+    cost[i] = costPerPacket(perWindow[i], duty);
+    float expected = perWindow[i] * (float)AIR_US * 100.0f / WINDOW_US;
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%u packets/window: %.1f ns/packet, duty %.2f%% (expected %.2f%%)",
+             perWindow[i], cost[i], duty, expected);
+    TEST_MESSAGE(msg);
+    // One 1 s bucket of the 20 is always partly filled
+    TEST_ASSERT_FLOAT_WITHIN(expected * 0.06f, expected, duty);
+  }
+  // 100x the packets per window may not cost 2x per packet
+  TEST_ASSERT_TRUE_MESSAGE(cost[1] <= cost[0] * 2.0 + 20.0, "cost grows with packets per window");
+  TEST_ASSERT_TRUE_MESSAGE(cost[2] <= cost[0] * 2.0 + 20.0, "cost grows with packets per window");
+}
+
+int main() {
+  if (!loadSingleNode(medium, "TX1", "sim_bench_airtime", bench)) return 1;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_cost_flat_and_duty_correct);
+  return UNITY_END();
+}
@@ -0,0 +1,183 @@
+// ────────────────────────────────
+// Error log (/errorlog.bin): ring wrap, sticky isolation, rescan after reboot
+// ────────────────────────────────
+// Driven through Storage::logError/flushLog/exportLog on one node instance;
+// a reboot hands the file to a fresh instance, whose openLog() must pick up
+// both rings where they left off. The export must come out in seq order
+// with no gaps, holding the newest ERRLOG_RECORDS transient records and
+// every sticky one however many transient errors followed them.
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "Config.h"
+#include "Firmware.h"
+#include "Rfsim.h"
+
+struct Entry {
+  uint32_t seq, code, arg;
+  bool sticky;
+};
+
+static Medium medium;
+
+void setUp() {}
+
+void tearDown() {
+  for (SimNodeHandle &h : medium.nodes) unloadNode(h);
+  medium.nodes.clear();
+}
+
+// A node with LittleFS mounted and, if given, the previous boot's log file
+// (or the JSON log of firmware from before the binary one)
+static SimNodeHandle &boot(const std::vector<uint8_t> &image = {}, const char *legacyJson = nullptr) {
+  SimNodeHandle &h = medium.nodes.emplace_back();
+  h.label = "RX";
+  h.cfg.index = (uint8_t)(medium.nodes.size() - 1);
+  TEST_ASSERT_TRUE_MESSAGE(loadNode(defaultFirmwarePath(), h), "firmware did not load");
+  h.attach(&medium, &h.cfg);
+  void (*write)(const char *, const uint8_t *, uint32_t);
+  bool (*begin)();
+  TEST_ASSERT_TRUE(findExport(h, "sim_fs_write", write) && findExport(h, "sim_storage_begin", begin));
+  if (!image.empty()) write("/errorlog.bin", image.data(), image.size());
+  if (legacyJson) write("/errorlog.json", (const uint8_t *)legacyJson, strlen(legacyJson));
+  TEST_ASSERT_TRUE(begin());
+  return h;
+}
+
+static std::vector<uint8_t> flashImage(SimNodeHandle &h) {
+  uint32_t (*read)(const char *, uint8_t *, uint32_t);
+  TEST_ASSERT_TRUE(findExport(h, "sim_fs_read", read));
+  std::vector<uint8_t> image(read("/errorlog.bin", nullptr, 0));
+  read("/errorlog.bin", image.data(), image.size());
+  return image;
+}
+
+// Flushed one by one: the RAM queue holds only ERRLOG_PENDING
+static void logErrors(SimNodeHandle &h, int code, uint16_t firstArg, int count) {
+  void (*logError)(int, uint16_t);
+  void (*flush)();
+  TEST_ASSERT_TRUE(findExport(h, "sim_log_error", logError) && findExport(h, "sim_log_flush", flush));
+  for (int i = 0; i < count; i++) {
+    medium.advance(1000);
+    logError(code, firstArg + i);
+    flush();
+  }
+}
+
+static std::vector<Entry> exportLog(SimNodeHandle &h) {
+  uint32_t (*exportFn)(char *, uint32_t);
+  TEST_ASSERT_TRUE(findExport(h, "sim_log_export", exportFn));
+  static char json[16384];
+  TEST_ASSERT_LESS_THAN_UINT32(sizeof(json), exportFn(json, sizeof(json)));
+  std::vector<Entry> log;
+  for (const char *p = strstr(json, "{\"seq\":"); p; p = strstr(p + 1, "{\"seq\":")) {
+    Entry e;
+    char sticky[6] = {};
+    TEST_ASSERT_EQUAL_INT(4, sscanf(p, "{\"seq\":%u,\"code\":%u,\"msg\":\"%*[^\"]\",\"sticky\":%5[a-z],\"ts\":%*u,\"arg\":%u",
+                                    &e.seq, &e.code, sticky, &e.arg));
+    e.sticky = strcmp(sticky, "true") == 0;
+    log.push_back(e);
+  }
+  return log;
+}
+
+static uint32_t countSticky(const std::vector<Entry> &log) {
+  uint32_t n = 0;
+  for (const Entry &e : log) n += e.sticky;
+  return n;
+}
+
+// Oldest first
+static void checkOrdered(const std::vector<Entry> &log) {
+  for (size_t i = 1; i < log.size(); i++) TEST_ASSERT_GREATER_THAN_UINT32(log[i - 1].seq, log[i].seq);
+}
+
+static void test_ring_wrap() {
+  SimNodeHandle &h = boot();
+  logErrors(h, ERR_JSON_PARSE, 0, ERRLOG_RECORDS * 2 + 5);
+  std::vector<Entry> log = exportLog(h);
+  checkOrdered(log);
+  TEST_ASSERT_EQUAL_UINT32(ERRLOG_RECORDS, log.size());
+  // The newest ERRLOG_RECORDS survive, oldest first
+  TEST_ASSERT_EQUAL_UINT32(ERRLOG_RECORDS + 5, log.front().arg);
+  TEST_ASSERT_EQUAL_UINT32(ERRLOG_RECORDS * 2 + 4, log.back().arg);
+  TEST_ASSERT_EQUAL_UINT32(log.front().seq + ERRLOG_RECORDS - 1, log.back().seq);
+}
+
+static void test_sticky_survives_transient_flood() {
+  SimNodeHandle &h = boot();
+  logErrors(h, ERR_SAVE_FAIL, 0, 3);
+  logErrors(h, ERR_JSON_PARSE, 100, ERRLOG_RECORDS * 3);
+  logErrors(h, ERR_FS_MOUNT_FAIL, 200, 1);
+  std::vector<Entry> log = exportLog(h);
+  checkOrdered(log);
+  TEST_ASSERT_EQUAL_UINT32(ERRLOG_RECORDS + 4, log.size());
+  TEST_ASSERT_EQUAL_UINT32(4, countSticky(log));
+  // The sticky ones are the oldest three and the newest
+  for (int i = 0; i < 3; i++) {
+    TEST_ASSERT_EQUAL_UINT32(ERR_SAVE_FAIL, log[i].code);
+    TEST_ASSERT_EQUAL_UINT32(i, log[i].arg);
+  }
+  TEST_ASSERT_EQUAL_UINT32(ERR_FS_MOUNT_FAIL, log.back().code);
+
+  // And sticky codes wrap only their own ring
+  logErrors(h, ERR_LOAD_FAIL, 300, ERRLOG_STICKY_RECORDS + 2);
+  log = exportLog(h);
+  checkOrdered(log);
+  TEST_ASSERT_EQUAL_UINT32(ERRLOG_STICKY_RECORDS, countSticky(log));
+  TEST_ASSERT_EQUAL_UINT32(ERRLOG_RECORDS, log.size() - countSticky(log));
+}
+
+static void test_rescan_after_reboot() {
+  SimNodeHandle &first = boot();
+  logErrors(first, ERR_SAVE_FAIL, 0, ERRLOG_STICKY_RECORDS / 2);
+  logErrors(first, ERR_JSON_PARSE, 100, ERRLOG_RECORDS + ERRLOG_RECORDS / 2);  // wrapped mid-ring
+  std::vector<Entry> before = exportLog(first);
+  std::vector<uint8_t> image = flashImage(first);
+
+  SimNodeHandle &second = boot(image);
+  TEST_ASSERT_EQUAL_UINT32(before.size(), exportLog(second).size());
+  logErrors(second, ERR_JSON_PARSE, 500, 10);
+  logErrors(second, ERR_LOAD_FAIL, 600, ERRLOG_STICKY_RECORDS / 2 + 3);
+  std::vector<Entry> after = exportLog(second);
+  checkOrdered(after);
+  char msg[96];
+  snprintf(msg, sizeof(msg), "before reboot seq %u..%u, after %u..%u", before.front().seq, before.back().seq,
+           after.front().seq, after.back().seq);
+  TEST_MESSAGE(msg);
+
+  // seq carries on across the reboot, and each ring overwrote its oldest records, not its newest
+  TEST_ASSERT_EQUAL_UINT32(before.back().seq + 10 + ERRLOG_STICKY_RECORDS / 2 + 3, after.back().seq);
+  TEST_ASSERT_EQUAL_UINT32(ERRLOG_STICKY_RECORDS + ERRLOG_RECORDS, after.size());
+  std::vector<Entry> transient;
+  for (const Entry &e : after)
+    if (!e.sticky) transient.push_back(e);
+  TEST_ASSERT_EQUAL_UINT32(100 + ERRLOG_RECORDS / 2 + 10, transient.front().arg);
+  TEST_ASSERT_EQUAL_UINT32(509, transient.back().arg);
+  TEST_ASSERT_EQUAL_UINT32(3, after.front().arg);  // sticky: the first three of the first boot are gone
+  TEST_ASSERT_EQUAL_UINT32(ERR_SAVE_FAIL, after.front().code);
+}
+
+// The first binary log replaces the JSON one; mounting again (PeerConfig::begin
+// does) neither rescans nor recreates it
+static void test_legacy_json_removed() {
+  SimNodeHandle &h = boot({}, "[{\"code\":1,\"ts\":0}]");
+  uint32_t (*read)(const char *, uint8_t *, uint32_t);
+  bool (*begin)();
+  TEST_ASSERT_TRUE(findExport(h, "sim_fs_read", read) && findExport(h, "sim_storage_begin", begin));
+  TEST_ASSERT_EQUAL_UINT32(0, read("/errorlog.json", nullptr, 0));
+  logErrors(h, ERR_JSON_PARSE, 0, 3);
+  TEST_ASSERT_TRUE(begin());
+  TEST_ASSERT_EQUAL_UINT32(3, exportLog(h).size());
+}
+
+int main() {
+  medium.nodes.reserve(4);  // boot() hands out references
+  UNITY_BEGIN();
+  RUN_TEST(test_ring_wrap);
+  RUN_TEST(test_sticky_survives_transient_flood);
+  RUN_TEST(test_rescan_after_reboot);
+  RUN_TEST(test_legacy_json_removed);
+  return UNITY_END();
+}
@@ -0,0 +1,57 @@
+// ────────────────────────────────
+// TxGovernor token buckets under fast and uneven polling
+// ────────────────────────────────
+// The TX asks the governor from loop(), often every millisecond. However
+// often it asks, a class must get its burst plus one frame per refill period
+// over the run: a call too soon for a whole milli-token may not throw the
+// elapsed time away.
+#include <unity.h>
+#include <stdio.h>
+#include "Config.h"
+#include "Packet.h"
+#include "Firmware.h"
+#include "Rfsim.h"
+
+typedef uint32_t (*BenchGovernorFn)(uint8_t type, uint32_t poll_ms, uint32_t duration_ms);
+
+static const uint32_t RUN_MS = 60000;
+
+static Medium medium;
+static BenchGovernorFn bench = nullptr;
+
+void setUp() {}
+void tearDown() {}
+
+static void checkRate(uint8_t type, const char *name, uint32_t refillMs, uint32_t burst, uint32_t pollMs) {
+  uint32_t want = burst + RUN_MS / refillMs;
+  uint32_t got = bench(type, pollMs, RUN_MS);
+  char msg[96];
+  snprintf(msg, sizeof(msg), "%s polled every %u ms: %u frames in %u s (expected %u)", name, pollMs, got,
+           RUN_MS / 1000, want);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_UINT32_WITHIN_MESSAGE(1, want, got, msg);
+}
+
+static void test_heartbeat_polled_every_ms() {
+  checkRate(PT_HB, "HB", GOV_HB_REFILL_MS, GOV_HB_BURST, 1);
+}
+
+static void test_advertise_polled_every_ms() {
+  checkRate(PT_ADVERTISE, "ADV", GOV_ADV_REFILL_MS, GOV_ADV_BURST, 1);
+}
+
+// Periods that do not divide the refill time
+static void test_uneven_poll_periods() {
+  static const uint32_t polls[] = { 3, 7, 333, 1300 };
+  for (uint32_t poll : polls) checkRate(PT_HB, "HB", GOV_HB_REFILL_MS, GOV_HB_BURST, poll);
+}
+
+int main() {
+  if (!loadSingleNode(medium, "TX1", "sim_bench_governor", bench)) return 1;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_heartbeat_polled_every_ms);
+  RUN_TEST(test_advertise_polled_every_ms);
+  RUN_TEST(test_uneven_poll_periods);
+  return UNITY_END();
+}
@@ -0,0 +1,47 @@
+// ────────────────────────────────
+// No heap after setup()
+// ────────────────────────────────
+// The firmware allocates what it needs while booting and never again: peers
+// come from a fixed pool, names are char arrays and the serial log formats on
+// the stack. sim/arduino/SimHeap.cpp counts every malloc/new a node makes
+// once setup() has returned, whichever context makes it (urgent hook,
+// loop(), ISRs), and prints a backtrace of the first; both builds must stay
+// at zero through assignment, chords, loss and rate/slot changes.
+#include <unity.h>
+#include <stdio.h>
+#include "Firmware.h"
+#include "Rfsim.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void runSealed(const char *lib) {
+  SimOptions opt;
+  opt.txCount = 8;
+  opt.seconds = 20;
+  opt.chord = 3;
+  opt.lossPct = 10;
+  opt.firmware = defaultFirmwarePath(lib);
+  SimResult res;
+  TEST_ASSERT_TRUE_MESSAGE(runSim(opt, res), "firmware did not load");
+  char msg[80];
+  snprintf(msg, sizeof(msg), "%s: %u allocations after setup()", lib, res.heapAllocs);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, res.observed);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.heapAllocs, msg);
+}
+
+static void test_default_build() {
+  runSealed("libfirmware.so");
+}
+
+static void test_tdma_build() {
+  runSealed("libfirmware_tdma.so");
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_default_build);
+  RUN_TEST(test_tdma_build);
+  return UNITY_END();
+}
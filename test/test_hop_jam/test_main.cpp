@@ -0,0 +1,81 @@
+// ────────────────────────────────
+// Frequency hopping: retune cost and throughput under a jammer
+// ────────────────────────────────
+// tuneChannel() writes RegFrf values cached at boot in one SPI burst instead
+// of setFrequency()'s float math and three register writes; on hardware the
+// SPI transfers dominate, the host ns (SPI is free in the sim) are shown for
+// the CPU part only. With hopping (libfirmware_tdma.so) an 80 % duty jammer
+// on two of the channels, the home channel among them, must cost almost no
+// input once the RX has blacklisted them; the single-channel build collapses
+// under the same jammer.
+#include <unity.h>
+#include <stdio.h>
+#include "Config.h"
+#include "Firmware.h"
+#include "Rfsim.h"
+
+typedef uint64_t (*BenchTuneFn)(uint32_t n, uint64_t *setFreqNs, uint32_t *cachedSpi, uint32_t *setFreqSpi);
+
+static const uint32_t RETUNES = 100000;
+
+static Medium medium;
+static BenchTuneFn bench = nullptr;
+
+void setUp() {}
+void tearDown() {}
+
+static void test_retune_cost() {
+  uint64_t setFreqNs = 0;
+  uint32_t cachedSpi = 0, setFreqSpi = 0;
+  uint64_t cachedNs = bench(RETUNES, &setFreqNs, &cachedSpi, &setFreqSpi);
+  char msg[128];
+  snprintf(msg, sizeof(msg), "setFrequency %u SPI transfers, %.1f ns CPU; cached RegFrf %u SPI transfer, %.1f ns CPU",
+           setFreqSpi, (double)setFreqNs / RETUNES, cachedSpi, (double)cachedNs / RETUNES);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_EQUAL_UINT32(3, setFreqSpi);
+  TEST_ASSERT_EQUAL_UINT32(1, cachedSpi);
+}
+
+static SimResult runJammed(const char *lib, bool jam) {
+  SimOptions opt;
+  opt.txCount = 4;
+  opt.seconds = 60;
+  opt.firmware = defaultFirmwarePath(lib);
+  if (jam) {
+    opt.jamMhz = { RF69_FREQ_MHZ, RF69_FREQ_MHZ + 2 * HOP_SPACING_KHZ / 1000.0f };
+    opt.jamDutyPct = 80;
+  }
+  SimResult res;
+  TEST_ASSERT_TRUE_MESSAGE(runSim(opt, res), "firmware did not load");
+  char msg[112];
+  snprintf(msg, sizeof(msg), "%s%s: %u of %u edges at USB, p99 %u us, %u collided", lib, jam ? " jammed" : "",
+           res.observed, res.edges, res.p99_us, res.air.collided);
+  TEST_MESSAGE(msg);
+  return res;
+}
+
+static void test_hopping_recovers_under_jammer() {
+  SimResult clear = runJammed("libfirmware_tdma.so", false);
+  SimResult jammed = runJammed("libfirmware_tdma.so", true);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, clear.observed);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(clear.observed * 95 / 100, jammed.observed);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, jammed.heldAtEnd, "outputs held at end");
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, jammed.neverReleased, "releases never seen");
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, jammed.slowReleases, "releases more than 1 s late");
+}
+
+// The reference point: one fixed channel under the same jammer
+static void test_single_channel_collapses() {
+  SimResult jammed = runJammed("libfirmware.so", true);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(jammed.edges / 10, jammed.observed);
+}
+
+int main() {
+  if (!loadSingleNode(medium, "TX1", "sim_bench_tune", bench)) return 1;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_retune_cost);
+  RUN_TEST(test_hopping_recovers_under_jammer);
+  RUN_TEST(test_single_channel_collapses);
+  return UNITY_END();
+}
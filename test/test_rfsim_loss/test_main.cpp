@@ -0,0 +1,54 @@
+// ────────────────────────────────
+// PT_PIN reliability under 20 % independent frame loss (rfsim --loss 20)
+// ────────────────────────────────
+// Every release must reach USB and nothing may stay held once the run has
+// settled, whatever the seed; rolled chords stress the per-node windows.
+// Retries make the TX-side latency outgrow the old 25.5 ms rsv field, and the
+// firmware's e2e must still see what the USB host saw.
+#include <unity.h>
+#include <stdio.h>
+#include "Rfsim.h"
+
+static const uint32_t OLD_RSV_CAP_US = 25500 + 2500;  // 255 × 100 µs, plus an e2e bucket
+
+void setUp() {}
+void tearDown() {}
+
+static void runLossy(int chord, uint32_t rollUs) {
+  for (uint32_t seed = 1; seed <= 5; seed++) {
+    SimOptions opt;
+    opt.txCount = 8;
+    opt.seconds = 30;
+    opt.lossPct = 20;
+    opt.chord = chord;
+    opt.rollUs = rollUs;
+    opt.seed = seed;
+    SimResult res;
+    TEST_ASSERT_TRUE_MESSAGE(runSim(opt, res), "firmware did not load");
+    TEST_ASSERT_GREATER_THAN_UINT32(0, res.observed);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.heldAtEnd, "outputs held at end");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.neverReleased, "releases never seen");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.slowReleases, "releases more than 1 s late");
+    char msg[96];
+    snprintf(msg, sizeof(msg), "seed %u: e2e max %u us, edge>air max %u us, edge -> USB p99 %u us", seed,
+             res.e2eMax_us, res.edgeAirMax_us, res.p99_us);
+    TEST_MESSAGE(msg);
+    if (res.p99_us > OLD_RSV_CAP_US) TEST_ASSERT_GREATER_THAN_UINT32_MESSAGE(OLD_RSV_CAP_US, res.e2eMax_us, msg);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(res.edgeAirMax_us, res.e2eMax_us);
+  }
+}
+
+static void test_no_stuck_keys_at_20pct_loss() {
+  runLossy(1, 0);
+}
+
+static void test_no_stuck_chords_at_20pct_loss() {
+  runLossy(3, 2000);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_no_stuck_keys_at_20pct_loss);
+  RUN_TEST(test_no_stuck_chords_at_20pct_loss);
+  return UNITY_END();
+}
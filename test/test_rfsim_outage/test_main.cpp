@@ -0,0 +1,67 @@
+// ────────────────────────────────
+// Worst-case stuck input after an outage (rfsim --outage)
+// ────────────────────────────────
+// The outage swallows the final releases. Once the channel is back, the
+// next heartbeat snapshot (HEARTBEAT_MS + HB_JITTER_MS) must release every
+// key, including after outages longer than LINK_DOWN_MS and RATE_SILENT_MS
+// that also cost TDMA sync and the link's rate (libfirmware_tdma.so).
+#include <unity.h>
+#include <stdio.h>
+#include "Config.h"
+#include "Firmware.h"
+#include "Rfsim.h"
+
+static const uint32_t RECOVERY_MS = HEARTBEAT_MS + HB_JITTER_MS;
+
+void setUp() {}
+void tearDown() {}
+
+static void runOutage(uint32_t outageMs, const char *lib) {
+  for (uint32_t seed = 1; seed <= 4; seed++) {
+    SimOptions opt;
+    opt.txCount = 4;  // at most 4 keys down: the 6-key report never overflows
+    opt.seconds = 10;
+    opt.holdMs = 390; // so keys are down when the outage starts
+    opt.pressHz = 2.5;
+    opt.outageMs = outageMs;
+    opt.seed = seed;
+    opt.firmware = defaultFirmwarePath(lib);
+    SimResult res;
+    TEST_ASSERT_TRUE_MESSAGE(runSim(opt, res), "firmware did not load");
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%s, outage %u ms, seed %u: worst release %u ms", lib, outageMs, seed,
+             res.releaseWorst_us / 1000);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.heldAtEnd, "outputs held at end");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.neverReleased, "releases never seen");
+    TEST_ASSERT_GREATER_THAN_UINT32_MESSAGE(outageMs / 2 * 1000, res.releaseWorst_us,
+                                            "no key was down when the outage started");
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE((outageMs + RECOVERY_MS) * 1000, res.releaseWorst_us,
+                                             "stuck longer than the outage plus one heartbeat");
+  }
+}
+
+static void test_short_outage() {
+  runOutage(1000, "libfirmware.so");
+  runOutage(1000, "libfirmware_tdma.so");
+}
+
+// Past LINK_DOWN_MS and RATE_SILENT_MS: with TDMA the RX has moved every link to RATE_ROBUST
+static void test_long_outage() {
+  runOutage(6000, "libfirmware.so");
+  runOutage(6000, "libfirmware_tdma.so");
+}
+
+static void test_very_long_outage() {
+  runOutage(12000, "libfirmware.so");
+  runOutage(12000, "libfirmware_tdma.so");
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_short_outage);
+  RUN_TEST(test_long_outage);
+  RUN_TEST(test_very_long_outage);
+  return UNITY_END();
+}
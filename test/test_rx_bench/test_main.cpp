@@ -0,0 +1,53 @@
+// ────────────────────────────────
+// RX receive path: cost per frame against the number of active nodes
+// ────────────────────────────────
+// Peers are found by address in O(1) and share their HID layout, so a frame
+// from one of 32 active TXs must cost what a frame from the only one does.
+#include <unity.h>
+#include <stdio.h>
+#include "Config.h"
+#include "Firmware.h"
+
+typedef uint64_t (*BenchRxFn)(uint8_t nodes, uint32_t frames, uint8_t *active);
+
+static const uint32_t FRAMES = 20000;
+static const int REPEATS = 3;
+
+static Medium medium;
+static BenchRxFn bench = nullptr;
+
+void setUp() {}
+void tearDown() {}
+
+// Best of REPEATS, in ns per frame
+static double costPerFrame(uint8_t nodes) {
+  uint64_t best = UINT64_MAX;
+  for (int r = 0; r < REPEATS; r++) {
+    uint8_t active = 0;
+    uint64_t ns = bench(nodes, FRAMES, &active);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(nodes, active);  // every sender got a peer entry
+    if (ns < best) best = ns;
+  }
+  return (double)best / FRAMES;
+}
+
+static void test_cost_flat_in_node_count() {
+  static const uint8_t nodeCounts[] = { 1, 4, 16, MAX_TX };
+  double cost[4];
+  for (int i = 0; i < 4; i++) {
+    cost[i] = costPerFrame(nodeCounts[i]);
+    char msg[64];
+    snprintf(msg, sizeof(msg), "%u nodes: %.0f ns/frame", nodeCounts[i], cost[i]);
+    TEST_MESSAGE(msg);
+  }
+  for (int i = 1; i < 4; i++)
+    TEST_ASSERT_TRUE_MESSAGE(cost[i] <= cost[0] * 1.5, "per-frame cost grows with the node count");
+}
+
+int main() {
+  if (!loadSingleNode(medium, "RX", "sim_bench_rx", bench, true)) return 1;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_cost_flat_in_node_count);
+  return UNITY_END();
+}
@@ -0,0 +1,87 @@
+// ────────────────────────────────
+// PayloadReady IRQ → dispatch latency histogram
+// ────────────────────────────────
+// Radio::rxLatency keeps 16 µs buckets up to 625 µs; percentiles in that
+// range must land within one bucket of the true ones, also once a bucket
+// holds more samples than a uint16_t counts. Under load from 8 TX
+// every frame the RX takes must be counted, and dispatched within the loop
+// pass its IRQ lands in (one host tick in the sim) instead of radioRx's 5 ms
+// period. Frames that change no HID output must not open an rx>hid interval
+// that some later, unrelated report closes.
+#include <unity.h>
+#include <stdio.h>
+#include "Firmware.h"
+#include "Rfsim.h"
+
+typedef uint32_t (*HistPercentileFn)(uint8_t shift, const uint32_t *samples, uint32_t n, uint8_t pct);
+
+static const uint32_t BUCKET_US = 16;  // LatencyHist{ 4 } below 625 µs
+static const uint32_t SAMPLES = 600;
+
+static Medium medium;
+static HistPercentileFn percentile = nullptr;
+
+void setUp() {}
+void tearDown() {}
+
+static void test_percentiles_within_a_bucket() {
+  static uint32_t samples[SAMPLES];
+  for (uint32_t i = 0; i < SAMPLES; i++) samples[i] = (i * 7919) % SAMPLES;  // 0..599 µs, shuffled
+  static const uint8_t pcts[] = { 50, 90, 99 };
+  for (uint8_t pct : pcts) {
+    uint32_t got = percentile(4, samples, SAMPLES, pct);
+    uint32_t want = SAMPLES * pct / 100 - 1;  // the rank-pct sample of 0..599
+    char msg[64];
+    snprintf(msg, sizeof(msg), "p%u: %u us (exact %u us)", pct, got, want);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(want, got);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(want + BUCKET_US, got, msg);
+  }
+}
+
+static void test_percentiles_past_a_full_bucket() {
+  static const uint32_t FILL = 70000;  // one bucket past 0xFFFF
+  static uint32_t samples[FILL + 1];
+  for (uint32_t i = 0; i < FILL; i++) samples[i] = 100;
+  samples[FILL] = 50000;
+  uint32_t p50 = percentile(0, samples, FILL + 1, 50);
+  uint32_t p99 = percentile(0, samples, FILL + 1, 99);
+  char msg[64];
+  snprintf(msg, sizeof(msg), "p50 %u us, p99 %u us", p50, p99);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(250, p50, msg);  // the 0..250 µs bucket
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(250, p99, msg);
+}
+
+static void test_dispatch_within_one_loop_pass() {
+  static const uint32_t ticks[] = { 50, 500 };
+  for (uint32_t tick : ticks) {
+    SimOptions opt;
+    opt.txCount = 8;
+    opt.seconds = 20;
+    opt.tickUs = tick;
+    SimResult res;
+    TEST_ASSERT_TRUE_MESSAGE(runSim(opt, res), "firmware did not load");
+    char msg[96];
+    snprintf(msg, sizeof(msg), "tick %u us: %u frames, p99 %u us, max %u us", tick, res.rxDispatchCount,
+             res.rxDispatchP99_us, res.rxDispatchMax_us);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, res.rxDispatchCount);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(res.rxDispatchMax_us, res.rxDispatchP99_us);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(tick, res.rxDispatchMax_us, msg);
+    // The firmware's rx>hid is part of what the USB host measured, never more
+    snprintf(msg, sizeof(msg), "rx>hid max %u us, edge -> USB max %u us", res.rxHidMax_us, res.max_us);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(res.max_us, res.rxHidMax_us, msg);
+  }
+}
+
+int main() {
+  if (!loadSingleNode(medium, "RX", "sim_hist_percentile", percentile)) return 1;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_percentiles_within_a_bucket);
+  RUN_TEST(test_percentiles_past_a_full_bucket);
+  RUN_TEST(test_dispatch_within_one_loop_pass);
+  return UNITY_END();
+}
@@ -0,0 +1,72 @@
+// ────────────────────────────────
+// Seqlock: one writer thread, one reader thread
+// ────────────────────────────────
+// Peer::status carries a peer's link state from the RP2040 radio core to the
+// OLED/HID core. Here the writer rewrites a value wider than one word as fast
+// as it can while the reader copies it out: every copy must be one whole write.
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "Seqlock.h"
+
+static const uint32_t WRITES = 2000000;
+
+// Three words that must always agree
+struct Value {
+  uint32_t seq;
+  uint32_t check;
+  int8_t rssi;
+  uint8_t link;
+};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_single_thread_read_back() {
+  Seqlock<Value> lock;
+  Value v = lock.read();
+  TEST_ASSERT_EQUAL_UINT32(0, v.seq);
+  TEST_ASSERT_EQUAL_UINT32(0, v.check);
+
+  lock.write({ 7, ~7u, -42, 2 });
+  v = lock.read();
+  TEST_ASSERT_EQUAL_UINT32(7, v.seq);
+  TEST_ASSERT_EQUAL_UINT32(~7u, v.check);
+  TEST_ASSERT_EQUAL_INT8(-42, v.rssi);
+  TEST_ASSERT_EQUAL_UINT8(2, v.link);
+}
+
+static void test_two_threads_no_torn_reads() {
+  static Seqlock<Value> lock;
+  std::atomic<bool> done{ false };
+
+  std::thread writer([&] {
+    for (uint32_t i = 1; i <= WRITES; i++) lock.write({ i, ~i, (int8_t)i, (uint8_t)(i >> 8) });
+    done.store(true);
+  });
+
+  uint32_t reads = 0, torn = 0, backwards = 0, last = 0;
+  while (!done.load()) {
+    Value v = lock.read();
+    if (v.seq == 0) continue;  // the initial value, before the first write
+    reads++;
+    if (v.check != ~v.seq || v.rssi != (int8_t)v.seq || v.link != (uint8_t)(v.seq >> 8)) torn++;
+    if (v.seq < last) backwards++;  // a single writer's values only move forward
+    last = v.seq;
+  }
+  writer.join();
+
+  char msg[64];
+  snprintf(msg, sizeof(msg), "%lu reads during %lu writes", (unsigned long)reads, (unsigned long)WRITES);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_EQUAL_UINT32(0, torn);
+  TEST_ASSERT_EQUAL_UINT32(0, backwards);
+  TEST_ASSERT_EQUAL_UINT32(WRITES, lock.read().seq);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_thread_read_back);
+  RUN_TEST(test_two_threads_no_torn_reads);
+  return UNITY_END();
+}
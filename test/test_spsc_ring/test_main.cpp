@@ -0,0 +1,104 @@
+// ────────────────────────────────
+// SpscRing: one producer thread, one consumer thread
+// ────────────────────────────────
+// The ring carries radio → HID pin events across the RP2040 cores. Here the
+// two sides run on host threads through a ring small enough to sit full or
+// empty most of the time, long enough to wrap the 16-bit indices many times.
+#include <unity.h>
+#include <thread>
+#include "SpscRing.h"
+
+static const uint32_t ITEMS = 4000000;
+
+// Wider than one store, so a torn read shows up as a bad check word
+struct Item {
+  uint32_t seq;
+  uint32_t check;
+};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_single_thread_order_and_overflow() {
+  SpscRing<uint32_t, 4> ring;
+  uint32_t v = 0;
+  TEST_ASSERT_TRUE(ring.empty());
+  TEST_ASSERT_FALSE(ring.pop(v));
+  TEST_ASSERT_NULL(ring.peek());
+
+  for (uint32_t i = 0; i < 4; i++) TEST_ASSERT_TRUE(ring.push(i));
+  TEST_ASSERT_FALSE(ring.push(99));
+  TEST_ASSERT_EQUAL_UINT32(1, ring.dropped);
+  TEST_ASSERT_EQUAL_UINT16(4, ring.size());
+
+  TEST_ASSERT_EQUAL_UINT32(0, *ring.peek());
+  for (uint32_t i = 0; i < 4; i++) {
+    TEST_ASSERT_TRUE(ring.pop(v));
+    TEST_ASSERT_EQUAL_UINT32(i, v);
+  }
+  TEST_ASSERT_TRUE(ring.empty());
+}
+
+// Indices are uint16_t: run them through several wraps one item at a time
+static void test_index_wrap() {
+  SpscRing<uint32_t, 8> ring;
+  uint32_t v = 0;
+  for (uint32_t i = 0; i < 200000; i++) {
+    TEST_ASSERT_TRUE(ring.push(i));
+    TEST_ASSERT_EQUAL_UINT16(1, ring.size());
+    TEST_ASSERT_TRUE(ring.pop(v));
+    TEST_ASSERT_EQUAL_UINT32(i, v);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, ring.dropped);
+}
+
+static void test_two_threads_no_loss_no_dup_in_order() {
+  static SpscRing<Item, 32> ring;
+  uint32_t refused = 0;
+
+  std::thread producer([&] {
+    for (uint32_t i = 0; i < ITEMS; i++) {
+      while (!ring.push({ i, ~i })) {
+        refused++;
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t expected = 0, outOfOrder = 0, torn = 0, peekMismatch = 0;
+  Item it;
+  while (expected < ITEMS) {
+    const Item *p = ring.peek();
+    if (!p) {
+      std::this_thread::yield();
+      continue;
+    }
+    uint32_t peeked = p->seq;
+    if (!ring.pop(it)) {
+      peekMismatch++;  // peek() saw an item that pop() then did not
+      break;
+    }
+    if (it.seq != peeked) peekMismatch++;
+    if (it.check != ~it.seq) torn++;
+    if (it.seq != expected) outOfOrder++;  // a gap is a loss, a repeat a duplicate
+    expected = it.seq + 1;
+  }
+  producer.join();
+
+  TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+  TEST_ASSERT_EQUAL_UINT32(0, torn);
+  TEST_ASSERT_EQUAL_UINT32(0, peekMismatch);
+  TEST_ASSERT_EQUAL_UINT32(ITEMS, expected);
+  TEST_ASSERT_TRUE(ring.empty());
+  TEST_ASSERT_FALSE(ring.pop(it));
+  // Every refused push was counted, none was lost silently
+  TEST_ASSERT_EQUAL_UINT32(refused, ring.dropped);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_thread_order_and_overflow);
+  RUN_TEST(test_index_wrap);
+  RUN_TEST(test_two_threads_no_loss_no_dup_in_order);
+  return UNITY_END();
+}
@@ -0,0 +1,71 @@
+// ────────────────────────────────
+// TDMA worst-case latency as the node count grows (libfirmware_tdma.so)
+// ────────────────────────────────
+// A PT_PIN waits at most one superframe for its node's slot, so the worst
+// PCF edge → air time over every TX must stay within N × TDMA_SLOT_US +
+// TDMA_CONTENTION_US (plus one slot for the beacon and the frame itself)
+// whatever N is, and no input may be left stuck. A release needs at most a
+// few re-sends a superframe apart, and the RX may lose only a few TX frames,
+// none of them to TX power: at 24 TX a beacon that goes missing or a link
+// pushed below sensitivity shows up here long before it leaves a key held.
+#include <unity.h>
+#include <stdio.h>
+#include "Config.h"
+#include "Firmware.h"
+#include "Rfsim.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void runSlotted(int txCount) {
+  SimOptions opt;
+  opt.txCount = txCount;
+  opt.seconds = 20;
+  opt.firmware = defaultFirmwarePath("libfirmware_tdma.so");
+  SimResult res;
+  TEST_ASSERT_TRUE_MESSAGE(runSim(opt, res), "firmware did not load");
+
+  uint32_t superframe_us = txCount * TDMA_SLOT_US + TDMA_CONTENTION_US;
+  char msg[192];
+  snprintf(msg, sizeof(msg),
+           "%d TX: edge>air max %u us (superframe %u us), e2e p99 %u us, worst release %u us, "
+           "%u of %u TX frames missed (%u below sensitivity), %u collided",
+           txCount, res.edgeAirMax_us, superframe_us, res.e2eP99_us, res.releaseWorst_us, res.air.rxMissed,
+           res.air.txFrames, res.air.rxWeak, res.air.collided);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, res.observed);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.heldAtEnd, "outputs held at end");
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.neverReleased, "releases never seen");
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(superframe_us + TDMA_SLOT_US, res.edgeAirMax_us,
+                                           "edge → air beyond one superframe");
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.slowReleases, "releases more than 1 s late");
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(4 * (superframe_us + TDMA_SLOT_US), res.releaseWorst_us,
+                                           "release beyond four superframes");
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.air.rxWeak, "TX frames below sensitivity at the RX");
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(res.air.txFrames / 20, res.air.rxMissed, "over 5% of TX frames missed");
+}
+
+static void test_4_tx() {
+  runSlotted(4);
+}
+
+static void test_8_tx() {
+  runSlotted(8);
+}
+
+static void test_16_tx() {
+  runSlotted(16);
+}
+
+static void test_24_tx() {
+  runSlotted(24);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_4_tx);
+  RUN_TEST(test_8_tx);
+  RUN_TEST(test_16_tx);
+  RUN_TEST(test_24_tx);
+  return UNITY_END();
+}
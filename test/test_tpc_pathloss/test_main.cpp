@@ -0,0 +1,79 @@
+// ────────────────────────────────
+// Transmit power control against the path-loss model (rfsim --path-step)
+// ────────────────────────────────
+// TX i is 60 dB + i × step away from the RX. Once the loop has settled, each
+// TX must send at the power that puts it at TPC_TARGET_DBM there (within the
+// hysteresis), clamped to the radio's range; near nodes back off, far ones
+// get what they need, and no press may be lost on the way.
+#include <unity.h>
+#include <stdio.h>
+#include "Config.h"
+#include "Firmware.h"
+#include "Rfsim.h"
+
+static const int TOLERANCE_DB = TPC_HYST_DB + 1;  // + RSSI rounding
+
+void setUp() {}
+void tearDown() {}
+
+static SimResult runPathLoss(const char *lib, float stepDb) {
+  SimOptions opt;
+  opt.txCount = 8;
+  opt.seconds = 60;
+  opt.pathStepDb = stepDb;
+  opt.firmware = defaultFirmwarePath(lib);
+  SimResult res;
+  TEST_ASSERT_TRUE_MESSAGE(runSim(opt, res), "firmware did not load");
+  return res;
+}
+
+static void checkSettled(float stepDb) {
+  SimResult res = runPathLoss("libfirmware_tdma.so", stepDb);
+  TEST_ASSERT_EQUAL_UINT32(8, res.txPowerDbm.size());
+  for (int i = 1; i <= 8; i++) {
+    float loss = Medium().pathLossDb + stepDb * i;
+    int want = constrain((int)lroundf(TPC_TARGET_DBM + loss), (int)TPC_MIN_DBM, (int)TPC_MAX_DBM);
+    int got = res.txPowerDbm[i - 1];
+    char msg[96];
+    snprintf(msg, sizeof(msg), "step %.0f dB, TX%d: path loss %.0f dB, power %d dBm (model %d dBm)", stepDb, i,
+             loss, got, want);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_INT_WITHIN_MESSAGE(TOLERANCE_DB, want, got, msg);
+  }
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.missedPresses, "presses lost");
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.heldAtEnd, "outputs held at end");
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.neverReleased, "releases never seen");
+}
+
+// Short links: most TXs back off to the bottom of the range
+static void test_near_nodes_back_off() {
+  checkSettled(2);
+}
+
+// The far TXs would drop below sensitivity at the boot power
+static void test_far_nodes_power_up() {
+  checkSettled(6);
+}
+
+// Against RF69_TX_POWER fixed: less energy on short links, no lost presses on long ones
+static void test_against_fixed_power() {
+  SimResult fixedNear = runPathLoss("libfirmware.so", 2);
+  SimResult tpcNear = runPathLoss("libfirmware_tdma.so", 2);
+  TEST_ASSERT_TRUE_MESSAGE(tpcNear.air.txEnergyMj < fixedNear.air.txEnergyMj, "TPC radiates more on short links");
+
+  SimResult fixedFar = runPathLoss("libfirmware.so", 6);
+  SimResult tpcFar = runPathLoss("libfirmware_tdma.so", 6);
+  char msg[96];
+  snprintf(msg, sizeof(msg), "step 6 dB: %u presses lost at fixed power, %u with TPC", fixedFar.missedPresses,
+           tpcFar.missedPresses);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_GREATER_THAN_UINT32(tpcFar.missedPresses, fixedFar.missedPresses);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_near_nodes_back_off);
+  RUN_TEST(test_far_nodes_power_up);
+  RUN_TEST(test_against_fixed_power);
+  return UNITY_END();
+}
@@ -0,0 +1,70 @@
+// ────────────────────────────────
+// What WFE costs an edge: /INT ISR → PCFInput::service, sleep on and off
+// ────────────────────────────────
+// With the TX spinning (--no-sleep) a /INT is picked up on the next loop
+// pass, one host tick at most. Sleeping may only add the core's wake-up
+// (rfsim --wake) on top of that, must not lose or delay anything further
+// down the path, and must leave the TX awake for a fraction of the ticks.
+#include <unity.h>
+#include <stdio.h>
+#include "Firmware.h"
+#include "Rfsim.h"
+
+static const uint32_t TICK_US = 50;
+
+void setUp() {}
+void tearDown() {}
+
+static SimResult runWake(bool sleep, uint32_t wakeUs) {
+  SimOptions opt;
+  opt.txCount = 4;
+  opt.seconds = 20;
+  opt.tickUs = TICK_US;
+  opt.sleep = sleep;
+  opt.wakeUs = wakeUs;
+  SimResult res;
+  TEST_ASSERT_TRUE_MESSAGE(runSim(opt, res), "firmware did not load");
+  char msg[112];
+  snprintf(msg, sizeof(msg), "sleep %s, wake %u us: irq>svc p99 %u us max %u us, TX awake %.1f%%, e2e p99 %u us",
+           sleep ? "on" : "off", wakeUs, res.pcfIrqP99_us, res.pcfIrqMax_us, res.txAwakePct, res.e2eP99_us);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, res.observed);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, res.missedPresses, "presses lost");
+  TEST_ASSERT_TRUE_MESSAGE(res.clean(), "stuck input");
+  return res;
+}
+
+static void test_spinning_takes_irq_within_a_tick() {
+  SimResult off = runWake(false, 0);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(TICK_US, off.pcfIrqMax_us);
+}
+
+static void checkPenalty(uint32_t wakeUs) {
+  SimResult off = runWake(false, wakeUs);
+  SimResult on = runWake(true, wakeUs);
+  char msg[80];
+  snprintf(msg, sizeof(msg), "wake %u us: sleeping adds %d us to the worst irq>svc", wakeUs,
+           (int)on.pcfIrqMax_us - (int)off.pcfIrqMax_us);
+  TEST_MESSAGE(msg);
+  // The wake-up, rounded up to the tick the sim resumes loop() on
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(off.pcfIrqMax_us + wakeUs + TICK_US, on.pcfIrqMax_us, msg);
+  // Nothing further down the path pays more (one e2e bucket is 2.5 ms up there)
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(off.e2eP99_us + wakeUs + 2500, on.e2eP99_us);
+  TEST_ASSERT_TRUE_MESSAGE(on.txAwakePct < off.txAwakePct / 2, "sleep does not save half the TX's awake time");
+}
+
+static void test_penalty_without_wake_cost() {
+  checkPenalty(0);
+}
+
+static void test_penalty_with_wake_cost() {
+  checkPenalty(200);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_spinning_takes_irq_within_a_tick);
+  RUN_TEST(test_penalty_without_wake_cost);
+  RUN_TEST(test_penalty_with_wake_cost);
+  return UNITY_END();
+}
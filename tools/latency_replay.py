@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Replay a captured latency trace and print the same histograms as Trace.cpp.
+
+Capture with TRACE_DUMP 1 in config.h, e.g.
+    pio device monitor > rx_trace.log
+then
+    python tools/latency_replay.py rx_trace.log [tx_trace.log ...]
+
+Only lines of the form TRACE,<t_us>,<point>,<node>,<tag> are used; any
+other serial output in the capture is ignored.
+"""
+import sys
+
+TP_PCF_EDGE, TP_TX_SENT, TP_RX_PIN, TP_HID_REPORT, TP_PCF_IRQ = 1, 2, 3, 4, 5
+PAIR_TIMEOUT_US = 100000
+UPSTREAM_SATURATED = 0xFFFE  # TRACE_UPSTREAM_SATURATED: left out of e2e
+BUCKETS = 64
+U32 = 0xFFFFFFFF
+
+
+def bucket_of(us):
+    if us < 10000:
+        return us // 250
+    return min(40 + (us - 10000) // 2500, BUCKETS - 1)
+
+
+def bucket_upper(b):
+    return (b + 1) * 250 if b < 40 else 10000 + (b - 39) * 2500
+
+
+class LatencyHist:
+    def __init__(self, shift=0):
+        self.bins = [0] * BUCKETS
+        self.n = 0
+        self.max_us = 0
+        self.shift = shift
+
+    def add(self, us):
+        b = bucket_of(min(us << self.shift, U32))
+        self.bins[b] += 1
+        self.n += 1
+        self.max_us = max(self.max_us, us)
+
+    def percentile(self, pct):
+        if self.n == 0:
+            return 0
+        target = (self.n * pct + 99) // 100
+        seen = 0
+        for b, c in enumerate(self.bins):
+            seen += c
+            if seen >= target:
+                return min(bucket_upper(b) >> self.shift, self.max_us)
+        return self.max_us
+
+
+def replay(lines):
+    hists = {"edge>air": LatencyHist(), "rx>hid": LatencyHist(), "e2e": LatencyHist(),
+             "irq>svc": LatencyHist(4)}
+    edge = None
+    e2e_saturated = 0
+    rx_open = {}  # node -> (t_us, upstream 100 µs units)
+
+    for line in lines:
+        if not line.startswith("TRACE,"):
+            continue
+        try:
+            _, t, point, node, tag = line.strip().split(",")
+            t, point, node, tag = int(t), int(point), int(node), int(tag)
+        except ValueError:
+            continue
+
+        if point == TP_PCF_EDGE:
+            edge = t
+        elif point == TP_TX_SENT:
+            if edge is not None and ((t - edge) & U32) <= PAIR_TIMEOUT_US:
+                hists["edge>air"].add((t - edge) & U32)
+            edge = None
+        elif point == TP_RX_PIN:
+            rx_open[node] = (t, tag)
+        elif point == TP_HID_REPORT:
+            for start, upstream in rx_open.values():
+                local = (t - start) & U32
+                if local <= PAIR_TIMEOUT_US:
+                    hists["rx>hid"].add(local)
+                    if upstream == UPSTREAM_SATURATED:
+                        e2e_saturated += 1
+                    else:
+                        hists["e2e"].add(local + upstream * 100)
+            rx_open.clear()
+        elif point == TP_PCF_IRQ:
+            hists["irq>svc"].add(tag)
+    return hists, e2e_saturated
+
+
+def main(paths):
+    if not paths:
+        print(__doc__)
+        return 1
+    lines = []
+    for path in paths:
+        with open(path, errors="replace") as f:
+            lines.extend(f)
+    hists, e2e_saturated = replay(lines)
+    for name, h in hists.items():
+        if h.n:
+            print(f"{name:<9} n={h.n} p50={h.percentile(50)}us "
+                  f"p99={h.percentile(99)}us max={h.max_us}us")
+    if e2e_saturated:
+        print(f"e2e       {e2e_saturated} samples past the frame's latency scale, not counted")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))